@@ -0,0 +1,204 @@
+#include <chrono>
+#include <cstdio>
+
+#include "benchcpu.h"
+
+
+static const char* const PRIMARY_NAMES[64] = {
+    "SPECIAL", "REGIMM", "J", "JAL", "BEQ", "BNE", "BLEZ", "BGTZ",
+    "ADDI", "ADDIU", "SLTI", "SLTIU", "ANDI", "ORI", "XORI", "LUI",
+    "COP0", "COP1", nullptr, nullptr, "BEQL", "BNEL", "BLEZL", "BGTZL",
+    "DADDI", "DADDIU", "LDL", "LDR", nullptr, nullptr, nullptr, nullptr,
+    "LB", "LH", "LWL", "LW", "LBU", "LHU", "LWR", "LWU",
+    "SB", "SH", "SWL", "SW", "SDL", "SDR", "SWR", "CACHE",
+    "LL", "LWC1", nullptr, nullptr, nullptr, "LDC1", nullptr, "LD",
+    "SC", "SWC1", nullptr, nullptr, "SCD", "SDC1", nullptr, "SD"
+};
+
+static const char* const SPECIAL_NAMES[64] = {
+    "SLL", nullptr, "SRL", "SRA", "SLLV", nullptr, "SRLV", "SRAV",
+    "JR", "JALR", nullptr, nullptr, "SYSCALL", "BREAK", nullptr, "SYNC",
+    "MFHI", "MTHI", "MFLO", "MTLO", "DSLLV", nullptr, "DSRLV", "DSRAV",
+    "MULT", "MULTU", "DIV", "DIVU", "DMULT", "DMULTU", "DDIV", "DDIVU",
+    "ADD", "ADDU", "SUB", "SUBU", "AND", "OR", "XOR", "NOR",
+    nullptr, nullptr, "SLT", "SLTU", "DADD", "DADDU", "DSUB", "DSUBU",
+    "TGE", "TGEU", "TLT", "TLTU", "TEQ", nullptr, "TNE", nullptr,
+    "DSLL", nullptr, "DSRL", "DSRA", "DSLL32", nullptr, "DSRL32", "DSRA32"
+};
+
+static const char* const REGIMM_NAMES[32] = {
+    "BLTZ", "BGEZ", "BLTZL", "BGEZL", nullptr, nullptr, nullptr, nullptr,
+    "TGEI", "TGEIU", "TLTI", "TLTIU", "TEQI", nullptr, "TNEI", nullptr,
+    "BLTZAL", "BGEZAL", "BLTZALL", "BGEZALL", nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr
+};
+
+static const char* const TLB_NAMES[32] = {
+    nullptr, "TLBR", "TLBWI", nullptr, nullptr, nullptr, "TLBWR", nullptr,
+    "TLBP", nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    "ERET", nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr
+};
+
+static const char* const COP1_NAMES[8] = {
+    "MFC1", "DMFC1", "CFC1", nullptr, "MTC1", "DMTC1", "CTC1", nullptr
+};
+
+static const char* const BC_NAMES[4] = {
+    "BC1F", "BC1T", "BC1FL", "BC1TL"
+};
+
+// shared by the S, D, W and L tables, the format is appended
+static const char* const FPU_NAMES[64] = {
+    "ADD", "SUB", "MUL", "DIV", "SQRT", "ABS", "MOV", "NEG",
+    "ROUND.L", "TRUNC.L", "CEIL.L", "FLOOR.L", "ROUND.W", "TRUNC.W", "CEIL.W", "FLOOR.W",
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    "CVT.S", "CVT.D", nullptr, nullptr, "CVT.W", "CVT.L", nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    "C.F", "C.UN", "C.EQ", "C.UEQ", "C.OLT", "C.ULT", "C.OLE", "C.ULE",
+    "C.SF", "C.NGLE", "C.SEQ", "C.NGL", "C.LT", "C.NGE", "C.LE", "C.NGT"
+};
+
+static const char FPU_FORMATS[] = { 'S', 'D', 'W', 'L' };
+
+
+// follows the dispatch in ICPU down to the handler that runs
+static inline uint32_t handlerKey(Instruction instr)
+{
+    switch (instr.op)
+    {
+    case 0:
+        return GROUP_SPECIAL * 64 + instr.func;
+
+    case 1:
+        return GROUP_REGIMM * 64 + instr.rt;
+
+    case 16:
+        return (instr.rs == 16) ? GROUP_TLB * 64 + instr.func : GROUP_COP0 * 64 + instr.rs;
+
+    case 17:
+        switch (instr.fmt)
+        {
+        case 8:  return GROUP_BC * 64 + instr.ft;
+        case 16: return GROUP_S * 64 + instr.func;
+        case 17: return GROUP_D * 64 + instr.func;
+        case 20: return GROUP_W * 64 + instr.func;
+        case 21: return GROUP_L * 64 + instr.func;
+        default: return GROUP_COP1 * 64 + instr.fmt;
+        }
+
+    default:
+        return GROUP_PRIMARY * 64 + instr.op;
+    }
+}
+
+const char* handlerName(uint32_t key, char* buffer, size_t size)
+{
+    uint32_t group = key / 64;
+    uint32_t index = key % 64;
+
+    switch (group)
+    {
+    case GROUP_PRIMARY:
+        return PRIMARY_NAMES[index];
+
+    case GROUP_SPECIAL:
+        return SPECIAL_NAMES[index];
+
+    case GROUP_REGIMM:
+        return (index < 32) ? REGIMM_NAMES[index] : nullptr;
+
+    case GROUP_COP0:
+        return (index == 0) ? "MFC0" : (index == 4) ? "MTC0" : nullptr;
+
+    case GROUP_TLB:
+        return (index < 32) ? TLB_NAMES[index] : nullptr;
+
+    case GROUP_COP1:
+        return (index < 8) ? COP1_NAMES[index] : nullptr;
+
+    case GROUP_BC:
+        return (index < 4) ? BC_NAMES[index] : nullptr;
+
+    default:
+        if (group < GROUP_COUNT && FPU_NAMES[index] != nullptr)
+        {
+            snprintf(buffer, size, "%s.%c", FPU_NAMES[index], FPU_FORMATS[group - GROUP_S]);
+            return buffer;
+        }
+
+        return nullptr;
+    }
+}
+
+
+void BenchCPU::execute(void)
+{
+    beginExecution();
+
+    _instructions = 0;
+    _counts.fill(0);
+
+    uint64_t start_cycles = Bus::state.cycles;
+    uint64_t end = (_cycle_limit != 0) ? start_cycles + _cycle_limit : UINT64_MAX;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    if (_threaded)
+    {
+#ifdef INTERPRETER_THREADED
+        runThreaded(end);
+#endif
+    }
+    else if (_profile)
+    {
+        run<true>(end);
+    }
+    else
+    {
+        run<false>(end);
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+    _seconds = elapsed.count();
+    _cycles = Bus::state.cycles - start_cycles;
+}
+
+template <bool PROFILE>
+void BenchCPU::run(uint64_t end)
+{
+    while (!CoreControl::stop && Bus::state.cycles < end)
+    {
+        prefetch();
+
+        _instructions++;
+
+        if (PROFILE)
+        {
+            count();
+        }
+
+        (this->*instruction_table[_cur_instr.op])();
+    }
+}
+
+void BenchCPU::executeDelaySlot(void)
+{
+    prefetch();
+
+    _instructions++;
+
+    if (_profile)
+    {
+        count();
+    }
+
+    (this->*instruction_table[_cur_instr.op])();
+}
+
+void BenchCPU::count(void)
+{
+    _counts[handlerKey(_cur_instr)]++;
+}
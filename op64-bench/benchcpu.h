@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <cpu/interpreter.h>
+
+
+// handler groups, a handler key is group * 64 + index in the group's table
+enum HandlerGroup : uint32_t
+{
+    GROUP_PRIMARY,
+    GROUP_SPECIAL,
+    GROUP_REGIMM,
+    GROUP_COP0,
+    GROUP_TLB,
+    GROUP_COP1,
+    GROUP_BC,
+    GROUP_S,
+    GROUP_D,
+    GROUP_W,
+    GROUP_L,
+    GROUP_COUNT
+};
+
+#define HANDLER_KEYS (GROUP_COUNT * 64)
+
+// name of the handler for a key, nullptr for reserved encodings
+const char* handlerName(uint32_t key, char* buffer, size_t size);
+
+
+/************************************************************************/
+/* Interpreter that counts what it executes                             */
+/************************************************************************/
+class BenchCPU : public Interpreter
+{
+public:
+    // stop after this many emulated cycles, 0 runs until CoreControl::stop
+    void setCycleLimit(uint64_t cycles)
+    {
+        _cycle_limit = cycles;
+    }
+
+    // also count each handler, costs time so timed runs leave it off
+    void setProfile(bool profile)
+    {
+        _profile = profile;
+    }
+
+#ifdef INTERPRETER_THREADED
+    // time the interpreter's threaded loop instead, nothing is counted
+    void setThreaded(bool threaded)
+    {
+        _threaded = threaded;
+    }
+#endif
+
+    virtual void execute(void) override;
+
+    uint64_t instructions(void) const
+    {
+        return _instructions;
+    }
+
+    uint64_t cycles(void) const
+    {
+        return _cycles;
+    }
+
+    double seconds(void) const
+    {
+        return _seconds;
+    }
+
+    const std::array<uint64_t, HANDLER_KEYS>& handlerCounts(void) const
+    {
+        return _counts;
+    }
+
+protected:
+    virtual void executeDelaySlot(void) override;
+
+private:
+    template <bool PROFILE>
+    void run(uint64_t end);
+
+    void count(void);
+
+private:
+    uint64_t _cycle_limit = 0;
+    bool _profile = false;
+    bool _threaded = false;
+
+    uint64_t _instructions = 0;
+    uint64_t _cycles = 0;
+    double _seconds = 0.0;
+
+    std::array<uint64_t, HANDLER_KEYS> _counts;
+};
@@ -0,0 +1,419 @@
+/* CPU throughput benchmark. Runs synthetic instruction mixes and
+ * optionally a ROM's boot sequence on the interpreter and reports
+ * MIPS, host time per emulated instruction and handler counts */
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <oplog.h>
+
+#include <globalstrings.h>
+#include <core/bus.h>
+#include <mem/mpmemory.h>
+#include <plugin/nullplugins.h>
+#include <plugin/plugincontainer.h>
+#include <rom/rom.h>
+#include <ui/configstore.h>
+#include <ui/corecontrol.h>
+
+#include "benchcpu.h"
+#include "memtables.h"
+#include "rewindbench.h"
+#include "scenarios.h"
+
+using namespace GlobalStrings;
+
+
+#define DEFAULT_CYCLES 100000000ULL
+#define DEFAULT_FRAMES 300
+#define DEFAULT_MEMTABLES_ITERATIONS 20000000
+#define DEFAULT_REWIND_SNAPSHOTS 200
+#define TEXT_HANDLERS 8
+
+
+struct Options
+{
+    bool json = false;
+    bool profile = true;
+    uint64_t cycles = DEFAULT_CYCLES;
+    const char* rom = nullptr;
+    uint32_t frames = DEFAULT_FRAMES;
+    std::vector<std::string> scenarios;
+};
+
+struct Result
+{
+    std::string name;
+    uint64_t cycles;
+    uint64_t instructions;
+    double seconds;
+    double threaded_seconds;
+    std::vector<std::pair<std::string, uint64_t>> handlers;
+};
+
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+        "usage: %s [options] [scenario...]\n"
+        "  --json            print results as JSON\n"
+        "  --cycles N        emulated cycles per synthetic scenario (default %" PRIu64 ")\n"
+        "  --rom PATH        ROM for the boot scenario\n"
+        "  --frames N        VIs to run in the boot scenario (default %u)\n"
+        "  --no-profile      skip the handler count pass\n"
+        "  --memtables [N]   compare load/store handlers through the memory tables and direct RDRAM\n"
+        "  --rewind [N]      time N rewind snapshots (default %u) with and without plugin writes\n"
+        "scenarios:\n",
+        name, (uint64_t)DEFAULT_CYCLES, DEFAULT_FRAMES, DEFAULT_REWIND_SNAPSHOTS);
+
+    for (size_t i = 0; i < SCENARIO_COUNT; i++)
+    {
+        fprintf(stderr, "  %-16s  %s\n", SCENARIOS[i].name, SCENARIOS[i].description);
+    }
+
+    fprintf(stderr, "  %-16s  %s\n", "boot", "the ROM given with --rom, up to the last VI");
+}
+
+// runs the machine once, the bus takes the rom
+static bool runMachine(Rom* rom, void(*load)(void), uint64_t cycles, uint32_t frames, bool profile, bool threaded, BenchCPU& cpu)
+{
+    if (nullptr == rom)
+    {
+        return false;
+    }
+
+    Bus bus(rom);
+    PluginContainer plugins;
+    MPMemory mem;
+
+    if (!bus.connectDevices(&cpu, &mem, &plugins) || !bus.initializeDevices())
+    {
+        return false;
+    }
+
+    if (load != nullptr)
+    {
+        load();
+    }
+
+    setNullFrameLimit(frames);
+    cpu.setCycleLimit(cycles);
+    cpu.setProfile(profile);
+#ifdef INTERPRETER_THREADED
+    cpu.setThreaded(threaded);
+#endif
+
+    bus.executeMachine();
+
+    return true;
+}
+
+static Rom* createRom(const char* path)
+{
+    if (nullptr == path)
+    {
+        return createScenarioRom();
+    }
+
+    Rom* rom = nullptr;
+
+    if (!Rom::loadRom(path, rom))
+    {
+        return nullptr;
+    }
+
+    return rom;
+}
+
+// one timed pass per dispatch loop, then a pass counting handlers since that costs time
+static bool runScenario(const char* name, const char* rom, void(*load)(void), uint64_t cycles, uint32_t frames, bool profile, Result& result)
+{
+    BenchCPU timed;
+
+    if (!runMachine(createRom(rom), load, cycles, frames, false, false, timed))
+    {
+        return false;
+    }
+
+    result.name = name;
+    result.cycles = timed.cycles();
+    result.instructions = timed.instructions();
+    result.seconds = timed.seconds();
+    result.threaded_seconds = 0.0;
+    result.handlers.clear();
+
+#ifdef INTERPRETER_THREADED
+    // runs the same instructions, only the time is taken
+    BenchCPU threaded;
+
+    if (!runMachine(createRom(rom), load, cycles, frames, false, true, threaded))
+    {
+        return false;
+    }
+
+    if (threaded.cycles() != timed.cycles())
+    {
+        fprintf(stderr, "%s: the threaded loop ran %" PRIu64 " cycles, the table loop %" PRIu64 "\n",
+            name, threaded.cycles(), timed.cycles());
+        return false;
+    }
+
+    result.threaded_seconds = threaded.seconds();
+#endif
+
+    if (!profile)
+    {
+        return true;
+    }
+
+    BenchCPU counted;
+
+    if (!runMachine(createRom(rom), load, cycles, frames, true, false, counted))
+    {
+        return false;
+    }
+
+    char buffer[32];
+
+    for (uint32_t key = 0; key < HANDLER_KEYS; key++)
+    {
+        uint64_t count = counted.handlerCounts()[key];
+
+        if (count != 0)
+        {
+            const char* handler = handlerName(key, buffer, sizeof(buffer));
+            result.handlers.emplace_back((handler != nullptr) ? handler : "reserved", count);
+        }
+    }
+
+    std::stable_sort(result.handlers.begin(), result.handlers.end(),
+        [](const std::pair<std::string, uint64_t>& a, const std::pair<std::string, uint64_t>& b)
+    {
+        return a.second > b.second;
+    });
+
+    return true;
+}
+
+static double mips(const Result& r)
+{
+    return (r.seconds > 0.0) ? r.instructions / r.seconds / 1e6 : 0.0;
+}
+
+static double threadedMips(const Result& r)
+{
+    return (r.threaded_seconds > 0.0) ? r.instructions / r.threaded_seconds / 1e6 : 0.0;
+}
+
+static double nsPerInstruction(const Result& r)
+{
+    return (r.instructions != 0) ? r.seconds * 1e9 / r.instructions : 0.0;
+}
+
+static void printText(const std::vector<Result>& results)
+{
+    printf("%-12s %14s %14s %9s %9s %9s %9s\n", "scenario", "cycles", "instructions", "seconds", "MIPS", "ns/instr", "threaded");
+
+    for (const Result& r : results)
+    {
+        printf("%-12s %14" PRIu64 " %14" PRIu64 " %9.3f %9.1f %9.2f %9.1f\n",
+            r.name.c_str(), r.cycles, r.instructions, r.seconds, mips(r), nsPerInstruction(r), threadedMips(r));
+
+        for (size_t i = 0; i < r.handlers.size() && i < TEXT_HANDLERS; i++)
+        {
+            printf("    %-10s %14" PRIu64 " %6.2f%%\n", r.handlers[i].first.c_str(), r.handlers[i].second,
+                100.0 * r.handlers[i].second / r.instructions);
+        }
+    }
+}
+
+static void printJson(const std::vector<Result>& results)
+{
+    printf("{\n  \"scenarios\": [");
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const Result& r = results[i];
+
+        printf("%s\n    {\n", (i != 0) ? "," : "");
+        printf("      \"name\": \"%s\",\n", r.name.c_str());
+        printf("      \"cycles\": %" PRIu64 ",\n", r.cycles);
+        printf("      \"instructions\": %" PRIu64 ",\n", r.instructions);
+        printf("      \"seconds\": %.6f,\n", r.seconds);
+        printf("      \"mips\": %.3f,\n", mips(r));
+        printf("      \"ns_per_instruction\": %.4f,\n", nsPerInstruction(r));
+        printf("      \"threaded_seconds\": %.6f,\n", r.threaded_seconds);
+        printf("      \"threaded_mips\": %.3f,\n", threadedMips(r));
+        printf("      \"handlers\": {");
+
+        for (size_t h = 0; h < r.handlers.size(); h++)
+        {
+            printf("%s\n        \"%s\": %" PRIu64, (h != 0) ? "," : "", r.handlers[h].first.c_str(), r.handlers[h].second);
+        }
+
+        printf("%s}\n    }", r.handlers.empty() ? "" : "\n      ");
+    }
+
+    printf("\n  ]\n}\n");
+}
+
+static bool parseOptions(int argc, char* argv[], Options& options, int& memtables, int& rewind)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        bool has_value = (i + 1 < argc);
+
+        if (!strcmp(arg, "--json"))
+        {
+            options.json = true;
+        }
+        else if (!strcmp(arg, "--no-profile"))
+        {
+            options.profile = false;
+        }
+        else if (!strcmp(arg, "--cycles") && has_value)
+        {
+            options.cycles = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(arg, "--rom") && has_value)
+        {
+            options.rom = argv[++i];
+        }
+        else if (!strcmp(arg, "--frames") && has_value)
+        {
+            options.frames = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        }
+        else if (!strcmp(arg, "--memtables"))
+        {
+            memtables = (has_value && argv[i + 1][0] != '-') ?
+                (int)strtoul(argv[++i], nullptr, 10) : DEFAULT_MEMTABLES_ITERATIONS;
+        }
+        else if (!strcmp(arg, "--rewind"))
+        {
+            rewind = (has_value && argv[i + 1][0] != '-') ?
+                (int)strtoul(argv[++i], nullptr, 10) : DEFAULT_REWIND_SNAPSHOTS;
+        }
+        else if (arg[0] != '-')
+        {
+            options.scenarios.emplace_back(arg);
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return options.cycles != 0 && options.frames != 0;
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    int memtables = 0;
+    int rewind = 0;
+
+    if (!parseOptions(argc, argv, options, memtables, rewind))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // the log goes to stdout, keep it out of the JSON
+    logging::core::get()->set_filter(logging::trivial::severity >= logging::trivial::warning);
+    logging::core::get()->set_logging_enabled(!options.json);
+
+    ConfigStore& config = ConfigStore::getInstance();
+    config.setPersistent(false);
+
+    registerNullPlugins();
+    config.set(CFG_SECTION_CORE, CFG_GFX_PLUGIN, NULL_GFX_PLUGIN);
+    config.set(CFG_SECTION_CORE, CFG_AUDIO_PLUGIN, NULL_AUDIO_PLUGIN);
+    config.set(CFG_SECTION_CORE, CFG_RSP_PLUGIN, NULL_RSP_PLUGIN);
+    config.set(CFG_SECTION_CORE, CFG_INPUT_PLUGIN, NULL_INPUT_PLUGIN);
+    config.set(CFG_SECTION_CORE, CFG_REWIND_INTERVAL, (uint32_t)0);
+
+    CoreControl::limitVI = false;
+
+    if (memtables != 0)
+    {
+        return runMemTables((uint32_t)memtables);
+    }
+
+    if (rewind != 0)
+    {
+        return runRewindBench((uint32_t)rewind);
+    }
+
+    if (options.scenarios.empty())
+    {
+        for (size_t i = 0; i < SCENARIO_COUNT; i++)
+        {
+            options.scenarios.emplace_back(SCENARIOS[i].name);
+        }
+
+        if (options.rom != nullptr)
+        {
+            options.scenarios.emplace_back("boot");
+        }
+    }
+
+    std::vector<Result> results;
+
+    for (const std::string& name : options.scenarios)
+    {
+        Result result;
+        bool ok;
+
+        if (name == "boot")
+        {
+            if (nullptr == options.rom)
+            {
+                fprintf(stderr, "The boot scenario needs --rom\n");
+                return 1;
+            }
+
+            ok = runScenario("boot", options.rom, nullptr, 0, options.frames, options.profile, result);
+        }
+        else
+        {
+            const Scenario* scenario = std::find_if(SCENARIOS, SCENARIOS + SCENARIO_COUNT,
+                [&name](const Scenario& s) { return name == s.name; });
+
+            if (scenario == SCENARIOS + SCENARIO_COUNT)
+            {
+                fprintf(stderr, "Unknown scenario %s\n", name.c_str());
+                usage(argv[0]);
+                return 1;
+            }
+
+            ok = runScenario(scenario->name, nullptr, scenario->load, options.cycles, 0, options.profile, result);
+        }
+
+        if (!ok)
+        {
+            fprintf(stderr, "Could not run scenario %s\n", name.c_str());
+            return 1;
+        }
+
+        results.push_back(result);
+    }
+
+    if (options.json)
+    {
+        printJson(results);
+    }
+    else
+    {
+        printText(results);
+    }
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+/* Micro-benchmark for the interpreter load/store handlers.
+ * Each handler is run on RDRAM addresses once through the memory
+ * tables and once through the direct RDRAM path */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#include <core/bus.h>
+#include <cpu/interpreter.h>
+#include <mem/mpmemory.h>
+#include <plugin/plugincontainer.h>
+#include <rom/rom.h>
+
+#include "memtables.h"
+#include "scenarios.h"
+
+
+#define DATA_ADDRESS 0x80100000
+
+
+struct BenchOp
+{
+    const char* name;
+    uint32_t op;
+};
+
+static const BenchOp BENCH_OPS[] = {
+    { "LB", 32 }, { "LBU", 36 }, { "LH", 33 }, { "LHU", 37 }, { "LW", 35 }, { "LWU", 39 }, { "LD", 55 },
+    { "SB", 40 }, { "SH", 41 }, { "SW", 43 }, { "SD", 63 }
+};
+
+
+class TableMemory : public MPMemory
+{
+public:
+    // force RDRAM accesses through the memory tables or not
+    void setDirect(bool direct)
+    {
+        fill_array(_rdram_direct, 0, (RDRAM_SIZE >> 16), direct);
+    }
+};
+
+class TableCPU : public Interpreter
+{
+public:
+    // returns handler calls per second for base=r1, rt=r2
+    double run(uint32_t op, uint32_t iterations)
+    {
+        _cur_instr.code = (op << 26) | (1 << 21) | (2 << 16);
+        auto handler = instruction_table[op];
+
+        _reg[2].u = 0x0123456789abcdefULL;
+
+        auto start = std::chrono::high_resolution_clock::now();
+
+        for (uint32_t i = 0; i < iterations; i++)
+        {
+            _reg[1].u = DATA_ADDRESS + ((i << 3) & 0xfff8);
+            (this->*handler)();
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+        return iterations / elapsed.count();
+    }
+};
+
+
+int runMemTables(uint32_t iterations)
+{
+    Rom* rom = createScenarioRom();
+
+    if (nullptr == rom)
+    {
+        fprintf(stderr, "Could not create benchmark ROM\n");
+        return 1;
+    }
+
+    Bus bus(rom);
+    PluginContainer plugins;
+    TableMemory mem;
+    TableCPU cpu;
+
+    // plugins are never initialized, none of the benchmarked paths use them
+    if (!bus.connectDevices(&cpu, &mem, &plugins) || !mem.initialize(&bus) || !cpu.initialize(&bus))
+    {
+        fprintf(stderr, "Could not initialize devices\n");
+        return 1;
+    }
+
+    printf("%-6s %16s %16s %8s\n", "op", "tables (Mops/s)", "direct (Mops/s)", "speedup");
+
+    for (const BenchOp& op : BENCH_OPS)
+    {
+        mem.setDirect(false);
+        double tables = cpu.run(op.op, iterations);
+
+        mem.setDirect(true);
+        double direct = cpu.run(op.op, iterations);
+
+        printf("%-6s %16.1f %16.1f %7.2fx\n", op.name, tables / 1e6, direct / 1e6, direct / tables);
+    }
+
+    cpu.uninitialize(&bus);
+    mem.uninitialize(&bus);
+
+    return 0;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <cstdint>
+
+// compares the load/store handlers through the memory tables and the
+// direct RDRAM path, prints a table and returns the exit code
+int runMemTables(uint32_t iterations);
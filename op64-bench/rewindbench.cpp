@@ -0,0 +1,124 @@
+/* Micro-benchmark for rewind snapshots. The same RDRAM pages change
+ * between snapshots, once marked by the core write path and once
+ * written behind it like a plugin would, left to the per-VI compare */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+
+#include <core/bus.h>
+#include <core/rewind.h>
+#include <cpu/cpufactory.h>
+#include <cpu/cputypes.h>
+#include <cpu/icpu.h>
+#include <mem/mpmemory.h>
+#include <plugin/plugincontainer.h>
+#include <rom/rom.h>
+
+#include "rewindbench.h"
+#include "scenarios.h"
+
+
+// pages written between two snapshots, each with one run of new words
+#define CHANGED_PAGES 256
+#define PAGE_SIZE 0x1000
+#define RUN_SIZE 0x400
+
+// VIs per snapshot, the configured default
+#define REWIND_INTERVAL 30
+
+
+struct VITime
+{
+    double mean;
+    double max;
+};
+
+// times every VI, the ones that take a snapshot included
+static VITime timeVIs(Bus& bus, Rewind& rewind, uint32_t snapshots, bool plugins)
+{
+    std::mt19937 rng(0x0964);
+    double total = 0.0;
+    double worst = 0.0;
+    uint32_t vis = snapshots * REWIND_INTERVAL;
+
+    for (uint32_t i = 0; i < vis; i++)
+    {
+        for (uint32_t p = 0; p < CHANGED_PAGES / REWIND_INTERVAL; p++)
+        {
+            uint32_t address = (rng() % (RDRAM_SIZE / PAGE_SIZE)) * PAGE_SIZE + (rng() % 4) * RUN_SIZE;
+
+            for (uint32_t word = 0; word < RUN_SIZE / 4; word++)
+            {
+                Bus::rdram.mem[(address / 4) + word] = rng();
+            }
+
+            if (!plugins)
+            {
+                bus.cpu->invalidateCode(address, RUN_SIZE);
+            }
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+
+        rewind.vi(&bus);
+
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+        total += elapsed.count();
+        worst = std::max(worst, elapsed.count());
+    }
+
+    return { total / vis, worst };
+}
+
+int runRewindBench(uint32_t snapshots)
+{
+    Rom* rom = createScenarioRom();
+
+    if (nullptr == rom)
+    {
+        fprintf(stderr, "Could not create benchmark ROM\n");
+        return 1;
+    }
+
+    Bus bus(rom);
+    PluginContainer plugins;
+    MPMemory mem;
+    std::unique_ptr<ICPU> cpu(createCPU(CPU_INTERPRETER));
+
+    if (!bus.connectDevices(cpu.get(), &mem, &plugins) || !bus.initializeDevices())
+    {
+        fprintf(stderr, "Could not initialize devices\n");
+        return 1;
+    }
+
+    std::mt19937 rng(0x64);
+
+    for (uint32_t i = 0; i < RDRAM_SIZE / 4; i++)
+    {
+        Bus::rdram.mem[i] = rng();
+    }
+
+    // deltas are dropped as they go, only the VIs are timed
+    Rewind rewind(REWIND_INTERVAL, 0);
+    rewind.capture(&bus);
+
+    VITime core = timeVIs(bus, rewind, snapshots, false);
+    VITime unmarked = timeVIs(bus, rewind, snapshots, true);
+
+    printf("%u changed pages per snapshot, a snapshot every %u VIs, %u snapshots\n",
+        CHANGED_PAGES, REWIND_INTERVAL, snapshots);
+    printf("%-8s %14s %14s\n", "writes", "VI mean (ms)", "VI max (ms)");
+    printf("%-8s %14.3f %14.3f\n", "core", core.mean, core.max);
+    printf("%-8s %14.3f %14.3f\n", "plugins", unmarked.mean, unmarked.max);
+
+    plugins.uninitialize(&bus);
+    mem.uninitialize(&bus);
+    cpu->uninitialize(&bus);
+
+    return 0;
+}
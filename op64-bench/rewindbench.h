@@ -0,0 +1,7 @@
+#pragma once
+
+#include <cstdint>
+
+// times the VIs of a rewind interval with RDRAM written by the core and
+// behind it like a plugin would, prints a table and returns the exit code
+int runRewindBench(uint32_t snapshots);
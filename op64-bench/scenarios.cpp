@@ -0,0 +1,444 @@
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include <core/bus.h>
+#include <rom/rom.h>
+
+#include "scenarios.h"
+
+
+#define PROGRAM_ADDRESS 0x80001000
+#define DATA_ADDRESS    0x80100000
+
+// the tlb scenario maps code and data pages here
+#define MAPPED_CODE     0x00400000
+#define MAPPED_DATA     0x00402000
+#define MAPPED_PHYSICAL 0x00200000
+
+#define BLOCK_SIZE 128
+
+// registers the generated code works on, t0-t7 and s0-s7
+#define FIRST_REG 8
+#define REG_COUNT 16
+
+#define BASE_REG 30
+
+
+static inline uint32_t R(uint32_t rs, uint32_t rt, uint32_t rd, uint32_t sa, uint32_t func)
+{
+    return (rs << 21) | (rt << 16) | (rd << 11) | (sa << 6) | func;
+}
+
+static inline uint32_t I(uint32_t op, uint32_t rs, uint32_t rt, uint32_t imm)
+{
+    return (op << 26) | (rs << 21) | (rt << 16) | (imm & 0xffff);
+}
+
+static inline uint32_t F(uint32_t fmt, uint32_t ft, uint32_t fs, uint32_t fd, uint32_t func)
+{
+    return (17 << 26) | (fmt << 21) | (ft << 16) | (fs << 11) | (fd << 6) | func;
+}
+
+static inline uint32_t MTC0(uint32_t rt, uint32_t rd)
+{
+    return (16 << 26) | (4 << 21) | (rt << 16) | (rd << 11);
+}
+
+static inline uint32_t MTC1(uint32_t rt, uint32_t fs, bool dword)
+{
+    return (17 << 26) | ((dword ? 5 : 4) << 21) | (rt << 16) | (fs << 11);
+}
+
+enum : uint32_t
+{
+    FMT_S = 16,
+    FMT_D = 17,
+    FMT_W = 20
+};
+
+
+class Random
+{
+public:
+    uint32_t next(void)
+    {
+        _state = _state * 1664525 + 1013904223;
+        return _state >> 8;
+    }
+
+    uint32_t below(uint32_t n)
+    {
+        return next() % n;
+    }
+
+    uint32_t reg(void)
+    {
+        return FIRST_REG + below(REG_COUNT);
+    }
+
+private:
+    uint32_t _state = 0x5eed;
+};
+
+
+class Program
+{
+public:
+    Program(uint32_t address, uint32_t physical) :
+        _address(address),
+        _physical(physical)
+    {
+    }
+
+    void emit(uint32_t op)
+    {
+        _code.push_back(op);
+    }
+
+    uint32_t here(void) const
+    {
+        return _address + (uint32_t)_code.size() * 4;
+    }
+
+    void jump(uint32_t target)
+    {
+        emit((2 << 26) | ((target >> 2) & 0x3ffffff));
+        emit(0);
+    }
+
+    void loadConstant(uint32_t reg, uint32_t value)
+    {
+        emit(I(15, 0, reg, value >> 16));
+        emit(I(13, reg, reg, value));
+    }
+
+    void copyToRDRAM(void) const
+    {
+        for (size_t i = 0; i < _code.size(); i++)
+        {
+            Bus::rdram.mem[(_physical >> 2) + i] = _code[i];
+        }
+    }
+
+private:
+    uint32_t _address;
+    uint32_t _physical;
+    std::vector<uint32_t> _code;
+};
+
+
+static void emitRegisterSetup(Program& p, Random& rnd)
+{
+    for (uint32_t reg = FIRST_REG; reg < FIRST_REG + REG_COUNT; reg++)
+    {
+        p.loadConstant(reg, rnd.next() * 2654435761U);
+    }
+}
+
+static void emitAlu(Program& p, Random& rnd)
+{
+    static const uint32_t R_OPS[] = { 33, 35, 36, 37, 38, 39, 42, 43, 45, 47 }; // ADDU SUBU AND OR XOR NOR SLT SLTU DADDU DSUBU
+    static const uint32_t SHIFT_OPS[] = { 0, 2, 3, 56, 58, 59 };                // SLL SRL SRA DSLL DSRL DSRA
+    static const uint32_t I_OPS[] = { 9, 10, 11, 12, 13, 14, 25 };              // ADDIU SLTI SLTIU ANDI ORI XORI DADDIU
+
+    uint32_t rd = rnd.reg();
+    uint32_t rs = rnd.reg();
+    uint32_t rt = rnd.reg();
+
+    switch (rnd.below(8))
+    {
+    case 0:
+        p.emit(R(0, rt, rd, rnd.below(32), SHIFT_OPS[rnd.below(6)]));
+        break;
+
+    case 1:
+    case 2:
+        p.emit(I(I_OPS[rnd.below(7)], rs, rd, rnd.next()));
+        break;
+
+    case 3:
+        if (rnd.below(8) == 0)
+        {
+            // MULT, MFLO
+            p.emit(R(rs, rt, 0, 0, 24));
+            p.emit(R(0, 0, rd, 0, 18));
+        }
+        else
+        {
+            p.emit(I(15, 0, rd, rnd.next()));
+        }
+        break;
+
+    default:
+        p.emit(R(rs, rt, rd, 0, R_OPS[rnd.below(10)]));
+        break;
+    }
+}
+
+static void emitLoadStore(Program& p, Random& rnd, uint32_t range)
+{
+    struct Access
+    {
+        uint32_t op;
+        uint32_t size;
+    };
+
+    static const Access ACCESSES[] = {
+        { 35, 4 }, { 43, 4 }, { 35, 4 }, { 43, 4 }, // LW SW
+        { 55, 8 }, { 63, 8 },                       // LD SD
+        { 36, 1 }, { 32, 1 }, { 40, 1 },            // LBU LB SB
+        { 37, 2 }, { 33, 2 }, { 41, 2 },            // LHU LH SH
+        { 39, 4 }                                   // LWU
+    };
+
+    const Access& access = ACCESSES[rnd.below(sizeof(ACCESSES) / sizeof(ACCESSES[0]))];
+    uint32_t offset = rnd.below(range) & ~(access.size - 1);
+
+    p.emit(I(access.op, BASE_REG, rnd.reg(), offset));
+}
+
+
+static void loadAlu(void)
+{
+    Random rnd;
+    Program p(PROGRAM_ADDRESS, PROGRAM_ADDRESS & 0x1fffffff);
+
+    emitRegisterSetup(p, rnd);
+
+    uint32_t loop = p.here();
+
+    for (uint32_t i = 0; i < BLOCK_SIZE; i++)
+    {
+        emitAlu(p, rnd);
+    }
+
+    p.jump(loop);
+    p.copyToRDRAM();
+}
+
+static void loadLoadStore(void)
+{
+    Random rnd;
+    Program p(PROGRAM_ADDRESS, PROGRAM_ADDRESS & 0x1fffffff);
+
+    emitRegisterSetup(p, rnd);
+    p.loadConstant(BASE_REG, DATA_ADDRESS);
+
+    uint32_t loop = p.here();
+
+    for (uint32_t i = 0; i < BLOCK_SIZE; i++)
+    {
+        emitLoadStore(p, rnd, 0x8000);
+    }
+
+    p.jump(loop);
+    p.copyToRDRAM();
+}
+
+static void loadBranch(void)
+{
+    static const uint32_t BRANCH_OPS[] = { 4, 5, 20, 21 }; // BEQ BNE BEQL BNEL
+
+    Random rnd;
+    Program p(PROGRAM_ADDRESS, PROGRAM_ADDRESS & 0x1fffffff);
+
+    emitRegisterSetup(p, rnd);
+
+    // leaf function for the calls below, branched over on the way in
+    p.emit(I(4, 0, 0, 3));
+    p.emit(0);
+    uint32_t leaf = p.here();
+    p.emit(R(31, 0, 0, 0, 8));
+    p.emit(I(9, 12, 12, 1));
+
+    uint32_t loop = p.here();
+
+    for (uint32_t i = 0; i < BLOCK_SIZE / 4; i++)
+    {
+        p.emit(I(9, 8, 8, 1));
+        p.emit(I(12, 8, 9, 1 << rnd.below(4)));
+
+        if (rnd.below(8) == 0)
+        {
+            // JAL, then BGEZ over the next instruction
+            p.emit((3 << 26) | ((leaf >> 2) & 0x3ffffff));
+            p.emit(0);
+            p.emit(I(1, 9, 1, 2));
+        }
+        else
+        {
+            p.emit(I(BRANCH_OPS[rnd.below(4)], 9, 0, 2));
+        }
+
+        p.emit(R(10, 8, 10, 0, 33));
+        p.emit(R(11, 10, 11, 0, 38));
+    }
+
+    p.jump(loop);
+    p.copyToRDRAM();
+}
+
+static void loadFpu(void)
+{
+    Program p(PROGRAM_ADDRESS, PROGRAM_ADDRESS & 0x1fffffff);
+
+    // x = x * 0.5 + 0.5 stays near 1.0 however long it runs
+    p.emit(I(15, 0, 8, 0x3fe0));
+    p.emit(R(0, 8, 8, 0, 60));
+    p.emit(MTC1(8, 4, true));
+    p.emit(MTC1(8, 6, true));
+    p.emit(MTC1(0, 2, true));
+
+    p.loadConstant(8, 0x40400000); // 3.0f
+    p.emit(MTC1(8, 10, false));
+    p.loadConstant(8, 0x40000000); // 2.0f
+    p.emit(MTC1(8, 12, false));
+    p.emit(I(13, 0, 8, 7));
+    p.emit(MTC1(8, 20, false));
+
+    p.loadConstant(BASE_REG, DATA_ADDRESS);
+
+    uint32_t loop = p.here();
+
+    for (uint32_t i = 0; i < BLOCK_SIZE / 16; i++)
+    {
+        p.emit(F(FMT_D, 4, 2, 2, 2));       // MUL.D
+        p.emit(F(FMT_D, 6, 2, 2, 0));       // ADD.D
+        p.emit(F(FMT_D, 0, 2, 8, 4));       // SQRT.D
+        p.emit(F(FMT_D, 2, 8, 14, 1));      // SUB.D
+        p.emit(F(FMT_S, 12, 10, 16, 3));    // DIV.S
+        p.emit(F(FMT_S, 12, 16, 18, 0));    // ADD.S
+        p.emit(F(FMT_S, 0, 18, 22, 33));    // CVT.D.S
+        p.emit(F(FMT_D, 0, 22, 24, 32));    // CVT.S.D
+        p.emit(F(FMT_W, 0, 20, 26, 33));    // CVT.D.W
+        p.emit(F(FMT_S, 0, 18, 28, 13));    // TRUNC.W.S
+        p.emit((17 << 26) | (9 << 16) | (28 << 11)); // MFC1
+        p.emit(I(61, BASE_REG, 2, i * 8));  // SDC1
+        p.emit(I(53, BASE_REG, 30, i * 8)); // LDC1
+        p.emit(F(FMT_D, 2, 8, 0, 60));      // C.LT.D
+        p.emit((17 << 26) | (8 << 21) | (1 << 16) | 1); // BC1T
+        p.emit(F(FMT_D, 0, 2, 30, 6));      // MOV.D
+    }
+
+    p.jump(loop);
+    p.copyToRDRAM();
+}
+
+static void loadTlb(void)
+{
+    struct Mapping
+    {
+        uint32_t virt;
+        uint32_t phys;
+    };
+
+    static const Mapping MAPPINGS[] = {
+        { MAPPED_CODE, MAPPED_PHYSICAL },
+        { MAPPED_DATA, MAPPED_PHYSICAL + (MAPPED_DATA - MAPPED_CODE) }
+    };
+
+    Random rnd;
+    Program setup(PROGRAM_ADDRESS, PROGRAM_ADDRESS & 0x1fffffff);
+
+    // 4KB pages, each entry maps an even and odd page
+    setup.emit(MTC0(0, 5));
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        uint32_t pfn = MAPPINGS[i].phys >> 12;
+
+        setup.emit(I(13, 0, 8, i));
+        setup.emit(MTC0(8, 0));
+        setup.emit(I(15, 0, 8, MAPPINGS[i].virt >> 16));
+        setup.emit(I(13, 8, 8, MAPPINGS[i].virt));
+        setup.emit(MTC0(8, 10));
+        setup.emit(I(13, 0, 8, (pfn << 6) | 7));
+        setup.emit(MTC0(8, 2));
+        setup.emit(I(13, 0, 8, ((pfn + 1) << 6) | 7));
+        setup.emit(MTC0(8, 3));
+        setup.emit(0x42000002); // TLBWI
+    }
+
+    // JR, J would stay in kseg0
+    setup.loadConstant(8, MAPPED_CODE);
+    setup.emit(R(8, 0, 0, 0, 8));
+    setup.emit(0);
+    setup.copyToRDRAM();
+
+    Program p(MAPPED_CODE, MAPPED_PHYSICAL);
+
+    emitRegisterSetup(p, rnd);
+    p.loadConstant(BASE_REG, MAPPED_DATA);
+
+    uint32_t loop = p.here();
+
+    for (uint32_t i = 0; i < BLOCK_SIZE; i++)
+    {
+        if (rnd.below(2))
+        {
+            emitLoadStore(p, rnd, 0x2000);
+        }
+        else
+        {
+            emitAlu(p, rnd);
+        }
+    }
+
+    p.jump(loop);
+    p.copyToRDRAM();
+}
+
+
+const Scenario SCENARIOS[] = {
+    { "alu", "integer ALU mix", &loadAlu },
+    { "loadstore", "RDRAM loads and stores", &loadLoadStore },
+    { "branch", "short blocks with conditional branches and calls", &loadBranch },
+    { "fpu", "single and double precision arithmetic", &loadFpu },
+    { "tlb", "code and data in TLB mapped pages", &loadTlb }
+};
+
+const size_t SCENARIO_COUNT = sizeof(SCENARIOS) / sizeof(SCENARIOS[0]);
+
+
+Rom* createScenarioRom(void)
+{
+    boost::filesystem::path path = boost::filesystem::temp_directory_path() /
+        boost::filesystem::unique_path("op64-bench-%%%%%%%%.z64");
+
+    std::vector<uint8_t> image(0x101000, 0);
+
+    auto put = [&image](uint32_t offset, uint32_t word)
+    {
+        image[offset + 0] = (uint8_t)(word >> 24);
+        image[offset + 1] = (uint8_t)(word >> 16);
+        image[offset + 2] = (uint8_t)(word >> 8);
+        image[offset + 3] = (uint8_t)word;
+    };
+
+    put(0x00, 0x80371240);
+
+    // boot code: jump to PROGRAM_ADDRESS
+    put(0x40, I(15, 0, 8, PROGRAM_ADDRESS >> 16));
+    put(0x44, I(13, 8, 8, PROGRAM_ADDRESS));
+    put(0x48, R(8, 0, 0, 0, 8));
+    put(0x4c, 0);
+
+    {
+        std::ofstream file(path.string(), std::ios::out | std::ios::binary);
+        file.write((const char*)image.data(), image.size());
+    }
+
+    Rom* rom = nullptr;
+
+    if (!Rom::loadRom(path.string().c_str(), rom))
+    {
+        rom = nullptr;
+    }
+
+    boost::filesystem::remove(path);
+
+    return rom;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+
+class Rom;
+
+
+/************************************************************************/
+/* Synthetic programs the benchmark runs                                */
+/************************************************************************/
+struct Scenario
+{
+    const char* name;
+    const char* description;
+
+    // writes the program into RDRAM once the devices are initialized
+    void(*load)(void);
+};
+
+extern const Scenario SCENARIOS[];
+extern const size_t SCENARIO_COUNT;
+
+// rom whose boot code jumps to the scenario programs at 0x80001000
+Rom* createScenarioRom(void);
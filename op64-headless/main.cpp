@@ -0,0 +1,272 @@
+/* Runs a ROM for a fixed number of VIs without a frontend, using
+ * plugins that do nothing. Prints the run time and a hash of RDRAM
+ * so batch runs can be compared. Can start from a save state and
+ * write one after the last VI, and run ABI 1 audio tasks in the core
+ * to record what the AI plays */
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include <oplog.h>
+#include <oputil.h>
+
+#include <globalstrings.h>
+#include <core/bus.h>
+#include <core/savestate.h>
+#include <cpu/cpufactory.h>
+#include <cpu/cputypes.h>
+#include <mem/mpmemory.h>
+#include <plugin/nullplugins.h>
+#include <plugin/plugincontainer.h>
+#include <rcp/rcp.h>
+#include <rom/rom.h>
+#include <ui/configstore.h>
+#include <ui/corecontrol.h>
+
+using namespace GlobalStrings;
+
+
+#define DEFAULT_FRAMES 600
+
+
+static const char* save_path = nullptr;
+static uint32_t save_frame = 0;
+
+static FILE* wav_file = nullptr;
+static uint32_t wav_bytes = 0;
+
+
+// FNV-1a over the RDRAM words
+static uint64_t hashRDRAM(void)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (uint32_t i = 0; i < (RDRAM_SIZE / 4); i++)
+    {
+        hash = (hash ^ Bus::rdram.mem[i]) * 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+// the state is written at the next interrupt after the last VI, which also stops the core
+static void saveOnFrame(uint32_t frame)
+{
+    if (frame == save_frame)
+    {
+        SaveState::requestSave(save_path, true);
+    }
+}
+
+static void put16(uint8_t* dst, uint16_t value)
+{
+    dst[0] = (uint8_t)value;
+    dst[1] = (uint8_t)(value >> 8);
+}
+
+static void put32(uint8_t* dst, uint32_t value)
+{
+    put16(dst, (uint16_t)value);
+    put16(dst + 2, (uint16_t)(value >> 16));
+}
+
+// 16 bit stereo, the sizes are filled in once the run is over
+static void writeWavHeader(uint32_t rate)
+{
+    uint8_t header[44];
+
+    memcpy(header, "RIFF", 4);
+    put32(header + 4, 36 + wav_bytes);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    put32(header + 16, 16);
+    put16(header + 20, 1);
+    put16(header + 22, 2);
+    put32(header + 24, rate);
+    put32(header + 28, rate * 4);
+    put16(header + 32, 4);
+    put16(header + 34, 16);
+    memcpy(header + 36, "data", 4);
+    put32(header + 40, wav_bytes);
+
+    fseek(wav_file, 0, SEEK_SET);
+    fwrite(header, 1, sizeof(header), wav_file);
+    fseek(wav_file, 0, SEEK_END);
+}
+
+// the AI plays big endian samples straight from RDRAM
+static void writeAudio(uint32_t address, uint32_t length)
+{
+    static uint8_t buffer[0x40000];
+
+    if (address + length > RDRAM_SIZE)
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < length; i += 2)
+    {
+        put16(buffer + i, *(uint16_t*)((uint8_t*)Bus::rdram.mem + HES(address + i)));
+    }
+
+    fwrite(buffer, 1, length, wav_file);
+    wav_bytes += length;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+        "usage: %s [options] <rom> [frames] [cpu core]\n"
+        "  --load-state PATH   start from a save state\n"
+        "  --save-state PATH   write a save state after the last frame\n"
+        "  --wav PATH          run ABI 1 audio tasks in the core and record the AI to PATH,\n"
+        "                      other audio microcodes need an RSP plugin\n",
+        name);
+}
+
+int main(int argc, char* argv[])
+{
+    const char* positional[3] = { nullptr, nullptr, nullptr };
+    const char* load_path = nullptr;
+    const char* wav_path = nullptr;
+    int count_positional = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--load-state") && i + 1 < argc)
+        {
+            load_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--save-state") && i + 1 < argc)
+        {
+            save_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--wav") && i + 1 < argc)
+        {
+            wav_path = argv[++i];
+        }
+        else if (argv[i][0] != '-' && count_positional < 3)
+        {
+            positional[count_positional++] = argv[i];
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (count_positional < 1)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    logging::core::get()->set_filter(logging::trivial::severity >= logging::trivial::warning);
+
+    const char* rompath = positional[0];
+    uint32_t frames = (positional[1] != nullptr) ? (uint32_t)strtoul(positional[1], nullptr, 10) : DEFAULT_FRAMES;
+    uint32_t core = (positional[2] != nullptr) ? (uint32_t)strtoul(positional[2], nullptr, 10) : (uint32_t)CPU_INTERPRETER;
+
+    if (frames == 0)
+    {
+        fprintf(stderr, "frames must be at least 1\n");
+        return 1;
+    }
+
+    // batch runs must not touch the user's config
+    ConfigStore& config = ConfigStore::getInstance();
+    config.setPersistent(false);
+
+    registerNullPlugins();
+    config.set(CFG_SECTION_CORE, CFG_GFX_PLUGIN, NULL_GFX_PLUGIN);
+    config.set(CFG_SECTION_CORE, CFG_AUDIO_PLUGIN, NULL_AUDIO_PLUGIN);
+    config.set(CFG_SECTION_CORE, CFG_RSP_PLUGIN, NULL_RSP_PLUGIN);
+    config.set(CFG_SECTION_CORE, CFG_INPUT_PLUGIN, NULL_INPUT_PLUGIN);
+    config.set(CFG_SECTION_CORE, CFG_REWIND_INTERVAL, (uint32_t)0);
+
+    CoreControl::limitVI = false;
+
+    if (wav_path != nullptr)
+    {
+        wav_file = fopen(wav_path, "wb");
+
+        if (wav_file == nullptr)
+        {
+            fprintf(stderr, "Could not open %s\n", wav_path);
+            return 1;
+        }
+
+        writeWavHeader(0);
+        config.set(CFG_SECTION_CORE, CFG_HLE_AUDIO, true);
+        setNullAudioCallback(writeAudio);
+    }
+
+    if (save_path != nullptr)
+    {
+        save_frame = frames;
+        setNullFrameCallback(saveOnFrame);
+        setNullFrameLimit(0);
+    }
+    else
+    {
+        setNullFrameLimit(frames);
+    }
+
+    Rom* rom = nullptr;
+
+    if (!Rom::loadRom(rompath, rom))
+    {
+        fprintf(stderr, "Could not load %s\n", rompath);
+        return 1;
+    }
+
+    Bus bus(rom);
+    PluginContainer plugins;
+    MPMemory mem;
+    std::unique_ptr<ICPU> cpu(createCPU(core));
+
+    if (!bus.connectDevices(cpu.get(), &mem, &plugins) || !bus.initializeDevices())
+    {
+        fprintf(stderr, "Could not initialize devices\n");
+        return 1;
+    }
+
+    // replaces the machine at the first interrupt, before any VI is counted
+    if (load_path != nullptr)
+    {
+        SaveState::requestLoad(load_path);
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    bus.executeMachine();
+
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+    uint32_t count = getNullFrameCount();
+
+    if (wav_file != nullptr)
+    {
+        writeWavHeader(rom->getAiDACRate() / (Bus::rcp.ai.reg[AI_DACRATE_REG] + 1));
+        fclose(wav_file);
+    }
+
+    printf("frames  %u\n", count);
+    printf("seconds %.3f\n", elapsed.count());
+    printf("vi/s    %.1f\n", count / elapsed.count());
+    printf("rdram   %016" PRIx64 "\n", hashRDRAM());
+
+    if (save_path != nullptr && SaveState::saveFailed())
+    {
+        fprintf(stderr, "Could not write %s\n", save_path);
+        return 1;
+    }
+
+    // with --save-state the core runs on to the interrupt that writes the state
+    return ((save_path != nullptr) ? count >= frames : count == frames) ? 0 : 1;
+}
@@ -4,6 +4,7 @@
 #include "configpages.h"
 
 #include <globalstrings.h>
+#include <cpu/cputypes.h>
 #include <ui/configstore.h>
 
 using namespace GlobalStrings;
@@ -86,6 +87,10 @@ void ConfigDialog::createConfigWidgets()
 {
     _widgets = new ConfigWidgets;
     _widgets->delaySICheckBox = new QCheckBox(tr("Delay SI"));
+    _widgets->dmaTimingCheckBox = new QCheckBox(tr("DMA timing"));
+    _widgets->rspThreadCheckBox = new QCheckBox(tr("Run audio tasks on their own thread"));
+    _widgets->hleAudioCheckBox = new QCheckBox(tr("Run ABI 1 audio tasks in the core, others use the RSP plugin"));
+    _widgets->cpuCoreCombo = new QComboBox;
     _widgets->savePath = new QLineEdit;
     _widgets->gfxCombo = new QComboBox;
     _widgets->audioCombo = new QComboBox;
@@ -94,6 +99,15 @@ void ConfigDialog::createConfigWidgets()
 
     ConfigStore& store = ConfigStore::getInstance();
     _widgets->delaySICheckBox->setChecked(store.getBool(CFG_SECTION_CORE, CFG_DELAY_SI));
+    _widgets->dmaTimingCheckBox->setChecked(store.getBool(CFG_SECTION_CORE, CFG_DMA_TIMING));
+    _widgets->rspThreadCheckBox->setChecked(store.getBool(CFG_SECTION_CORE, CFG_RSP_THREAD));
+    _widgets->hleAudioCheckBox->setChecked(store.getBool(CFG_SECTION_CORE, CFG_HLE_AUDIO));
+
+    _widgets->cpuCoreCombo->addItem(tr("Interpreter"), QVariant((uint32_t)CPU_INTERPRETER));
+    _widgets->cpuCoreCombo->addItem(tr("Cached Interpreter"), QVariant((uint32_t)CPU_CACHED));
+    _widgets->cpuCoreCombo->addItem(tr("Recompiler"), QVariant((uint32_t)CPU_JIT));
+    _widgets->cpuCoreCombo->setCurrentIndex(_widgets->cpuCoreCombo->findData(QVariant(store.getInt(CFG_SECTION_CORE, CFG_CPU_CORE))));
+
     _widgets->savePath->setText(QString(store.getString(CFG_SECTION_CORE, CFG_SAVE_PATH).c_str()));
 }
 
@@ -102,9 +116,19 @@ void ConfigDialog::saveAndClose(void)
     ConfigStore& store = ConfigStore::getInstance();
 
     store.set(CFG_SECTION_CORE, CFG_DELAY_SI, _widgets->delaySICheckBox->isChecked());
+    store.set(CFG_SECTION_CORE, CFG_DMA_TIMING, _widgets->dmaTimingCheckBox->isChecked());
+    store.set(CFG_SECTION_CORE, CFG_RSP_THREAD, _widgets->rspThreadCheckBox->isChecked());
+    store.set(CFG_SECTION_CORE, CFG_HLE_AUDIO, _widgets->hleAudioCheckBox->isChecked());
     // TODO save path
 
-    QVariant data = _widgets->gfxCombo->currentData();
+    QVariant data = _widgets->cpuCoreCombo->currentData();
+
+    if (data.isValid())
+    {
+        store.set(CFG_SECTION_CORE, CFG_CPU_CORE, data.toUInt());
+    }
+
+    data = _widgets->gfxCombo->currentData();
 
     if (data.isValid())
     {
@@ -13,6 +13,10 @@ class QComboBox;
 struct ConfigWidgets
 {
     QCheckBox* delaySICheckBox;
+    QCheckBox* dmaTimingCheckBox;
+    QCheckBox* rspThreadCheckBox;
+    QCheckBox* hleAudioCheckBox;
+    QComboBox* cpuCoreCombo;
     QLineEdit* savePath;
     QComboBox* gfxCombo;
     QComboBox* audioCombo;
@@ -28,8 +28,18 @@ EmulatorPage::EmulatorPage(ConfigWidgets* widgets, QWidget *parent)
 
     QLabel* saveLabel = new QLabel(tr("Save Path"));
 
+    QLabel* cpuCoreLabel = new QLabel(tr("CPU Core"));
+
+    QHBoxLayout *cpuCoreLayout = new QHBoxLayout;
+    cpuCoreLayout->addWidget(cpuCoreLabel);
+    cpuCoreLayout->addWidget(_widgets->cpuCoreCombo);
+
     QVBoxLayout *emuLayout = new QVBoxLayout;
+    emuLayout->addLayout(cpuCoreLayout);
     emuLayout->addWidget(_widgets->delaySICheckBox);
+    emuLayout->addWidget(_widgets->dmaTimingCheckBox);
+    emuLayout->addWidget(_widgets->rspThreadCheckBox);
+    emuLayout->addWidget(_widgets->hleAudioCheckBox);
     emulationGroup->setLayout(emuLayout);
 
     QVBoxLayout *pathsLayout = new QVBoxLayout;
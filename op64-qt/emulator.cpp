@@ -2,18 +2,20 @@
 
 #include "emulator.h"
 
+#include <globalstrings.h>
 #include <rom/rom.h>
 #include <plugin/gfxplugin.h>
-#include <cpu/interpreter.h>
+#include <cpu/cpufactory.h>
 #include <mem/mpmemory.h>
 
+#include <ui/configstore.h>
 #include <ui/corecontrol.h>
 
+using namespace GlobalStrings;
 
 Emulator::Emulator(WId mainwindow) :
 _state(DEAD),
 _plugins(new PluginContainer),
-_cpu(new Interpreter),
 _mem(new MPMemory),
 _mainwindow(mainwindow)
 {
@@ -109,6 +111,14 @@ void Emulator::gameSoftReset(void)
     }
 }
 
+void Emulator::gameRewind(void)
+{
+    if (_bus && _bus->rewind)
+    {
+        _bus->rewind->requestRewind(1);
+    }
+}
+
 void Emulator::runEmulator(void)
 {
     // Log some threading info
@@ -116,6 +126,8 @@ void Emulator::runEmulator(void)
 
     _plugins->setRenderWindow((void*)_renderwindow);
 
+    _cpu.reset(createCPU(ConfigStore::getInstance().getInt(CFG_SECTION_CORE, CFG_CPU_CORE)));
+
     if (initializeHardware(_plugins.get(), _cpu.get(), _mem.get()))
     {
         execute();
@@ -56,6 +56,7 @@ public slots:
     void setLimitFPS(bool limit);
     void gameHardReset(void);
     void gameSoftReset(void);
+    void gameRewind(void);
     void runEmulator(void);
 
     // plugin config
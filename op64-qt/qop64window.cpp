@@ -136,6 +136,7 @@ void QOP64Window::connectGUIControls(void)
     connect(ui.actionLimit_FPS, SIGNAL(toggled(bool)), _emu, SLOT(setLimitFPS(bool)), Qt::DirectConnection);
     connect(ui.actionHard_Reset, SIGNAL(triggered()), _emu, SLOT(gameHardReset()), Qt::DirectConnection);
     connect(ui.actionSoft_Reset, SIGNAL(triggered()), _emu, SLOT(gameSoftReset()), Qt::DirectConnection);
+    connect(ui.actionRewind, SIGNAL(triggered()), _emu, SLOT(gameRewind()), Qt::DirectConnection);
     connect(ui.actionFullscreen, SIGNAL(triggered()), this, SLOT(toggleFullscreen()));
 
     // options
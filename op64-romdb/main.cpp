@@ -0,0 +1,54 @@
+/* Compiles romdb.ini into the binary index RomDB maps at startup,
+ * so short runs skip parsing the ini and its cheat strings */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+#include <oplog.h>
+
+#include <ui/romdb.h>
+
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+        "usage: %s [romdb.ini] [" ROMDB_INDEX_FILE "]\n"
+        "writes the index next to the ini by default, RomDB uses it when it is newer\n",
+        name);
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc > 3 || (argc > 1 && argv[1][0] == '-'))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    logging::core::get()->set_filter(logging::trivial::severity >= logging::trivial::warning);
+
+    const char* inipath = (argc > 1) ? argv[1] : "romdb.ini";
+    std::string indexpath = (argc > 2) ? argv[2] :
+        (boost::filesystem::path(inipath).parent_path() / ROMDB_INDEX_FILE).string();
+
+    RomDB::RomDatabase db;
+
+    if (!RomDB::parseIni(inipath, db))
+    {
+        fprintf(stderr, "Could not read %s\n", inipath);
+        return 1;
+    }
+
+    if (!RomDB::writeIndex(db, indexpath.c_str()))
+    {
+        fprintf(stderr, "Could not write %s\n", indexpath.c_str());
+        return 1;
+    }
+
+    printf("%zu entries written to %s\n", db.size(), indexpath.c_str());
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <oputil.h>
+#include <rcp/dma.h>
+
+#include "dmatest.h"
+
+
+#define SPDMA_ITERATIONS 1000
+
+// the widest transfer is 0x100 rows of 0x1000 bytes, and the RDRAM side
+// skips up to 0xfff more per row. Neither side wraps, so the buffers hold
+// a transfer started at the highest address
+#define SPMEM_SIZE (0x1000 + 0x100 * 0x1000 + 16)
+#define DRAM_SIZE (0x1000000 + 0x100 * 0x2000 + 16)
+
+
+// the per byte loops RSPInterface used before the row copies
+static void byteDMARead(uint8_t* dram, uint32_t dramaddr, const uint8_t* spmem, uint32_t memaddr, uint32_t length, uint32_t count, uint32_t skip)
+{
+    for (uint32_t j = 0; j < count; j++) {
+        for (uint32_t i = 0; i < length; i++) {
+            dram[BES(dramaddr)] = spmem[BES(memaddr)];
+            memaddr++;
+            dramaddr++;
+        }
+        dramaddr += skip;
+    }
+}
+
+static void byteDMAWrite(uint8_t* spmem, uint32_t memaddr, const uint8_t* dram, uint32_t dramaddr, uint32_t length, uint32_t count, uint32_t skip)
+{
+    for (uint32_t j = 0; j < count; j++) {
+        for (uint32_t i = 0; i < length; i++) {
+            spmem[BES(memaddr)] = dram[BES(dramaddr)];
+            memaddr++;
+            dramaddr++;
+        }
+        dramaddr += skip;
+    }
+}
+
+// word aligned range a transfer touches, with a margin to catch overruns
+static void touchedRange(uint32_t addr, uint32_t extent, uint32_t size, uint32_t* lo, uint32_t* hi)
+{
+    *lo = (addr & ~3) - std::min(addr & ~3, 8u);
+    *hi = std::min(((addr + extent + 3) & ~3) + 8, size);
+}
+
+static void fillRange(uint8_t* mem, uint32_t lo, uint32_t hi, uint32_t seed)
+{
+    for (uint32_t i = lo; i < hi; i++)
+    {
+        seed = seed * 1664525 + 1013904223;
+        mem[i] = (uint8_t)(seed >> 24);
+    }
+}
+
+static bool sameRange(const char* dir, const uint8_t* expected, const uint8_t* actual, uint32_t lo, uint32_t hi,
+    uint32_t memaddr, uint32_t dramaddr, uint32_t length, uint32_t count, uint32_t skip)
+{
+    if (memcmp(expected + lo, actual + lo, hi - lo) == 0)
+    {
+        return true;
+    }
+
+    uint32_t i = lo;
+    while (expected[i] == actual[i])
+    {
+        i++;
+    }
+
+    printf("  %s mem 0x%03x dram 0x%06x length 0x%x count %u skip 0x%x: byte 0x%x is 0x%02x, expected 0x%02x\n",
+        dir, memaddr, dramaddr, length, count, skip, i, actual[i], expected[i]);
+
+    return false;
+}
+
+bool testSPDMA(void)
+{
+    std::vector<uint8_t> spmem(SPMEM_SIZE), spmem_ref(SPMEM_SIZE);
+    std::vector<uint8_t> dram(DRAM_SIZE), dram_ref(DRAM_SIZE);
+
+    std::mt19937 rng(0x0964);
+    bool passed = true;
+
+    for (uint32_t n = 0; n < SPDMA_ITERATIONS && passed; n++)
+    {
+        uint32_t len_reg = rng();
+        uint32_t memaddr = rng() & 0xfff;
+        uint32_t dramaddr = rng() & 0xffffff;
+
+        switch (n % 8)
+        {
+        case 0:
+            // a single short row
+            len_reg &= 0xfff000ff;
+            break;
+        case 1:
+            // contiguous rows, copied as one transfer
+            len_reg &= 0x000fffff;
+            break;
+        case 2:
+            // unaligned on both sides by the same amount
+            memaddr = (memaddr & ~3) | 1;
+            dramaddr = (dramaddr & ~3) | 1;
+            break;
+        case 3:
+            // unaligned on one side only, no word copies possible
+            memaddr = (memaddr & ~3) | 2;
+            dramaddr = (dramaddr & ~3) | 1;
+            break;
+        case 4:
+            // ends of both memories, rows run past the 4KB SP memory
+            memaddr = 0xff8 | (memaddr & 7);
+            dramaddr = 0xfff000 | (dramaddr & 0xfff);
+            break;
+        default:
+            break;
+        }
+
+        uint32_t length = ((len_reg & 0xfff) | 7) + 1;
+        uint32_t count = ((len_reg >> 12) & 0xff) + 1;
+        uint32_t skip = ((len_reg >> 20) & 0xfff);
+
+        uint32_t sp_lo, sp_hi, dram_lo, dram_hi;
+        touchedRange(memaddr, count * length, SPMEM_SIZE, &sp_lo, &sp_hi);
+        touchedRange(dramaddr, count * (length + skip), DRAM_SIZE, &dram_lo, &dram_hi);
+
+        uint32_t seed = rng();
+
+        // SP memory to RDRAM
+        fillRange(spmem.data(), sp_lo, sp_hi, seed);
+        fillRange(dram.data(), dram_lo, dram_hi, ~seed);
+        fillRange(dram_ref.data(), dram_lo, dram_hi, ~seed);
+
+        byteDMARead(dram_ref.data(), dramaddr, spmem.data(), memaddr, length, count, skip);
+        dmaCopyRows(dram.data(), dramaddr, skip, spmem.data(), memaddr, 0, length, count);
+
+        passed &= sameRange("read", dram_ref.data(), dram.data(), dram_lo, dram_hi, memaddr, dramaddr, length, count, skip);
+
+        // RDRAM to SP memory
+        fillRange(dram.data(), dram_lo, dram_hi, seed);
+        fillRange(spmem.data(), sp_lo, sp_hi, ~seed);
+        fillRange(spmem_ref.data(), sp_lo, sp_hi, ~seed);
+
+        byteDMAWrite(spmem_ref.data(), memaddr, dram.data(), dramaddr, length, count, skip);
+        dmaCopyRows(spmem.data(), memaddr, 0, dram.data(), dramaddr, skip, length, count);
+
+        passed &= sameRange("write", spmem_ref.data(), spmem.data(), sp_lo, sp_hi, memaddr, dramaddr, length, count, skip);
+    }
+
+    return passed;
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+// SP DMA row copies against the byte loop
+bool testSPDMA(void);
@@ -0,0 +1,85 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "headlesstest.h"
+
+
+#define ROM_SIZE 0x1000
+#define ROM_PATH "headless-dpc.z64"
+
+
+// boot code run from SP DMEM, in the order it is written to the ROM
+static const uint32_t dpc_boot[] = {
+    0x3C08A410,     // lui   t0, 0xa410
+    0xAD000004,     // sw    zero, 4(t0)     DPC_END_REG
+    0x1000FFFF,     // b     .
+    0x00000000,     // nop
+};
+
+static void putWord(std::vector<uint8_t>& rom, uint32_t offset, uint32_t value)
+{
+    rom[offset + 0] = (uint8_t)(value >> 24);
+    rom[offset + 1] = (uint8_t)(value >> 16);
+    rom[offset + 2] = (uint8_t)(value >> 8);
+    rom[offset + 3] = (uint8_t)value;
+}
+
+static bool writeRom(const char* path)
+{
+    std::vector<uint8_t> rom(ROM_SIZE, 0);
+
+    // big endian .z64 header, NTSC
+    putWord(rom, 0x00, 0x80371240);
+    putWord(rom, 0x08, 0x80000400);
+    rom[0x3E] = 'E';
+
+    for (uint32_t i = 0; i < sizeof(dpc_boot) / sizeof(dpc_boot[0]); i++)
+    {
+        putWord(rom, 0x40 + i * 4, dpc_boot[i]);
+    }
+
+    FILE* file = fopen(path, "wb");
+
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    bool written = (fwrite(rom.data(), 1, rom.size(), file) == rom.size());
+    return (fclose(file) == 0) && written;
+}
+
+bool testHeadlessDPC(void)
+{
+    const char* headless = getenv("OP64_HEADLESS");
+
+    if (headless == nullptr)
+    {
+        printf("headless: OP64_HEADLESS is not set\n");
+        return false;
+    }
+
+    if (!writeRom(ROM_PATH))
+    {
+        printf("headless: could not write %s\n", ROM_PATH);
+        return false;
+    }
+
+    // the null graphics plugin must take the display list, and the
+    // runner only succeeds once it has seen every VI
+    std::string command = std::string("\"") + headless + "\" " + ROM_PATH + " 2";
+    int status = system(command.c_str());
+
+    remove(ROM_PATH);
+
+    if (status != 0)
+    {
+        printf("headless: %s returned %d\n", command.c_str(), status);
+        return false;
+    }
+
+    return true;
+}
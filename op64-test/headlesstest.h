@@ -0,0 +1,4 @@
+#pragma once
+
+// op64-headless runs boot code that starts an RDP display list
+bool testHeadlessDPC(void);
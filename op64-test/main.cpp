@@ -0,0 +1,50 @@
+/* Checks core helpers against the plain loops they replaced, and
+ * runs small machines through op64-headless. Runs every test, or only the ones named on the command line */
+
+#include <cstdio>
+#include <cstring>
+
+#include "dmatest.h"
+#include "headlesstest.h"
+
+
+struct Test
+{
+    const char* name;
+    bool(*run)(void);
+};
+
+static const Test tests[] = {
+    { "spdma", &testSPDMA },
+    { "headless", &testHeadlessDPC },
+};
+
+int main(int argc, char* argv[])
+{
+    int failed = 0;
+
+    for (const Test& test : tests)
+    {
+        bool selected = (argc < 2);
+
+        for (int i = 1; i < argc; i++)
+        {
+            selected |= (strcmp(argv[i], test.name) == 0);
+        }
+
+        if (!selected)
+        {
+            continue;
+        }
+
+        bool passed = test.run();
+        printf("%s: %s\n", test.name, passed ? "passed" : "FAILED");
+
+        if (!passed)
+        {
+            failed++;
+        }
+    }
+
+    return (failed == 0) ? 0 : 1;
+}
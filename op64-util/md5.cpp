@@ -60,7 +60,7 @@ documentation and/or software.
 
 // F, G, H and I are basic MD5 functions.
 inline MD5::uint4 MD5::F(uint4 x, uint4 y, uint4 z) {
-    return (x & y) | (~x & z);
+    return z ^ (x & (y ^ z));
 }
 
 inline MD5::uint4 MD5::G(uint4 x, uint4 y, uint4 z) {
@@ -83,19 +83,20 @@ inline MD5::uint4 MD5::rotate_left(uint4 x, int n) {
 // FF, GG, HH, and II transformations for rounds 1, 2, 3, and 4.
 // Rotation is separate from addition to prevent recomputation.
 inline void MD5::FF(uint4 &a, uint4 b, uint4 c, uint4 d, uint4 x, uint4 s, uint4 ac) {
-    a = rotate_left(a + F(b, c, d) + x + ac, s) + b;
+    a = rotate_left(a + (x + ac) + F(b, c, d), s) + b;
 }
 
 inline void MD5::GG(uint4 &a, uint4 b, uint4 c, uint4 d, uint4 x, uint4 s, uint4 ac) {
-    a = rotate_left(a + G(b, c, d) + x + ac, s) + b;
+    // the two halves of G share no bits, added one at a time b is needed last
+    a = rotate_left(a + (x + ac) + (c & ~d) + (b & d), s) + b;
 }
 
 inline void MD5::HH(uint4 &a, uint4 b, uint4 c, uint4 d, uint4 x, uint4 s, uint4 ac) {
-    a = rotate_left(a + H(b, c, d) + x + ac, s) + b;
+    a = rotate_left(a + (x + ac) + H(b, c, d), s) + b;
 }
 
 inline void MD5::II(uint4 &a, uint4 b, uint4 c, uint4 d, uint4 x, uint4 s, uint4 ac) {
-    a = rotate_left(a + I(b, c, d) + x + ac, s) + b;
+    a = rotate_left(a + (x + ac) + I(b, c, d), s) + b;
 }
 
 //////////////////////////////////////////////
@@ -137,9 +138,13 @@ void MD5::init()
 // decodes input (unsigned char) into output (uint4). Assumes len is a multiple of 4.
 void MD5::decode(uint4 output[], const uint1 input[], size_type len)
 {
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
     for (unsigned int i = 0, j = 0; j < len; i++, j += 4)
         output[i] = ((uint4)input[j]) | (((uint4)input[j + 1]) << 8) |
         (((uint4)input[j + 2]) << 16) | (((uint4)input[j + 3]) << 24);
+#else
+    memcpy(output, input, len);
+#endif
 }
 
 //////////////////////////////
@@ -240,9 +245,6 @@ void MD5::transform(const uint1 block[blocksize])
     state[1] += b;
     state[2] += c;
     state[3] += d;
-
-    // Zeroize sensitive information.
-    memset(x, 0, sizeof x);
 }
 
 //////////////////////////////
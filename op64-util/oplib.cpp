@@ -1,3 +1,7 @@
+#include <cstring>
+#include <map>
+#include <string>
+
 #include "oplib.h"
 #include "oplog.h"
 
@@ -23,6 +27,30 @@ static std::string MBFromW(LPCWSTR pwsz, UINT cp) {
 }
 #endif
 
+// registered built in libraries, their handle is the address of the map value
+static std::map<std::string, const OPLibSymbol*>& builtinLibs(void)
+{
+    static std::map<std::string, const OPLibSymbol*> libs;
+    return libs;
+}
+
+static const OPLibSymbol* const* findBuiltinLib(LibHandle lib)
+{
+    for (auto& entry : builtinLibs())
+    {
+        if ((LibHandle)&entry.second == lib)
+        {
+            return &entry.second;
+        }
+    }
+
+    return nullptr;
+}
+
+void opRegisterLib(const char* libpath, const OPLibSymbol* symbols)
+{
+    builtinLibs()[libpath] = symbols;
+}
 
 bool opLoadLib(LibHandle* handle, const char* libpath)
 {
@@ -32,6 +60,14 @@ bool opLoadLib(LibHandle* handle, const char* libpath)
         return false;
     }
 
+    auto builtin = builtinLibs().find(libpath);
+
+    if (builtin != builtinLibs().end())
+    {
+        *handle = (LibHandle)&builtin->second;
+        return true;
+    }
+
 #ifdef _MSC_VER
     const size_t size = strlen(libpath) + 1;
     std::wstring path(size, L'#');
@@ -87,6 +123,21 @@ void* opLibGetFunc(LibHandle lib, const char* procname)
 {
     if (procname == nullptr)
         return nullptr;
+
+    const OPLibSymbol* const* builtin = findBuiltinLib(lib);
+
+    if (builtin != nullptr)
+    {
+        for (const OPLibSymbol* symbol = *builtin; symbol->name != nullptr; symbol++)
+        {
+            if (strcmp(symbol->name, procname) == 0)
+            {
+                return symbol->func;
+            }
+        }
+
+        return nullptr;
+    }
 #ifdef _MSC_VER
     return GetProcAddress(lib, procname);
 #else
@@ -105,6 +156,11 @@ void* opLibGetMainHandle(void)
 
 bool opLibClose(LibHandle lib)
 {
+    if (findBuiltinLib(lib) != nullptr)
+    {
+        return true;
+    }
+
 #ifdef _MSC_VER
     int rval = FreeLibrary(lib);
 
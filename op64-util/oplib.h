@@ -9,6 +9,16 @@ typedef HMODULE LibHandle;
 typedef void* LibHandle;
 #endif
 
+// exported function of a library linked into the executable
+struct OPLibSymbol
+{
+    const char* name;
+    void* func;
+};
+
+// makes a built in library loadable by name. symbols ends with a null name
+OP_API void opRegisterLib(const char* libpath, const OPLibSymbol* symbols);
+
 OP_API bool opLoadLib(LibHandle* handle, const char* libpath);
 OP_API void* opLibGetFunc(LibHandle lib, const char* procname);
 OP_API void* opLibGetMainHandle(void);
@@ -7,6 +7,7 @@
 
 #include <core/bus.h>
 #include <rcp/rdramcontroller.h>
+#include <cpu/icpu.h>
 
 
 #define CHEAT_CODE_MAGIC_VALUE 0xDEADBEEF
@@ -22,14 +23,24 @@ static uint8_t read_address_8bit(uint32_t address)
     return *(uint8_t*)(((uint8_t*)Bus::rdram.mem + (BES(address & 0xFFFFFF))));
 }
 
-static void update_address_16bit(uint32_t address, uint16_t new_value)
+static void update_address_16bit(Bus* bus, uint32_t address, uint16_t new_value)
 {
-    *(uint16_t*)(((uint8_t*)Bus::rdram.mem + (HES(address & 0xFFFFFF)))) = new_value;
+    uint16_t* dest = (uint16_t*)(((uint8_t*)Bus::rdram.mem + (HES(address & 0xFFFFFF))));
+    if (*dest != new_value)
+    {
+        *dest = new_value;
+        bus->cpu->invalidateCode(address & 0xFFFFFF, 2);
+    }
 }
 
-static void update_address_8bit(uint32_t address, uint8_t new_value)
+static void update_address_8bit(Bus* bus, uint32_t address, uint8_t new_value)
 {
-    *(uint8_t*)(((uint8_t*)Bus::rdram.mem + (BES(address & 0xFFFFFF)))) = new_value;
+    uint8_t* dest = (uint8_t*)(((uint8_t*)Bus::rdram.mem + (BES(address & 0xFFFFFF))));
+    if (*dest != new_value)
+    {
+        *dest = new_value;
+        bus->cpu->invalidateCode(address & 0xFFFFFF, 1);
+    }
 }
 
 static bool address_equal_to_8bit(uint32_t address, uint8_t value)
@@ -119,7 +130,7 @@ void CheatEngine::addRomHacks(CheatList romhacks)
     _romhacks = romhacks;
 }
 
-void CheatEngine::applyCheats(CheatEntry entry)
+void CheatEngine::applyCheats(Bus* bus, CheatEntry entry)
 {
     // TODO: Fix up for all active cheats. Rom hacks only for now
     for (Cheat cheat : _romhacks)
@@ -131,7 +142,7 @@ void CheatEngine::applyCheats(CheatEntry entry)
             {
                 if ((code.address & 0xF0000000) == 0xF0000000)
                 {
-                    execute_cheat(code.address, code.value, &code.old_value);
+                    execute_cheat(bus, code.address, code.value, &code.old_value);
                 }
             }
             break;
@@ -152,7 +163,7 @@ void CheatEngine::applyCheats(CheatEntry entry)
                         failed = true;
 
                     // if condition false, skip next code non-test code
-                    if (!execute_cheat(code.address, code.value, nullptr))
+                    if (!execute_cheat(bus, code.address, code.value, nullptr))
                         failed = true;
                 }
                 else {
@@ -171,14 +182,14 @@ void CheatEngine::applyCheats(CheatEntry entry)
                     case 0xA8000000:
                     case 0xA9000000:
                         if (_gsButtonPressed)
-                            execute_cheat(code.address, code.value, nullptr);
+                            execute_cheat(bus, code.address, code.value, nullptr);
                         break;
                         // normal cheat code
                     default:
                         // exclude boot-time cheat codes
                         if ((code.address & 0xF0000000) != 0xF0000000)
                         {
-                            execute_cheat(code.address, code.value, &code.old_value);
+                            execute_cheat(bus, code.address, code.value, &code.old_value);
                         }
                         break;
                     }
@@ -192,7 +203,7 @@ void CheatEngine::applyCheats(CheatEntry entry)
     }
 }
 
-bool CheatEngine::execute_cheat(uint32_t address, uint16_t value, int32_t* old_value)
+bool CheatEngine::execute_cheat(Bus* bus, uint32_t address, uint16_t value, int32_t* old_value)
 {
     switch (address & 0xFF000000)
     {
@@ -206,7 +217,7 @@ bool CheatEngine::execute_cheat(uint32_t address, uint16_t value, int32_t* old_v
         {
             *old_value = (int32_t)read_address_8bit(address);
         }
-        update_address_8bit(address, (uint8_t)value);
+        update_address_8bit(bus, address, (uint8_t)value);
         return true;
     case 0x81000000:
     case 0x89000000:
@@ -218,7 +229,7 @@ bool CheatEngine::execute_cheat(uint32_t address, uint16_t value, int32_t* old_v
         {
             *old_value = (int32_t)read_address_16bit(address);
         }
-        update_address_16bit(address, value);
+        update_address_16bit(bus, address, value);
         return true;
     case 0xD0000000:
     case 0xD8000000:
@@ -234,8 +245,8 @@ bool CheatEngine::execute_cheat(uint32_t address, uint16_t value, int32_t* old_v
         return !(address_equal_to_16bit(address, value));
     case 0xEE000000:
         // most likely, this doesnt do anything.
-        execute_cheat(0xF1000318, 0x0040, nullptr);
-        execute_cheat(0xF100031A, 0x0000, nullptr);
+        execute_cheat(bus, 0xF1000318, 0x0040, nullptr);
+        execute_cheat(bus, 0xF100031A, 0x0000, nullptr);
         return true;
     default:
         return true;
@@ -2,6 +2,8 @@
 
 #include "cheat.h"
 
+class Bus;
+
 enum CheatEntry
 {
     ENTRY_BOOT = 0,
@@ -14,12 +16,12 @@ public:
     static CheatCodeList toCheatCodeList(const std::string& strcodelist);
 
     void addRomHacks(CheatList romhacks);
-    void applyCheats(CheatEntry entry);
+    void applyCheats(Bus* bus, CheatEntry entry);
 
 private:
     static CheatCodeList processCodeList(CheatCodeList& rawlist);
 
-    bool execute_cheat(uint32_t address, uint16_t value, int32_t* old_value);
+    bool execute_cheat(Bus* bus, uint32_t address, uint16_t value, int32_t* old_value);
 
 private:
     CheatList _romhacks;
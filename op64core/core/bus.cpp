@@ -2,9 +2,11 @@
 
 #include "bus.h"
 
+#include <globalstrings.h>
 #include <mem/imemory.h>
 #include <cpu/icpu.h>
 #include <plugin/plugincontainer.h>
+#include <ui/configstore.h>
 
 
 RCP Bus::rcp;
@@ -60,6 +62,10 @@ bool Bus::initializeDevices(void)
         systimer.reset(new SysTiming(rom->getViLimit()));
         cheat.reset(new CheatEngine);
 
+        ConfigStore& config = ConfigStore::getInstance();
+        rewind.reset(new Rewind(config.getInt(GlobalStrings::CFG_SECTION_CORE, GlobalStrings::CFG_REWIND_INTERVAL),
+            (size_t)config.getInt(GlobalStrings::CFG_SECTION_CORE, GlobalStrings::CFG_REWIND_BUFFER) << 20));
+
         LOG_INFO(Bus) << "Devices successfully initialized";
         _state = BUS_DEV_INITIALIZED;
 
@@ -88,6 +94,8 @@ void Bus::executeMachine(void)
 
     cpu->execute();
 
+    Bus::rcp.sp.syncTask(this);
+
     LOG_INFO(Bus) << "Stopping emulator...";
 
     plugins->RomClosed();
@@ -130,4 +138,5 @@ void Bus::freeEverything(void)
     pif.reset();
     sram.reset();
     flashram.reset();
+    rewind.reset();
 }
@@ -5,6 +5,7 @@
 
 #include <op64.h>
 
+#include <core/rewind.h>
 #include <core/state.h>
 #include <cpu/interrupthandler.h>
 #include <rom/rom.h>
@@ -59,6 +60,7 @@ public:
     std::unique_ptr<PIF> pif;
     std::unique_ptr<SRAM> sram;
     std::unique_ptr<FlashRam> flashram;
+    std::unique_ptr<Rewind> rewind;
 
     // RCP/RAM/State needs to be persistent :(
     static RCP rcp;
@@ -0,0 +1,327 @@
+#include <oplog.h>
+
+#include "rewind.h"
+#include "savestate.h"
+
+#include <core/bus.h>
+#include <cpu/icpu.h>
+#include <ui/corecontrol.h>
+
+
+#define REWIND_PAGE_SHIFT 12
+#define REWIND_PAGE_SIZE (1 << REWIND_PAGE_SHIFT)
+#define REWIND_PAGE_COUNT (RDRAM_SIZE >> REWIND_PAGE_SHIFT)
+
+
+static inline size_t alignWords(size_t size)
+{
+    return (size + 7) & ~(size_t)7;
+}
+
+// appends old ^ cur as runs of [words skipped][word count][xor words]
+// behind a byte length and brings old up to date, returns false and
+// appends nothing if both match
+static bool encodeDelta(StateWriter& out, uint64_t* old, const uint64_t* cur, uint32_t words)
+{
+    uint64_t run[REWIND_PAGE_SIZE / 8];
+    size_t start = out.data().size();
+    uint32_t length = 0;
+    uint32_t last = 0;
+    uint32_t i = 0;
+
+    out.put(length);
+
+    while (i < words)
+    {
+        if (old[i] == cur[i])
+        {
+            i++;
+            continue;
+        }
+
+        uint32_t first = i;
+        uint32_t count = 0;
+
+        while (i < words && old[i] != cur[i] && count < (REWIND_PAGE_SIZE / 8))
+        {
+            run[count++] = old[i] ^ cur[i];
+            old[i] = cur[i];
+            i++;
+        }
+
+        out.put(first - last);
+        out.put(count);
+        out.putBytes(run, count * 8);
+        last = i;
+    }
+
+    length = (uint32_t)(out.data().size() - start - sizeof(length));
+
+    if (length == 0)
+    {
+        out.data().resize(start);
+        return false;
+    }
+
+    memcpy(out.data().data() + start, &length, sizeof(length));
+    return true;
+}
+
+static bool decodeDelta(StateReader& in, uint64_t* target, uint32_t words)
+{
+    uint32_t length = in.get<uint32_t>();
+    const uint8_t* delta = in.getPointer(length);
+
+    if (nullptr == delta)
+        return false;
+
+    const uint8_t* end = delta + length;
+    uint32_t word = 0;
+
+    while (delta + 8 <= end)
+    {
+        uint32_t skip, count;
+        memcpy(&skip, delta, 4);
+        memcpy(&count, delta + 4, 4);
+        delta += 8;
+
+        word += skip;
+
+        if (word + count > words || delta + count * 8 > end)
+            return false;
+
+        for (uint32_t i = 0; i < count; i++, delta += 8)
+        {
+            uint64_t x;
+            memcpy(&x, delta, 8);
+            target[word++] ^= x;
+        }
+    }
+
+    return delta == end;
+}
+
+
+Rewind::Rewind(uint32_t interval, size_t budget) :
+    _interval(interval),
+    _budget(budget),
+    _request(0)
+{
+}
+
+void Rewind::requestRewind(uint32_t snapshots)
+{
+    _request.store(snapshots);
+}
+
+void Rewind::process(Bus* bus)
+{
+    uint32_t snapshots = _request.exchange(0);
+
+    if (snapshots != 0)
+    {
+        rewind(bus, snapshots);
+    }
+}
+
+void Rewind::vi(Bus* bus)
+{
+    if (!enabled())
+        return;
+
+    if (_valid)
+    {
+        comparePages(bus);
+    }
+
+    if (++_frames >= _interval)
+    {
+        _frames = 0;
+        capture(bus);
+    }
+}
+
+void Rewind::capture(Bus* bus)
+{
+    StateWriter block(_state.size() + 64);
+    SaveState::writeMachine(bus, block, false);
+
+    uint32_t size = (uint32_t)block.data().size();
+    block.data().resize(alignWords(size), 0);
+
+    const uint8_t* rdram = (const uint8_t*)Bus::rdram.mem;
+
+    if (!_valid)
+    {
+        _rdram.assign(rdram, rdram + RDRAM_SIZE);
+        _state.swap(block.data());
+        _state_size = size;
+        _valid = true;
+
+        bus->cpu->clearDirtyPages();
+        return;
+    }
+
+    StateWriter delta(0x10000);
+
+    // the rest of the machine, raw when the layout changed (a save chip was opened)
+    delta.put(_state_size);
+
+    if (_state.size() == block.data().size())
+    {
+        delta.put((uint8_t)1);
+
+        if (!encodeDelta(delta, (uint64_t*)_state.data(), (const uint64_t*)block.data().data(), (uint32_t)(_state.size() / 8)))
+        {
+            delta.put((uint32_t)0);
+        }
+    }
+    else
+    {
+        delta.put((uint8_t)0);
+        delta.put((uint32_t)_state.size());
+        delta.putBytes(_state.data(), _state.size());
+    }
+
+    // RDRAM pages, the core and comparePages mark what changed
+    const bool* dirty = bus->cpu->getDirtyPages();
+    uint32_t pages = 0;
+    size_t count_offset = delta.data().size();
+
+    delta.put(pages);
+
+    for (uint32_t page = 0; page < REWIND_PAGE_COUNT; page++)
+    {
+        if (!dirty[page])
+            continue;
+
+        uint8_t* old = _rdram.data() + (page << REWIND_PAGE_SHIFT);
+        const uint8_t* cur = rdram + (page << REWIND_PAGE_SHIFT);
+
+        delta.put(page);
+
+        if (encodeDelta(delta, (uint64_t*)old, (const uint64_t*)cur, REWIND_PAGE_SIZE / 8))
+        {
+            pages++;
+        }
+        else
+        {
+            delta.data().resize(delta.data().size() - sizeof(page));
+        }
+    }
+
+    memcpy(delta.data().data() + count_offset, &pages, sizeof(pages));
+
+    _state.swap(block.data());
+    _state_size = size;
+
+    delta.data().shrink_to_fit();
+    _used += delta.data().size();
+    _deltas.push_back(std::move(delta.data()));
+
+    while (_used > _budget && !_deltas.empty())
+    {
+        _used -= _deltas.front().size();
+        _deltas.pop_front();
+    }
+
+    bus->cpu->clearDirtyPages();
+}
+
+bool Rewind::rewind(Bus* bus, uint32_t snapshots)
+{
+    if (!_valid || snapshots == 0)
+        return false;
+
+    // a snapshot from moments ago counts as the present, so repeated
+    // requests keep going back instead of landing on it again
+    if (_frames < _interval / 2 && !_deltas.empty())
+    {
+        snapshots++;
+    }
+
+    for (uint32_t i = 1; i < snapshots && !_deltas.empty(); i++)
+    {
+        applyDelta(_deltas.back());
+
+        _used -= _deltas.back().size();
+        _deltas.pop_back();
+    }
+
+    // also drops whatever was written after the newest snapshot
+    memcpy(Bus::rdram.mem, _rdram.data(), RDRAM_SIZE);
+
+    StateReader reader(_state.data(), _state_size);
+    bool ok = SaveState::readMachine(bus, reader, false) && reader.ok();
+
+    bus->cpu->clearDirtyPages();
+    _frames = 0;
+
+    if (!ok)
+    {
+        LOG_ERROR(Rewind) << "Rewind snapshot is inconsistent, stopping";
+        CoreControl::stop = true;
+    }
+
+    return ok;
+}
+
+// plugins write RDRAM directly (LLE RSP tasks, frame buffers). The pages
+// are compared a slice per VI so each is seen once an interval without
+// a snapshot having to compare all of them
+void Rewind::comparePages(Bus* bus)
+{
+    // a task still on the RSP thread is finished first
+    Bus::rcp.sp.syncTask(bus);
+
+    const uint8_t* rdram = (const uint8_t*)Bus::rdram.mem;
+    const bool* dirty = bus->cpu->getDirtyPages();
+    uint32_t count = (REWIND_PAGE_COUNT + _interval - 1) / _interval;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t page = _compare_page;
+        _compare_page = (_compare_page + 1) % REWIND_PAGE_COUNT;
+
+        if (dirty[page])
+            continue;
+
+        size_t offset = (size_t)page << REWIND_PAGE_SHIFT;
+
+        if (memcmp(_rdram.data() + offset, rdram + offset, REWIND_PAGE_SIZE))
+        {
+            bus->cpu->markDirtyPage(page);
+        }
+    }
+}
+
+void Rewind::applyDelta(const std::vector<uint8_t>& delta)
+{
+    StateReader reader(delta.data(), delta.size());
+
+    uint32_t size = reader.get<uint32_t>();
+
+    if (reader.get<uint8_t>())
+    {
+        decodeDelta(reader, (uint64_t*)_state.data(), (uint32_t)(_state.size() / 8));
+    }
+    else
+    {
+        _state.resize(reader.get<uint32_t>());
+        reader.getBytes(_state.data(), _state.size());
+    }
+
+    _state_size = size;
+
+    uint32_t pages = reader.get<uint32_t>();
+
+    for (uint32_t i = 0; i < pages && reader.ok(); i++)
+    {
+        uint32_t page = reader.get<uint32_t>();
+
+        if (page < REWIND_PAGE_COUNT)
+        {
+            decodeDelta(reader, (uint64_t*)(_rdram.data() + (page << REWIND_PAGE_SHIFT)), REWIND_PAGE_SIZE / 8);
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+class Bus;
+
+
+/************************************************************************/
+/* Snapshots taken every few VIs so the machine can be stepped back.    */
+/* RDRAM and the rest of the machine are kept as one copy of the newest */
+/* snapshot, each older one as the XOR delta of the blocks and 4KB      */
+/* RDRAM pages that changed on the way to the next snapshot. Plugins    */
+/* write RDRAM behind the core, so every VI compares a slice of it, a   */
+/* page changed after its slice was compared is in the next snapshot.   */
+/************************************************************************/
+class Rewind
+{
+public:
+    // interval is in VIs, 0 disables snapshots. budget bounds the
+    // deltas, the newest snapshot needs about RDRAM_SIZE on top of it
+    Rewind(uint32_t interval, size_t budget);
+
+    inline bool enabled(void) const
+    {
+        return _interval != 0;
+    }
+
+    // steps back at the next interrupt, 1 returns to the newest snapshot
+    // unless it was taken less than half an interval ago
+    void requestRewind(uint32_t snapshots);
+
+    inline bool pending(void) const
+    {
+        return _request.load(std::memory_order_relaxed) != 0;
+    }
+
+    // emulation thread only, the machine must be between instructions
+    void process(Bus* bus);
+    void vi(Bus* bus);
+
+    void capture(Bus* bus);
+    bool rewind(Bus* bus, uint32_t snapshots);
+
+    inline uint32_t snapshots(void) const
+    {
+        return _valid ? (uint32_t)_deltas.size() + 1 : 0;
+    }
+
+    inline size_t memoryUsed(void) const
+    {
+        return _used;
+    }
+
+private:
+    void comparePages(Bus* bus);
+    void applyDelta(const std::vector<uint8_t>& delta);
+
+private:
+    uint32_t _interval;
+    size_t _budget;
+    uint32_t _frames = 0;
+
+    std::atomic<uint32_t> _request;
+
+    // newest snapshot, the state block is padded to whole words
+    bool _valid = false;
+    std::vector<uint8_t> _rdram;
+    std::vector<uint8_t> _state;
+    uint32_t _state_size = 0;
+
+    // next RDRAM page comparePages looks at
+    uint32_t _compare_page = 0;
+
+    // oldest first, each one undoes the step to the snapshot after it
+    std::deque<std::vector<uint8_t>> _deltas;
+    size_t _used = 0;
+};
@@ -0,0 +1,356 @@
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <oplog.h>
+
+#include "savestate.h"
+
+#include <core/bus.h>
+#include <cpu/icpu.h>
+#include <cpu/interrupthandler.h>
+#include <plugin/audioplugin.h>
+#include <plugin/gfxplugin.h>
+#include <plugin/plugincontainer.h>
+#include <rom/rom.h>
+#include <ui/corecontrol.h>
+
+
+static const char SAVESTATE_MAGIC[8] = { 'O', 'P', '6', '4', 'S', 'T', 'A', 'T' };
+
+struct StateHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t crc1;
+    uint32_t crc2;
+    uint32_t reserved;
+    uint64_t size;
+    uint64_t hash;
+};
+
+std::atomic<uint32_t> SaveState::_pending(0);
+std::mutex SaveState::_lock;
+std::string SaveState::_save_path;
+std::string SaveState::_load_path;
+bool SaveState::_stop_after_save = false;
+std::atomic<bool> SaveState::_save_failed(false);
+
+
+// FNV-1a, catches truncated or corrupted files before anything is touched
+static uint64_t hashBody(const uint8_t* data, size_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ data[i]) * 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+void SaveState::requestSave(const std::string& path, bool stop_after)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    _save_path = path;
+    _stop_after_save = stop_after;
+    _pending |= PENDING_SAVE;
+}
+
+void SaveState::requestLoad(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+
+    _load_path = path;
+    _pending |= PENDING_LOAD;
+}
+
+void SaveState::process(Bus* bus)
+{
+    std::string save_path, load_path;
+    bool stop_after_save;
+
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+
+        uint32_t pending = _pending.exchange(0);
+        save_path = (pending & PENDING_SAVE) ? _save_path : std::string();
+        load_path = (pending & PENDING_LOAD) ? _load_path : std::string();
+        stop_after_save = _stop_after_save;
+    }
+
+    // a save queued together with a load captures the state before the load
+    if (!save_path.empty())
+    {
+        // a failed save is logged by save and the game keeps running
+        _save_failed = !save(bus, save_path);
+
+        if (stop_after_save)
+        {
+            CoreControl::stop = true;
+        }
+    }
+
+    if (!load_path.empty())
+    {
+        load(bus, load_path);
+    }
+}
+
+bool SaveState::save(Bus* bus, const std::string& path)
+{
+    // the header goes in front of the body once the body is known, its
+    // room is taken first so the body is never moved
+    StateHeader header;
+    StateWriter state(sizeof(header) + RDRAM_SIZE + 0x80000);
+    state.data().resize(sizeof(header));
+    writeMachine(bus, state);
+
+    std::vector<uint8_t>& data = state.data();
+    const uint8_t* body = data.data() + sizeof(header);
+    size_t size = data.size() - sizeof(header);
+
+    memcpy(header.magic, SAVESTATE_MAGIC, sizeof(header.magic));
+    header.version = SAVESTATE_VERSION;
+    header.crc1 = bus->rom->getHeader()->CRC1;
+    header.crc2 = bus->rom->getHeader()->CRC2;
+    header.reserved = 0;
+    header.size = size;
+    header.hash = hashBody(body, size);
+
+    memcpy(data.data(), &header, sizeof(header));
+
+    // one contiguous write to a temporary file, so a failed save never
+    // leaves a half written state behind
+    boost::filesystem::path statepath(path);
+    boost::filesystem::path temppath(path + ".tmp");
+
+    boost::system::error_code ec;
+
+    if (statepath.has_parent_path() && !boost::filesystem::exists(statepath.parent_path(), ec))
+    {
+        boost::filesystem::create_directories(statepath.parent_path(), ec);
+    }
+
+    {
+        boost::filesystem::ofstream file(temppath, std::ios::out | std::ios::binary | std::ios::trunc);
+        file.write((const char*)data.data(), data.size());
+
+        if (!file.good())
+        {
+            LOG_ERROR(SaveState) << "Could not write save state " << temppath.string();
+            file.close();
+            boost::filesystem::remove(temppath, ec);
+            return false;
+        }
+    }
+
+    boost::filesystem::rename(temppath, statepath, ec);
+
+    if (ec)
+    {
+        LOG_ERROR(SaveState) << "Could not write save state " << statepath.string() << ": " << ec.message();
+        boost::filesystem::remove(temppath, ec);
+        return false;
+    }
+
+    LOG_INFO(SaveState) << "Saved state " << statepath.string();
+
+    return true;
+}
+
+bool SaveState::load(Bus* bus, const std::string& path)
+{
+    std::vector<uint8_t> data;
+
+    {
+        boost::filesystem::ifstream file(path, std::ios::in | std::ios::binary | std::ios::ate);
+
+        if (!file.is_open())
+        {
+            LOG_ERROR(SaveState) << "Could not open save state " << path;
+            return false;
+        }
+
+        data.resize((size_t)file.tellg());
+        file.seekg(0, std::ios::beg);
+        file.read((char*)data.data(), data.size());
+
+        if (!file.good())
+        {
+            LOG_ERROR(SaveState) << "Could not read save state " << path;
+            return false;
+        }
+    }
+
+    StateHeader header;
+
+    if (data.size() < sizeof(header))
+    {
+        LOG_ERROR(SaveState) << path << " is not a save state";
+        return false;
+    }
+
+    memcpy(&header, data.data(), sizeof(header));
+
+    if (memcmp(header.magic, SAVESTATE_MAGIC, sizeof(header.magic)))
+    {
+        LOG_ERROR(SaveState) << path << " is not a save state";
+        return false;
+    }
+
+    if (header.version != SAVESTATE_VERSION)
+    {
+        LOG_ERROR(SaveState) << path << " has version " << header.version << ", expected " << SAVESTATE_VERSION;
+        return false;
+    }
+
+    if (header.crc1 != bus->rom->getHeader()->CRC1 || header.crc2 != bus->rom->getHeader()->CRC2)
+    {
+        LOG_ERROR(SaveState) << path << " was saved with a different ROM";
+        return false;
+    }
+
+    const uint8_t* body = data.data() + sizeof(header);
+    size_t size = data.size() - sizeof(header);
+
+    if (header.size != size || header.hash != hashBody(body, size))
+    {
+        LOG_ERROR(SaveState) << path << " is truncated or corrupted";
+        return false;
+    }
+
+    StateReader reader(body, size);
+
+    if (!readMachine(bus, reader) || !reader.ok() || reader.remaining() != 0)
+    {
+        // the file checked out but its contents did not, the machine is undefined now
+        LOG_ERROR(SaveState) << path << " does not match this build, stopping";
+        CoreControl::stop = true;
+        return false;
+    }
+
+    LOG_INFO(SaveState) << "Loaded state " << path;
+
+    return true;
+}
+
+void SaveState::writeMachine(Bus* bus, StateWriter& state, bool rdram)
+{
+    // a task still on the RSP thread is finished first
+    Bus::rcp.sp.syncTask(bus);
+
+    // program state, the controllers belong to the input plugin
+    state.put((uint32_t)Bus::state.PC);
+    state.put(Bus::state.last_jump_addr);
+    state.put(Bus::state.next_interrupt);
+    state.put(Bus::state.skip_jump);
+    state.put(Bus::state.cycles);
+    state.put(Bus::state.count_base);
+    state.put(Bus::state.next_vi);
+    state.put(Bus::state.vi_delay);
+    state.put(Bus::state.vi_field);
+    state.putBytes(Bus::state.cp0_reg, sizeof(Bus::state.cp0_reg));
+    state.put(bus->rom->getSaveType());
+
+    bus->cpu->saveState(state);
+    bus->interrupt->saveState(state);
+
+    // RCP
+    state.putBytes(Bus::rcp.ai.reg, sizeof(Bus::rcp.ai.reg));
+    state.putBytes(Bus::rcp.ai.fifo, sizeof(Bus::rcp.ai.fifo));
+    state.putBytes(Bus::rcp.dpc.reg, sizeof(Bus::rcp.dpc.reg));
+    state.putBytes(Bus::rcp.dps.reg, sizeof(Bus::rcp.dps.reg));
+    state.putBytes(Bus::rcp.mi.reg, sizeof(Bus::rcp.mi.reg));
+    state.putBytes(Bus::rcp.pi.reg, sizeof(Bus::rcp.pi.reg));
+    state.putBytes(Bus::rcp.ri.reg, sizeof(Bus::rcp.ri.reg));
+    state.putBytes(Bus::rcp.si.reg, sizeof(Bus::rcp.si.reg));
+    state.putBytes(Bus::rcp.sp.reg, sizeof(Bus::rcp.sp.reg));
+    state.putBytes(Bus::rcp.sp.mem, sizeof(Bus::rcp.sp.mem));
+    state.putBytes(Bus::rcp.sp.stat, sizeof(Bus::rcp.sp.stat));
+    state.putBytes(Bus::rcp.vi.reg, sizeof(Bus::rcp.vi.reg));
+
+    // RDRAM
+    state.putBytes(Bus::rdram.reg, sizeof(Bus::rdram.reg));
+
+    if (rdram)
+    {
+        state.putBytes(Bus::rdram.mem, RDRAM_SIZE);
+    }
+
+    // PIF and save chips
+    bus->pif->saveState(state);
+    bus->sram->saveState(state);
+    bus->flashram->saveState(state);
+}
+
+bool SaveState::readMachine(Bus* bus, StateReader& state, bool rdram)
+{
+    Bus::rcp.sp.syncTask(bus);
+
+    Bus::state.PC = state.get<uint32_t>();
+    state.get(Bus::state.last_jump_addr);
+    state.get(Bus::state.next_interrupt);
+    state.get(Bus::state.skip_jump);
+    state.get(Bus::state.cycles);
+    state.get(Bus::state.count_base);
+    state.get(Bus::state.next_vi);
+    state.get(Bus::state.vi_delay);
+    state.get(Bus::state.vi_field);
+    state.getBytes(Bus::state.cp0_reg, sizeof(Bus::state.cp0_reg));
+    bus->rom->setSaveType((SaveType)state.get<uint8_t>());
+
+    // states are only taken at interrupt points, never in the middle of an instruction
+    Bus::state.interrupt_unsafe_state = false;
+
+    // drops cached code, so it has to come before RDRAM
+    bus->cpu->loadState(state);
+    bus->interrupt->loadState(state);
+
+    state.getBytes(Bus::rcp.ai.reg, sizeof(Bus::rcp.ai.reg));
+    state.getBytes(Bus::rcp.ai.fifo, sizeof(Bus::rcp.ai.fifo));
+    state.getBytes(Bus::rcp.dpc.reg, sizeof(Bus::rcp.dpc.reg));
+    state.getBytes(Bus::rcp.dps.reg, sizeof(Bus::rcp.dps.reg));
+    state.getBytes(Bus::rcp.mi.reg, sizeof(Bus::rcp.mi.reg));
+    state.getBytes(Bus::rcp.pi.reg, sizeof(Bus::rcp.pi.reg));
+    state.getBytes(Bus::rcp.ri.reg, sizeof(Bus::rcp.ri.reg));
+    state.getBytes(Bus::rcp.si.reg, sizeof(Bus::rcp.si.reg));
+    state.getBytes(Bus::rcp.sp.reg, sizeof(Bus::rcp.sp.reg));
+    state.getBytes(Bus::rcp.sp.mem, sizeof(Bus::rcp.sp.mem));
+    state.getBytes(Bus::rcp.sp.stat, sizeof(Bus::rcp.sp.stat));
+    Bus::rcp.sp.dma_done = 0;
+    state.getBytes(Bus::rcp.vi.reg, sizeof(Bus::rcp.vi.reg));
+
+    state.getBytes(Bus::rdram.reg, sizeof(Bus::rdram.reg));
+
+    if (rdram)
+    {
+        state.getBytes(Bus::rdram.mem, RDRAM_SIZE);
+    }
+
+    bus->pif->loadState(bus, state);
+    bus->sram->loadState(bus, state);
+    bus->flashram->loadState(bus, state);
+
+    if (!state.ok())
+    {
+        return false;
+    }
+
+    // plugins only see register changes through these
+    if (bus->plugins->gfx()->ViStatusChanged != nullptr)
+    {
+        bus->plugins->gfx()->ViStatusChanged();
+    }
+
+    if (bus->plugins->gfx()->ViWidthChanged != nullptr)
+    {
+        bus->plugins->gfx()->ViWidthChanged();
+    }
+
+    bus->plugins->audio()->DacrateChanged(bus->rom->getSystemType());
+    bus->cpu->invalidateHostRounding();
+
+    return true;
+}
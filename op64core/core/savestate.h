@@ -0,0 +1,165 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// bump when the layout written by SaveState changes, older states are rejected
+#define SAVESTATE_VERSION 2
+
+class Bus;
+
+
+/************************************************************************/
+/* Buffer the machine state is serialized into, in host byte order      */
+/************************************************************************/
+class StateWriter
+{
+public:
+    explicit StateWriter(size_t reserve)
+    {
+        _data.reserve(reserve);
+    }
+
+    void putBytes(const void* src, size_t size)
+    {
+        const uint8_t* bytes = (const uint8_t*)src;
+        _data.insert(_data.end(), bytes, bytes + size);
+    }
+
+    template <typename T>
+    void put(const T& value)
+    {
+        putBytes(&value, sizeof(T));
+    }
+
+    std::vector<uint8_t>& data(void)
+    {
+        return _data;
+    }
+
+private:
+    std::vector<uint8_t> _data;
+};
+
+class StateReader
+{
+public:
+    StateReader(const uint8_t* data, size_t size) :
+        _pos(data),
+        _end(data + size)
+    {
+    }
+
+    // reading past the end zero fills and marks the reader failed
+    void getBytes(void* dest, size_t size)
+    {
+        if (!_ok || (size_t)(_end - _pos) < size)
+        {
+            _ok = false;
+            memset(dest, 0, size);
+            return;
+        }
+
+        memcpy(dest, _pos, size);
+        _pos += size;
+    }
+
+    // the next size bytes in place, nullptr past the end
+    const uint8_t* getPointer(size_t size)
+    {
+        if (!_ok || (size_t)(_end - _pos) < size)
+        {
+            _ok = false;
+            return nullptr;
+        }
+
+        const uint8_t* data = _pos;
+        _pos += size;
+        return data;
+    }
+
+    template <typename T>
+    void get(T& value)
+    {
+        getBytes(&value, sizeof(T));
+    }
+
+    template <typename T>
+    T get(void)
+    {
+        T value;
+        getBytes(&value, sizeof(T));
+        return value;
+    }
+
+    bool ok(void) const
+    {
+        return _ok;
+    }
+
+    size_t remaining(void) const
+    {
+        return _end - _pos;
+    }
+
+private:
+    const uint8_t* _pos;
+    const uint8_t* _end;
+    bool _ok = true;
+};
+
+
+/************************************************************************/
+/* Save states of the whole machine                                     */
+/************************************************************************/
+class SaveState
+{
+public:
+    // queued and run by the emulation thread at the next interrupt,
+    // stop_after stops the core once the state is written
+    static void requestSave(const std::string& path, bool stop_after = false);
+    static void requestLoad(const std::string& path);
+
+    static inline bool pending(void)
+    {
+        return _pending.load(std::memory_order_relaxed) != 0;
+    }
+
+    // whether the last save run by process could not be written
+    static inline bool saveFailed(void)
+    {
+        return _save_failed.load(std::memory_order_relaxed);
+    }
+
+    // runs queued requests, the machine must be between instructions
+    static void process(Bus* bus);
+
+    static bool save(Bus* bus, const std::string& path);
+    static bool load(Bus* bus, const std::string& path);
+
+private:
+    friend class Rewind;
+
+    // Rewind keeps RDRAM itself and leaves it out
+    static void writeMachine(Bus* bus, StateWriter& state, bool rdram = true);
+    static bool readMachine(Bus* bus, StateReader& state, bool rdram = true);
+
+private:
+    enum : uint32_t
+    {
+        PENDING_SAVE = 1,
+        PENDING_LOAD = 2
+    };
+
+    static std::atomic<uint32_t> _pending;
+    static std::mutex _lock;
+    static std::string _save_path;
+    static std::string _load_path;
+    static bool _stop_after_save;
+    static std::atomic<bool> _save_failed;
+};
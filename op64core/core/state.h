@@ -8,11 +8,15 @@ struct ProgramState
     // cpu state
     ProgramCounter PC = 0;
     uint32_t last_jump_addr;
-    uint32_t next_interrupt;
+    uint64_t next_interrupt;
     uint32_t skip_jump;
 
+    // cycles since reset, never wraps. COUNT is derived from it
+    uint64_t cycles;
+    uint32_t count_base;
+
     // vi state
-    uint32_t next_vi;
+    uint64_t next_vi;
     uint32_t vi_delay;
     uint32_t vi_field;
 
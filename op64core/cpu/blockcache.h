@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <cstdint>
+
+#include <cpu/cputypes.h>
+#include <rcp/rdramcontroller.h>
+
+/************************************************************************/
+/* Block storage for caching cores, indexed by physical RDRAM address   */
+/************************************************************************/
+
+template <typename T>
+class BlockCache
+{
+    enum : uint32_t
+    {
+        PAGE_SHIFT = 12,
+        PAGE_COUNT = RDRAM_SIZE >> PAGE_SHIFT,
+        PAGE_BLOCKS = (1 << PAGE_SHIFT) / 4
+    };
+
+    typedef std::array<std::unique_ptr<T>, PAGE_BLOCKS> BlockPage;
+
+public:
+    inline T* find(uint32_t address)
+    {
+        BlockPage* page = _pages[address >> PAGE_SHIFT].get();
+
+        if (nullptr == page)
+        {
+            return nullptr;
+        }
+
+        return (*page)[(address & 0xFFF) >> 2].get();
+    }
+
+    // takes ownership of block, replacing anything already at address
+    T* insert(uint32_t address, T* block)
+    {
+        std::unique_ptr<BlockPage>& page = _pages[address >> PAGE_SHIFT];
+
+        if (nullptr == page)
+        {
+            page.reset(new BlockPage);
+        }
+
+        (*page)[(address & 0xFFF) >> 2].reset(block);
+
+        return block;
+    }
+
+    void invalidatePage(uint32_t page)
+    {
+        _pages[page].reset();
+    }
+
+    void clear(void)
+    {
+        for (std::unique_ptr<BlockPage>& page : _pages)
+        {
+            page.reset();
+        }
+    }
+
+private:
+    std::array<std::unique_ptr<BlockPage>, PAGE_COUNT> _pages;
+};
+
+
+// instructions that may change PC, COP0 state or address translation
+inline bool isBlockEnd(Instruction instr)
+{
+    switch (instr.op)
+    {
+    case 0: // SPECIAL
+        switch (instr.func)
+        {
+        case 8:  // JR
+        case 9:  // JALR
+        case 12: // SYSCALL
+        case 13: // BREAK
+            return true;
+        }
+        return false;
+    case 1: // REGIMM
+        return (instr.rt & 0x0C) == 0;
+    case 2: // J
+    case 3: // JAL
+    case 4: // BEQ
+    case 5: // BNE
+    case 6: // BLEZ
+    case 7: // BGTZ
+    case 16: // COP0
+    case 20: // BEQL
+    case 21: // BNEL
+    case 22: // BLEZL
+    case 23: // BGTZL
+        return true;
+    case 17: // COP1
+        return instr.fmt == 8;
+    }
+
+    return false;
+}
@@ -0,0 +1,219 @@
+#include <oplog.h>
+#include <oputil.h>
+
+#include <cpu/cachedinterpreter.h>
+
+
+#define MAX_BLOCK_INSTRUCTIONS 128
+
+
+void CachedInterpreter::uninitialize(Bus* bus)
+{
+    flushBlocks();
+
+    Interpreter::uninitialize(bus);
+}
+
+void CachedInterpreter::hardReset(void)
+{
+    flushBlocks();
+
+    Interpreter::hardReset();
+}
+
+void CachedInterpreter::execute(void)
+{
+    LOG_INFO(CachedInterpreter) << "Running...";
+    beginExecution();
+
+    while (!CoreControl::stop)
+    {
+        CodeBlock* block = getBlock((uint32_t)Bus::state.PC);
+
+        if (nullptr == block)
+        {
+            // not cacheable, interpret one instruction
+            prefetch();
+            (this->*instruction_table[_cur_instr.op])();
+            continue;
+        }
+
+        runBlock(block);
+    }
+}
+
+void CachedInterpreter::runBlock(CodeBlock* block)
+{
+    const DecodedInstruction* op = block->ops.data();
+    const DecodedInstruction* end = op + block->length;
+    uint32_t pc = block->address;
+
+    if (block->ops.size() > block->length)
+    {
+        _delay_op = end;
+        _delay_pc = pc + block->length * 4;
+    }
+
+    _block_invalidated = false;
+
+    // the block may be freed by its own stores, so op is not
+    // dereferenced again once an invalidation has been seen
+    do
+    {
+        _cur_instr = op->instr;
+        _check_nop = op->check_nop;
+
+        (this->*op->handler)();
+
+        pc += 4;
+    } while (++op < end && (uint32_t)Bus::state.PC == pc && !_block_invalidated && !CoreControl::stop);
+
+    _delay_op = nullptr;
+}
+
+void CachedInterpreter::executeDelaySlot(void)
+{
+    if (nullptr == _delay_op || (uint32_t)Bus::state.PC != _delay_pc)
+    {
+        Interpreter::executeDelaySlot();
+        return;
+    }
+
+    _cur_instr = _delay_op->instr;
+    _check_nop = _delay_op->check_nop;
+
+    (this->*_delay_op->handler)();
+}
+
+void CachedInterpreter::invalidateCodePage(uint32_t page)
+{
+    _blocks.invalidatePage(page);
+    _block_invalidated = true;
+}
+
+void CachedInterpreter::flushBlocks(void)
+{
+    _blocks.clear();
+    fill_array(_code_pages, 0, CODE_PAGE_COUNT, false);
+
+    _delay_op = nullptr;
+    _block_invalidated = true;
+}
+
+CachedInterpreter::CodeBlock* CachedInterpreter::getBlock(uint32_t pc)
+{
+    uint32_t* host = _bus->mem->fetch(pc);
+
+    // only code in RDRAM is cached
+    uint8_t* rdram = (uint8_t*)Bus::rdram.mem;
+
+    if ((uint8_t*)host < rdram || (uint8_t*)host >= rdram + RDRAM_SIZE)
+    {
+        return nullptr;
+    }
+
+    uint32_t physaddr = (uint32_t)((uint8_t*)host - rdram);
+    CodeBlock* block = _blocks.find(physaddr);
+
+    if (nullptr == block || block->address != pc)
+    {
+        block = buildBlock(pc, host, physaddr);
+    }
+
+    return block;
+}
+
+CachedInterpreter::CodeBlock* CachedInterpreter::buildBlock(uint32_t pc, const uint32_t* host, uint32_t physaddr)
+{
+    uint32_t remaining = (0x1000 - (physaddr & 0xFFF)) >> 2;
+
+    CodeBlock* block = new CodeBlock;
+    block->address = pc;
+    block->length = 0;
+
+    bool branch = false;
+
+    while (block->length < remaining && block->length < MAX_BLOCK_INSTRUCTIONS)
+    {
+        Instruction instr;
+        instr.code = host[block->length];
+
+        if (isBlockEnd(instr))
+        {
+            // its delay slot has to be on the same page to be tracked
+            if (block->length + 1 == remaining)
+            {
+                break;
+            }
+
+            branch = true;
+        }
+
+        block->ops.push_back(decode(host + block->length));
+        block->length++;
+
+        if (branch)
+        {
+            block->ops.push_back(decode(host + block->length));
+            break;
+        }
+    }
+
+    if (0 == block->length)
+    {
+        delete block;
+        return nullptr;
+    }
+
+    _code_pages[physaddr >> CODE_PAGE_SHIFT] = true;
+
+    return _blocks.insert(physaddr, block);
+}
+
+CachedInterpreter::DecodedInstruction CachedInterpreter::decode(const uint32_t* host)
+{
+    DecodedInstruction d;
+    d.instr.code = host[0];
+    d.check_nop = (host[1] == 0);
+
+    switch (d.instr.op)
+    {
+    case 0: // SPECIAL
+        d.handler = special_table[d.instr.func];
+        break;
+    case 1: // REGIMM
+        d.handler = regimm_table[d.instr.rt];
+        break;
+    case 16: // COP0
+        d.handler = (d.instr.rs == 16) ? tlb_table[d.instr.func] : cop0_table[d.instr.rs];
+        break;
+    case 17: // COP1
+        switch (d.instr.fmt)
+        {
+        case 8:
+            d.handler = (d.instr.ft < 4) ? bc_table[d.instr.ft] : instruction_table[d.instr.op];
+            break;
+        case 16:
+            d.handler = s_table[d.instr.func];
+            break;
+        case 17:
+            d.handler = d_table[d.instr.func];
+            break;
+        case 20:
+            d.handler = w_table[d.instr.func];
+            break;
+        case 21:
+            d.handler = l_table[d.instr.func];
+            break;
+        default:
+            d.handler = cop1_table[d.instr.fmt];
+            break;
+        }
+        break;
+    default:
+        d.handler = instruction_table[d.instr.op];
+        break;
+    }
+
+    return d;
+}
@@ -0,0 +1,65 @@
+/* Interpreter running blocks of pre-decoded instructions.
+ * Each block is decoded once and cached by physical address until
+ * the RDRAM page holding it is written to */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "interpreter.h"
+#include "blockcache.h"
+
+
+class CachedInterpreter : public Interpreter
+{
+    struct DecodedInstruction
+    {
+        instruction_ptr handler;
+        Instruction instr;
+        bool check_nop;
+    };
+
+    struct CodeBlock
+    {
+        uint32_t address;   // virtual start address
+        uint32_t length;    // instructions in the block, excluding a trailing delay slot
+        std::vector<DecodedInstruction> ops;
+    };
+
+public:
+    CachedInterpreter(void) = default;
+    ~CachedInterpreter(void) = default;
+
+    virtual uint32_t getCPUType(void)
+    {
+        return CPU_CACHED;
+    }
+
+    virtual void uninitialize(Bus* bus);
+    virtual void execute(void);
+
+    virtual void hardReset(void);
+
+protected:
+    virtual void invalidateCodePage(uint32_t page);
+    virtual void executeDelaySlot(void);
+
+private:
+    CodeBlock* getBlock(uint32_t pc);
+    CodeBlock* buildBlock(uint32_t pc, const uint32_t* host, uint32_t physaddr);
+    void runBlock(CodeBlock* block);
+    void flushBlocks(void);
+
+    // resolve the final handler so no sub-table dispatch is needed at runtime
+    DecodedInstruction decode(const uint32_t* host);
+
+private:
+    BlockCache<CodeBlock> _blocks;
+
+    // delay slot of the running block, if it was decoded with it
+    const DecodedInstruction* _delay_op = nullptr;
+    uint32_t _delay_pc = 0;
+
+    bool _block_invalidated = false;
+};
@@ -2,17 +2,30 @@
 #include "icpu.h"
 
 #include <core/bus.h>
+#include <core/savestate.h>
 #include <rom/rom.h>
 
 
 void CP0::updateCount(uint32_t PC, uint8_t countPerOp)
 {
-    Bus::state.cp0_reg[CP0_COUNT_REG] += ((PC - Bus::state.last_jump_addr) >> 2) * countPerOp;
+    addCycles(((PC - Bus::state.last_jump_addr) >> 2) * countPerOp);
     Bus::state.cp0_reg[CP0_RANDOM_REG] = (Bus::state.cp0_reg[CP0_COUNT_REG] / 2 % (32 - Bus::state.cp0_reg[CP0_WIRED_REG]))
         + Bus::state.cp0_reg[CP0_WIRED_REG];
     Bus::state.last_jump_addr = PC;
 }
 
+void CP0::addCycles(uint64_t cycles)
+{
+    Bus::state.cycles += cycles;
+    Bus::state.cp0_reg[CP0_COUNT_REG] = (uint32_t)Bus::state.cycles + Bus::state.count_base;
+}
+
+void CP0::setCount(uint32_t count)
+{
+    Bus::state.count_base = count - (uint32_t)Bus::state.cycles;
+    Bus::state.cp0_reg[CP0_COUNT_REG] = count;
+}
+
 bool CP0::COP1Unusable(ICPU& cpu)
 {
     if (!(Bus::state.cp0_reg[CP0_STATUS_REG] & 0x20000000))
@@ -23,3 +36,29 @@ bool CP0::COP1Unusable(ICPU& cpu)
     }
     return false;
 }
+
+void CP0::saveState(StateWriter& writer)
+{
+    writer.putBytes(tlb.page_mask.data, sizeof(tlb.page_mask.data));
+    writer.putBytes(tlb.vpn2.data, sizeof(tlb.vpn2.data));
+    writer.putBytes(tlb.global, sizeof(tlb.global));
+    writer.putBytes(tlb.asid, sizeof(tlb.asid));
+
+    writer.putBytes(page_mask, sizeof(page_mask));
+    writer.putBytes(pfn, sizeof(pfn));
+    writer.putBytes(state, sizeof(state));
+}
+
+void CP0::loadState(StateReader& reader)
+{
+    reader.getBytes(tlb.page_mask.data, sizeof(tlb.page_mask.data));
+    reader.getBytes(tlb.vpn2.data, sizeof(tlb.vpn2.data));
+    reader.getBytes(tlb.global, sizeof(tlb.global));
+    reader.getBytes(tlb.asid, sizeof(tlb.asid));
+
+    reader.getBytes(page_mask, sizeof(page_mask));
+    reader.getBytes(pfn, sizeof(pfn));
+    reader.getBytes(state, sizeof(state));
+
+    TLB::tlb_flush(tlb);
+}
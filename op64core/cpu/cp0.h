@@ -5,6 +5,8 @@
 #include <tlb/tlb.h>
 
 class ICPU;
+class StateReader;
+class StateWriter;
 
 class CP0
 {
@@ -13,8 +15,13 @@ public:
     ~CP0(void) = default;
 
     void updateCount(uint32_t PC, uint8_t countPerOp);
+    void addCycles(uint64_t cycles);
+    void setCount(uint32_t count);
     bool COP1Unusable(ICPU& cpu);
 
+    void saveState(StateWriter& writer);
+    void loadState(StateReader& reader);
+
     tlb_o tlb;
 
     uint32_t page_mask[32];
@@ -1,11 +1,5 @@
 #include "icpu.h"
 
-#ifdef BIG_ENDIAN
-#define IS_BIG_ENDIAN 1
-#else
-#define IS_BIG_ENDIAN 0
-#endif
-
 
 void ICPU::CP1::shuffleFPRData(ICPU& cpu, int oldStatus, int newStatus)
 {
@@ -51,24 +45,3 @@ void ICPU::CP1::shuffleFPRData(ICPU& cpu, int oldStatus, int newStatus)
         }
     }
 }
-
-void ICPU::CP1::setFPRPointers(ICPU& cpu, int newStatus)
-{
-    // update the FPR register pointers
-    if (newStatus & 0x04000000)
-    {
-        for(int32_t i = 0; i < 32; i++)
-        {
-            cpu._d_reg[i] = (double*) &cpu._fgr[i];
-            cpu._s_reg[i] = ((float*) &cpu._fgr[i]) + IS_BIG_ENDIAN;
-        }
-    }
-    else
-    {
-        for(int32_t i = 0; i < 32; i++)
-        {
-            cpu._d_reg[i] = (double*) &cpu._fgr[i >> 1];
-            cpu._s_reg[i] = ((float*) &cpu._fgr[i >> 1]) + ((i & 1) ^ IS_BIG_ENDIAN);
-        }
-    }
-}
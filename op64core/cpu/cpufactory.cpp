@@ -0,0 +1,24 @@
+#include <oplog.h>
+
+#include "cpufactory.h"
+
+#include <cpu/interpreter.h>
+#include <cpu/cachedinterpreter.h>
+#include <cpu/recompiler.h>
+
+
+ICPU* createCPU(uint32_t type)
+{
+    switch (type)
+    {
+    case CPU_INTERPRETER:
+        return new Interpreter;
+    case CPU_CACHED:
+        return new CachedInterpreter;
+    case CPU_JIT:
+        return new Recompiler;
+    default:
+        LOG_WARNING(CPUFactory) << "Unsupported CPU core " << type << ", using interpreter";
+        return new Interpreter;
+    }
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cstdint>
+
+#include "icpu.h"
+
+// creates the cpu core for a CPUCoreTypes value, falling back to the interpreter
+ICPU* createCPU(uint32_t type);
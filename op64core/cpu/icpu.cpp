@@ -1,8 +1,66 @@
+#include <algorithm>
+
 #include "icpu.h"
 
+#include <core/bus.h>
+#include <core/savestate.h>
+
 ICPU::ICPU(void) :
     _cur_instr({ 0 }),
     _delay_slot(false)
 {
+    fill_array(_code_pages, 0, CODE_PAGE_COUNT, false);
+    fill_array(_dirty_pages, 0, CODE_PAGE_COUNT, false);
+}
+
+void ICPU::updateRoundingMode(void)
+{
+    switch (_FCR31 & 3)
+    {
+    case 0:
+        rounding_mode = ROUND_MODE; // Round to nearest, or to even if equidistant
+        break;
+    case 1:
+        rounding_mode = TRUNC_MODE; // Truncate (toward 0)
+        break;
+    case 2:
+        rounding_mode = CEIL_MODE; // Round up (toward +infinity) 
+        break;
+    case 3:
+        rounding_mode = FLOOR_MODE; // Round down (toward -infinity) 
+        break;
+    }
+}
+
+void ICPU::saveState(StateWriter& writer)
+{
+    writer.putBytes(_reg, sizeof(_reg));
+    writer.put(_hi);
+    writer.put(_lo);
+    writer.put(_FCR0);
+    writer.put(_FCR31);
+    writer.putBytes(_fgr, sizeof(_fgr));
+    writer.put(_llbit);
+    writer.put(_delay_slot);
+
+    _cp0.saveState(writer);
 }
 
+void ICPU::loadState(StateReader& reader)
+{
+    reader.getBytes(_reg, sizeof(_reg));
+    reader.get(_hi);
+    reader.get(_lo);
+    reader.get(_FCR0);
+    reader.get(_FCR31);
+    reader.getBytes(_fgr, sizeof(_fgr));
+    reader.get(_llbit);
+    reader.get(_delay_slot);
+
+    _cp0.loadState(reader);
+
+    updateRoundingMode();
+
+    // RDRAM is replaced wholesale, drop every cached block
+    invalidateCode(0, RDRAM_SIZE);
+}
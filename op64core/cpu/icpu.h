@@ -1,13 +1,22 @@
 #pragma once
 
-#include <array>
 #include <oppreproc.h>
 
 #include <cpu/cputypes.h>
+#include <rcp/rdramcontroller.h>
 
 #include "cp0.h"
 
+// word order of the FPR halves within _fgr
+#ifdef BIG_ENDIAN
+#define IS_BIG_ENDIAN 1
+#else
+#define IS_BIG_ENDIAN 0
+#endif
+
 class Bus;
+class StateReader;
+class StateWriter;
 
 /************************************************************************/
 /* CPU interface                                                        */
@@ -15,9 +24,6 @@ class Bus;
 
 class ICPU
 {
-    typedef void(ICPU::*instruction_ptr)(void);
-    typedef std::array<instruction_ptr, 64> InstructionTable;
-
 public:
     virtual ~ICPU(void) = default;
     virtual uint32_t getCPUType(void) = 0;
@@ -50,453 +56,77 @@ public:
         _delay_slot = delay;
     }
 
-    // fpu rounding mode
-    int32_t rounding_mode;
-
-protected:
-    ICPU(void);
-
-    //===========================================================================
-    // regular instructions
-
-    inline void SPECIAL(void)
-    {
-        (this->*special_table[_cur_instr.func])();
-    }
-
-    inline void REGIMM(void)
+    // notify caching cores of writes to RDRAM (physical address)
+    inline void invalidateCode(uint32_t address, uint32_t length = 4)
     {
-        (this->*regimm_table[_cur_instr.rt])();
+        uint32_t first = (address & (RDRAM_SIZE - 1)) >> CODE_PAGE_SHIFT;
+        uint32_t last = ((address & (RDRAM_SIZE - 1)) + length - 1) >> CODE_PAGE_SHIFT;
+
+        for (uint32_t page = first; page <= last && page < CODE_PAGE_COUNT; page++)
+        {
+            _dirty_pages[page] = true;
+
+            if (_code_pages[page])
+            {
+                _code_pages[page] = false;
+                invalidateCodePage(page);
+            }
+        }
     }
 
-    virtual void J(void) = 0;
-    virtual void JAL(void) = 0;
-    virtual void BEQ(void) = 0;
-    virtual void BNE(void) = 0;
-    virtual void BLEZ(void) = 0;
-    virtual void BGTZ(void) = 0;
-
-    virtual void ADDI(void) = 0;
-    virtual void ADDIU(void) = 0;
-    virtual void SLTI(void) = 0;
-    virtual void SLTIU(void) = 0;
-    virtual void ANDI(void) = 0;
-    virtual void ORI(void) = 0;
-    virtual void XORI(void) = 0;
-    virtual void LUI(void) = 0;
-
-    inline void COP0(void)
+    // RDRAM pages written by the core since the last clearDirtyPages, used by Rewind
+    inline const bool* getDirtyPages(void)
     {
-        (this->*cop0_table[_cur_instr.rs])();
+        return _dirty_pages;
     }
 
-    inline void COP1(void)
+    // for writes the core did not see, plugins write RDRAM directly
+    inline void markDirtyPage(uint32_t page)
     {
-        (this->*cop1_table[_cur_instr.fmt])();
+        _dirty_pages[page] = true;
     }
 
-    virtual void SV(void) = 0;
-    virtual void BEQL(void) = 0;
-    virtual void BNEL(void) = 0;
-    virtual void BLEZL(void) = 0;
-    virtual void BGTZL(void) = 0;
-
-    virtual void DADDI(void) = 0;
-    virtual void DADDIU(void) = 0;
-    virtual void LDL(void) = 0;
-    virtual void LDR(void) = 0;
-
-    virtual void LB(void) = 0;
-    virtual void LH(void) = 0;
-    virtual void LWL(void) = 0;
-    virtual void LW(void) = 0;
-    virtual void LBU(void) = 0;
-    virtual void LHU(void) = 0;
-    virtual void LWR(void) = 0;
-    virtual void LWU(void) = 0;
-
-    virtual void SB(void) = 0;
-    virtual void SH(void) = 0;
-    virtual void SWL(void) = 0;
-    virtual void SW(void) = 0;
-    virtual void SDL(void) = 0;
-    virtual void SDR(void) = 0;
-    virtual void SWR(void) = 0;
-    virtual void CACHE(void) = 0;
-
-    virtual void LL(void) = 0;
-    virtual void LWC1(void) = 0;
-    virtual void LLD(void) = 0;
-    virtual void LDC1(void) = 0;
-    virtual void LD(void) = 0;
-
-    virtual void SC(void) = 0;
-    virtual void SWC1(void) = 0;
-    virtual void SCD(void) = 0;
-    virtual void SDC1(void) = 0;
-    virtual void SD(void) = 0;
-
-    InstructionTable instruction_table = 
-    {{
-        &ICPU::SPECIAL, &ICPU::REGIMM, &ICPU::J, &ICPU::JAL, &ICPU::BEQ, &ICPU::BNE, &ICPU::BLEZ, &ICPU::BGTZ,
-        &ICPU::ADDI, &ICPU::ADDIU, &ICPU::SLTI, &ICPU::SLTIU, &ICPU::ANDI, &ICPU::ORI, &ICPU::XORI, &ICPU::LUI,
-        &ICPU::COP0, &ICPU::COP1, &ICPU::SV, &ICPU::SV, &ICPU::BEQL, &ICPU::BNEL, &ICPU::BLEZL, &ICPU::BGTZL,
-        &ICPU::DADDI, &ICPU::DADDIU, &ICPU::LDL, &ICPU::LDR, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV,
-        &ICPU::LB, &ICPU::LH, &ICPU::LWL, &ICPU::LW, &ICPU::LBU, &ICPU::LHU, &ICPU::LWR, &ICPU::LWU,
-        &ICPU::SB, &ICPU::SH, &ICPU::SWL, &ICPU::SW, &ICPU::SDL, &ICPU::SDR, &ICPU::SWR, &ICPU::CACHE,
-        &ICPU::LL, &ICPU::LWC1, &ICPU::SV, &ICPU::SV, &ICPU::LLD, &ICPU::LDC1, &ICPU::SV, &ICPU::LD,
-        &ICPU::SC, &ICPU::SWC1, &ICPU::SV, &ICPU::SV, &ICPU::SCD, &ICPU::SDC1, &ICPU::SV, &ICPU::SD
-    }};
-
-
-    //===========================================================================
-    // special instructions
-
-
-    virtual void SLL(void) = 0;
-    virtual void SRL(void) = 0;
-    virtual void SRA(void) = 0;
-    virtual void SLLV(void) = 0;
-    virtual void SRLV(void) = 0;
-    virtual void SRAV(void) = 0;
-
-    virtual void JR(void) = 0;
-    virtual void JALR(void) = 0;
-    virtual void SYSCALL(void) = 0;
-    virtual void BREAK(void) = 0;
-    virtual void SYNC(void) = 0;
-
-    virtual void MFHI(void) = 0;
-    virtual void MTHI(void) = 0;
-    virtual void MFLO(void) = 0;
-    virtual void MTLO(void) = 0;
-    virtual void DSLLV(void) = 0;
-    virtual void DSRLV(void) = 0;
-    virtual void DSRAV(void) = 0;
-
-    virtual void MULT(void) = 0;
-    virtual void MULTU(void) = 0;
-    virtual void DIV(void) = 0;
-    virtual void DIVU(void) = 0;
-    virtual void DMULT(void) = 0;
-    virtual void DMULTU(void) = 0;
-    virtual void DDIV(void) = 0;
-    virtual void DDIVU(void) = 0;
-
-    virtual void ADD(void) = 0;
-    virtual void ADDU(void) = 0;
-    virtual void SUB(void) = 0;
-    virtual void SUBU(void) = 0;
-    virtual void AND(void) = 0;
-    virtual void OR(void) = 0;
-    virtual void XOR(void) = 0;
-    virtual void NOR(void) = 0;
-
-    virtual void SLT(void) = 0;
-    virtual void SLTU(void) = 0;
-    virtual void DADD(void) = 0;
-    virtual void DADDU(void) = 0;
-    virtual void DSUB(void) = 0;
-    virtual void DSUBU(void) = 0;
-
-    virtual void TGE(void) = 0;
-    virtual void TGEU(void) = 0;
-    virtual void TLT(void) = 0;
-    virtual void TLTU(void) = 0;
-    virtual void TEQ(void) = 0;
-    virtual void TNE(void) = 0;
-
-    virtual void DSLL(void) = 0;
-    virtual void DSRL(void) = 0;
-    virtual void DSRA(void) = 0;
-    virtual void DSLL32(void) = 0;
-    virtual void DSRL32(void) = 0;
-    virtual void DSRA32(void) = 0;
-
-    InstructionTable special_table = 
-    {{
-        &ICPU::SLL, &ICPU::SV, &ICPU::SRL, &ICPU::SRA, &ICPU::SLLV, &ICPU::SV, &ICPU::SRLV, &ICPU::SRAV,
-        &ICPU::JR, &ICPU::JALR, &ICPU::SV, &ICPU::SV, &ICPU::SYSCALL, &ICPU::BREAK, &ICPU::SV, &ICPU::SYNC,
-        &ICPU::MFHI, &ICPU::MTHI, &ICPU::MFLO, &ICPU::MTLO, &ICPU::DSLLV, &ICPU::SV, &ICPU::DSRLV, &ICPU::DSRAV,
-        &ICPU::MULT, &ICPU::MULTU, &ICPU::DIV, &ICPU::DIVU, &ICPU::DMULT, &ICPU::DMULTU, &ICPU::DDIV, &ICPU::DDIVU,
-        &ICPU::ADD, &ICPU::ADDU, &ICPU::SUB, &ICPU::SUBU, &ICPU::AND, &ICPU::OR, &ICPU::XOR, &ICPU::NOR,
-        &ICPU::SV, &ICPU::SV, &ICPU::SLT, &ICPU::SLTU, &ICPU::DADD, &ICPU::DADDU, &ICPU::DSUB, &ICPU::DSUBU,
-        &ICPU::TGE, &ICPU::TGEU, &ICPU::TLT, &ICPU::TLTU, &ICPU::TEQ, &ICPU::SV, &ICPU::TNE, &ICPU::SV,
-        &ICPU::DSLL, &ICPU::SV, &ICPU::DSRL, &ICPU::DSRA, &ICPU::DSLL32, &ICPU::SV, &ICPU::DSRL32, &ICPU::DSRA32
-    }};
-
-
-    //===========================================================================
-    // regimm instructions
-
-    virtual void BLTZ(void) = 0;
-    virtual void BGEZ(void) = 0;
-    virtual void BLTZL(void) = 0;
-    virtual void BGEZL(void) = 0;
-    virtual void TGEI(void) = 0;
-    virtual void TGEIU(void) = 0;
-    virtual void TLTI(void) = 0;
-    virtual void TLTIU(void) = 0;
-    virtual void TEQI(void) = 0;
-    virtual void TNEI(void) = 0;
-    virtual void BLTZAL(void) = 0;
-    virtual void BGEZAL(void) = 0;
-    virtual void BLTZALL(void) = 0;
-    virtual void BGEZALL(void) = 0;
-
-    InstructionTable regimm_table = 
-    {{
-        &ICPU::BLTZ, &ICPU::BGEZ, &ICPU::BLTZL, &ICPU::BGEZL, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV,
-        &ICPU::TGEI, &ICPU::TGEIU, &ICPU::TLTI, &ICPU::TLTIU, &ICPU::TEQI, &ICPU::SV, &ICPU::TNEI, &ICPU::SV,
-        &ICPU::BLTZAL, &ICPU::BGEZAL, &ICPU::BLTZALL, &ICPU::BGEZALL, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV,
-        &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV
-    }};
-
-
-    //===========================================================================
-    // cop0 instructions
-
-    virtual void MFC0(void) = 0;
-    virtual void MTC0(void) = 0;
-
-    inline void TLB(void)
+    inline void clearDirtyPages(void)
     {
-        (this->*tlb_table[_cur_instr.func])();
+        fill_array(_dirty_pages, 0, CODE_PAGE_COUNT, false);
     }
 
-    InstructionTable cop0_table =
-    {{
-        &ICPU::MFC0, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::MTC0, &ICPU::SV, &ICPU::SV, &ICPU::SV,
-        &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV,
-        &ICPU::TLB, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV,
-        &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV
-    }};
-
-
-    //===========================================================================
-    // cop1 instructions
+    // registers, FPU and TLB state for save states
+    void saveState(StateWriter& writer);
+    void loadState(StateReader& reader);
 
-    virtual void MFC1(void) = 0;
-    virtual void DMFC1(void) = 0;
-    virtual void CFC1(void) = 0;
-    virtual void MTC1(void) = 0;
-    virtual void DMTC1(void) = 0;
-    virtual void CTC1(void) = 0;
+    // fpu rounding mode
+    int32_t rounding_mode;
 
-    inline void BC(void)
+    // plugins run on the emulation thread and may change the host FPU
+    // mode, call after them so the next FPU op sets it again
+    inline void invalidateHostRounding(void)
     {
-        (this->*bc_table[_cur_instr.ft])();
+        _host_rounding = -1;
     }
 
-    inline void S(void)
-    {
-        (this->*s_table[_cur_instr.func])();
-    }
+protected:
+    ICPU(void);
 
-    inline void D(void)
+    enum : uint32_t
     {
-        (this->*d_table[_cur_instr.func])();
-    }
+        CODE_PAGE_SHIFT = 12,
+        CODE_PAGE_COUNT = RDRAM_SIZE >> CODE_PAGE_SHIFT
+    };
 
-    inline void W(void)
-    {
-        (this->*w_table[_cur_instr.func])();
-    }
+    // rounding mode last set on the host FPU, -1 until the next FPU op
+    int32_t _host_rounding = -1;
 
-    inline void L(void)
-    {
-        (this->*l_table[_cur_instr.func])();
-    }
+    // called when a page marked in _code_pages is written to
+    virtual void invalidateCodePage(uint32_t /*page*/) {}
 
-    InstructionTable cop1_table =
-    {{
-        &ICPU::MFC1,&ICPU::DMFC1,&ICPU::CFC1,&ICPU::SV,&ICPU::MTC1,&ICPU::DMTC1,&ICPU::CTC1,&ICPU::SV,
-        &ICPU::BC  ,&ICPU::SV   ,&ICPU::SV  ,&ICPU::SV,&ICPU::SV  ,&ICPU::SV   ,&ICPU::SV  ,&ICPU::SV,
-        &ICPU::S   ,&ICPU::D    ,&ICPU::SV  ,&ICPU::SV,&ICPU::W   ,&ICPU::L    ,&ICPU::SV  ,&ICPU::SV,
-        &ICPU::SV  ,&ICPU::SV   ,&ICPU::SV  ,&ICPU::SV,&ICPU::SV  ,&ICPU::SV   ,&ICPU::SV  ,&ICPU::SV
-    }};
-
-    //===========================================================================
-    // tlb instructions
-
-    virtual void TLBR(void) = 0;
-    virtual void TLBWI(void) = 0;
-    virtual void TLBWR(void) = 0;
-    virtual void TLBP(void) = 0;
-    virtual void ERET(void) = 0;
-
-    InstructionTable tlb_table =
-    {{
-        &ICPU::SV  ,&ICPU::TLBR,&ICPU::TLBWI,&ICPU::SV,&ICPU::SV,&ICPU::SV,&ICPU::TLBWR,&ICPU::SV, 
-        &ICPU::TLBP,&ICPU::SV  ,&ICPU::SV   ,&ICPU::SV,&ICPU::SV,&ICPU::SV,&ICPU::SV   ,&ICPU::SV, 
-        &ICPU::SV  ,&ICPU::SV  ,&ICPU::SV   ,&ICPU::SV,&ICPU::SV,&ICPU::SV,&ICPU::SV   ,&ICPU::SV, 
-        &ICPU::ERET,&ICPU::SV  ,&ICPU::SV   ,&ICPU::SV,&ICPU::SV,&ICPU::SV,&ICPU::SV   ,&ICPU::SV, 
-        &ICPU::SV  ,&ICPU::SV  ,&ICPU::SV   ,&ICPU::SV,&ICPU::SV,&ICPU::SV,&ICPU::SV   ,&ICPU::SV, 
-        &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV,
-        &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV,
-        &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV
-    }};
-
-    //===========================================================================
-    // bc instructions
-
-    virtual void BC1F(void) = 0;
-    virtual void BC1T(void) = 0;
-    virtual void BC1FL(void) = 0;
-    virtual void BC1TL(void) = 0;
-
-    InstructionTable bc_table =
-    {{
-        &ICPU::BC1F ,&ICPU::BC1T ,
-        &ICPU::BC1FL,&ICPU::BC1TL
-    }};
-
-
-    //===========================================================================
-    // s instructions
-    virtual void ADD_S(void) = 0;
-    virtual void SUB_S(void) = 0;
-    virtual void MUL_S(void) = 0;
-    virtual void DIV_S(void) = 0;
-    virtual void SQRT_S(void) = 0;
-    virtual void ABS_S(void) = 0;
-    virtual void MOV_S(void) = 0;
-    virtual void NEG_S(void) = 0;
-    virtual void ROUND_L_S(void) = 0;
-    virtual void TRUNC_L_S(void) = 0;
-    virtual void CEIL_L_S(void) = 0;
-    virtual void FLOOR_L_S(void) = 0;
-    virtual void ROUND_W_S(void) = 0;
-    virtual void TRUNC_W_S(void) = 0;
-    virtual void CEIL_W_S(void) = 0;
-    virtual void FLOOR_W_S(void) = 0;
-    virtual void CVT_D_S(void) = 0;
-    virtual void CVT_W_S(void) = 0;
-    virtual void CVT_L_S(void) = 0;
-    virtual void C_F_S(void) = 0;
-    virtual void C_UN_S(void) = 0;
-    virtual void C_EQ_S(void) = 0;
-    virtual void C_UEQ_S(void) = 0;
-    virtual void C_OLT_S(void) = 0;
-    virtual void C_ULT_S(void) = 0;
-    virtual void C_OLE_S(void) = 0;
-    virtual void C_ULE_S(void) = 0;
-    virtual void C_SF_S(void) = 0;
-    virtual void C_NGLE_S(void) = 0;
-    virtual void C_SEQ_S(void) = 0;
-    virtual void C_NGL_S(void) = 0;
-    virtual void C_LT_S(void) = 0;
-    virtual void C_NGE_S(void) = 0;
-    virtual void C_LE_S(void) = 0;
-    virtual void C_NGT_S(void) = 0;
-
-    InstructionTable s_table =
-    {{
-        &ICPU::ADD_S    ,&ICPU::SUB_S    ,&ICPU::MUL_S   ,&ICPU::DIV_S    ,&ICPU::SQRT_S   ,&ICPU::ABS_S    ,&ICPU::MOV_S   ,&ICPU::NEG_S    , 
-        &ICPU::ROUND_L_S,&ICPU::TRUNC_L_S,&ICPU::CEIL_L_S,&ICPU::FLOOR_L_S,&ICPU::ROUND_W_S,&ICPU::TRUNC_W_S,&ICPU::CEIL_W_S,&ICPU::FLOOR_W_S, 
-        &ICPU::SV       ,&ICPU::SV       ,&ICPU::SV      ,&ICPU::SV       ,&ICPU::SV       ,&ICPU::SV       ,&ICPU::SV      ,&ICPU::SV       , 
-        &ICPU::SV       ,&ICPU::SV       ,&ICPU::SV      ,&ICPU::SV       ,&ICPU::SV       ,&ICPU::SV       ,&ICPU::SV      ,&ICPU::SV       , 
-        &ICPU::SV       ,&ICPU::CVT_D_S  ,&ICPU::SV      ,&ICPU::SV       ,&ICPU::CVT_W_S  ,&ICPU::CVT_L_S  ,&ICPU::SV      ,&ICPU::SV       , 
-        &ICPU::SV       ,&ICPU::SV       ,&ICPU::SV      ,&ICPU::SV       ,&ICPU::SV       ,&ICPU::SV       ,&ICPU::SV      ,&ICPU::SV       , 
-        &ICPU::C_F_S    ,&ICPU::C_UN_S   ,&ICPU::C_EQ_S  ,&ICPU::C_UEQ_S  ,&ICPU::C_OLT_S  ,&ICPU::C_ULT_S  ,&ICPU::C_OLE_S ,&ICPU::C_ULE_S  , 
-        &ICPU::C_SF_S   ,&ICPU::C_NGLE_S ,&ICPU::C_SEQ_S ,&ICPU::C_NGL_S  ,&ICPU::C_LT_S   ,&ICPU::C_NGE_S  ,&ICPU::C_LE_S  ,&ICPU::C_NGT_S
-    }};
-
-
-    //===========================================================================
-    // d instructions
-
-    virtual void ADD_D(void) = 0;
-    virtual void SUB_D(void) = 0;
-    virtual void MUL_D(void) = 0;
-    virtual void DIV_D(void) = 0;
-    virtual void SQRT_D(void) = 0;
-    virtual void ABS_D(void) = 0;
-    virtual void MOV_D(void) = 0;
-    virtual void NEG_D(void) = 0;
-    virtual void ROUND_L_D(void) = 0;
-    virtual void TRUNC_L_D(void) = 0;
-    virtual void CEIL_L_D(void) = 0;
-    virtual void FLOOR_L_D(void) = 0;
-    virtual void ROUND_W_D(void) = 0;
-    virtual void TRUNC_W_D(void) = 0;
-    virtual void CEIL_W_D(void) = 0;
-    virtual void FLOOR_W_D(void) = 0;
-    virtual void CVT_S_D(void) = 0;
-    virtual void CVT_W_D(void) = 0;
-    virtual void CVT_L_D(void) = 0;
-    virtual void C_F_D(void) = 0;
-    virtual void C_UN_D(void) = 0;
-    virtual void C_EQ_D(void) = 0;
-    virtual void C_UEQ_D(void) = 0;
-    virtual void C_OLT_D(void) = 0;
-    virtual void C_ULT_D(void) = 0;
-    virtual void C_OLE_D(void) = 0;
-    virtual void C_ULE_D(void) = 0;
-    virtual void C_SF_D(void) = 0;
-    virtual void C_NGLE_D(void) = 0;
-    virtual void C_SEQ_D(void) = 0;
-    virtual void C_NGL_D(void) = 0;
-    virtual void C_LT_D(void) = 0;
-    virtual void C_NGE_D(void) = 0;
-    virtual void C_LE_D(void) = 0;
-    virtual void C_NGT_D(void) = 0;
-
-    InstructionTable d_table =
-    {{
-        &ICPU::ADD_D    ,&ICPU::SUB_D    ,&ICPU::MUL_D   ,&ICPU::DIV_D    ,&ICPU::SQRT_D   ,&ICPU::ABS_D    ,&ICPU::MOV_D   ,&ICPU::NEG_D    ,
-        &ICPU::ROUND_L_D,&ICPU::TRUNC_L_D,&ICPU::CEIL_L_D,&ICPU::FLOOR_L_D,&ICPU::ROUND_W_D,&ICPU::TRUNC_W_D,&ICPU::CEIL_W_D,&ICPU::FLOOR_W_D,
-        &ICPU::SV       ,&ICPU::SV       ,&ICPU::SV      ,&ICPU::SV       ,&ICPU::SV       ,&ICPU::SV       ,&ICPU::SV      ,&ICPU::SV       ,
-        &ICPU::SV       ,&ICPU::SV       ,&ICPU::SV      ,&ICPU::SV       ,&ICPU::SV       ,&ICPU::SV       ,&ICPU::SV      ,&ICPU::SV       ,
-        &ICPU::CVT_S_D  ,&ICPU::SV       ,&ICPU::SV      ,&ICPU::SV       ,&ICPU::CVT_W_D  ,&ICPU::CVT_L_D  ,&ICPU::SV      ,&ICPU::SV       ,
-        &ICPU::SV       ,&ICPU::SV       ,&ICPU::SV      ,&ICPU::SV       ,&ICPU::SV       ,&ICPU::SV       ,&ICPU::SV      ,&ICPU::SV       ,
-        &ICPU::C_F_D    ,&ICPU::C_UN_D   ,&ICPU::C_EQ_D  ,&ICPU::C_UEQ_D  ,&ICPU::C_OLT_D  ,&ICPU::C_ULT_D  ,&ICPU::C_OLE_D ,&ICPU::C_ULE_D  ,
-        &ICPU::C_SF_D   ,&ICPU::C_NGLE_D ,&ICPU::C_SEQ_D ,&ICPU::C_NGL_D  ,&ICPU::C_LT_D   ,&ICPU::C_NGE_D  ,&ICPU::C_LE_D  ,&ICPU::C_NGT_D
-    }};
-
-
-    //===========================================================================
-    // w instructions
-
-    virtual void CVT_S_W(void) = 0;
-    virtual void CVT_D_W(void) = 0;
-
-    InstructionTable w_table =
-    {{
-        &ICPU::SV     ,&ICPU::SV     ,&ICPU::SV,&ICPU::SV,&ICPU::SV,&ICPU::SV,&ICPU::SV,&ICPU::SV, 
-        &ICPU::SV     ,&ICPU::SV     ,&ICPU::SV,&ICPU::SV,&ICPU::SV,&ICPU::SV,&ICPU::SV,&ICPU::SV, 
-        &ICPU::SV     ,&ICPU::SV     ,&ICPU::SV,&ICPU::SV,&ICPU::SV,&ICPU::SV,&ICPU::SV,&ICPU::SV, 
-        &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV,
-        &ICPU::CVT_S_W, &ICPU::CVT_D_W, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV,
-        &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV,
-        &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV,
-        &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV
-    }};
-
-
-    //===========================================================================
-    // l instructions
-
-    virtual void CVT_D_L(void) = 0;
-    virtual void CVT_S_L(void) = 0;
-
-    InstructionTable l_table =
-    {{
-        &ICPU::SV     ,&ICPU::SV     ,&ICPU::SV,&ICPU::SV,&ICPU::SV,&ICPU::SV,&ICPU::SV,&ICPU::SV, 
-        &ICPU::SV     ,&ICPU::SV     ,&ICPU::SV,&ICPU::SV,&ICPU::SV,&ICPU::SV,&ICPU::SV,&ICPU::SV, 
-        &ICPU::SV     ,&ICPU::SV     ,&ICPU::SV,&ICPU::SV,&ICPU::SV,&ICPU::SV,&ICPU::SV,&ICPU::SV, 
-        &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV,
-        &ICPU::CVT_S_L, &ICPU::CVT_D_L, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV,
-        &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV,
-        &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV,
-        &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV, &ICPU::SV
-    }};
+    // sets rounding_mode from the FCR31 rounding bits
+    void updateRoundingMode(void);
 
     class CP1
     {
     public:
         void shuffleFPRData(ICPU& cpu, int oldStatus, int newStatus);
-        void setFPRPointers(ICPU& cpu, int newStatus);
     };
 
 
@@ -515,8 +145,6 @@ protected:
     // cp1 regs
     uint32_t _FCR0;
     uint32_t _FCR31;
-    float* _s_reg[32];
-    double* _d_reg[32];
     uint64_t _fgr[32];
 
     // COPs
@@ -527,6 +155,12 @@ protected:
     bool _llbit;
     bool _delay_slot;
 
+    // RDRAM pages holding cached code
+    bool _code_pages[CODE_PAGE_COUNT];
+
+    // RDRAM pages written since the last clearDirtyPages
+    bool _dirty_pages[CODE_PAGE_COUNT];
+
 private:
     // Not implemented
     ICPU(const ICPU&);
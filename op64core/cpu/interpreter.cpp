@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstring>
 #include <cstdint>
 
@@ -66,6 +67,141 @@ const int SDR_SHIFT[8] = { 56, 48, 40, 32, 24, 16, 8, 0 };
 const int LDL_SHIFT[8] = { 0, 8, 16, 24, 32, 40, 48, 56 };
 const int LDR_SHIFT[8] = { 56, 48, 40, 32, 24, 16, 8, 0 };
 
+const Interpreter::InstructionTable Interpreter::instruction_table =
+{{
+    &Interpreter::SPECIAL, &Interpreter::REGIMM, &Interpreter::J, &Interpreter::JAL, &Interpreter::BEQ, &Interpreter::BNE, &Interpreter::BLEZ, &Interpreter::BGTZ,
+    &Interpreter::ADDI, &Interpreter::ADDIU, &Interpreter::SLTI, &Interpreter::SLTIU, &Interpreter::ANDI, &Interpreter::ORI, &Interpreter::XORI, &Interpreter::LUI,
+    &Interpreter::COP0, &Interpreter::COP1, &Interpreter::SV, &Interpreter::SV, &Interpreter::BEQL, &Interpreter::BNEL, &Interpreter::BLEZL, &Interpreter::BGTZL,
+    &Interpreter::DADDI, &Interpreter::DADDIU, &Interpreter::LDL, &Interpreter::LDR, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV,
+    &Interpreter::LB, &Interpreter::LH, &Interpreter::LWL, &Interpreter::LW, &Interpreter::LBU, &Interpreter::LHU, &Interpreter::LWR, &Interpreter::LWU,
+    &Interpreter::SB, &Interpreter::SH, &Interpreter::SWL, &Interpreter::SW, &Interpreter::SDL, &Interpreter::SDR, &Interpreter::SWR, &Interpreter::CACHE,
+    &Interpreter::LL, &Interpreter::LWC1, &Interpreter::SV, &Interpreter::SV, &Interpreter::LLD, &Interpreter::LDC1, &Interpreter::SV, &Interpreter::LD,
+    &Interpreter::SC, &Interpreter::SWC1, &Interpreter::SV, &Interpreter::SV, &Interpreter::SCD, &Interpreter::SDC1, &Interpreter::SV, &Interpreter::SD
+}};
+
+const Interpreter::InstructionTable Interpreter::special_table =
+{{
+    &Interpreter::SLL, &Interpreter::SV, &Interpreter::SRL, &Interpreter::SRA, &Interpreter::SLLV, &Interpreter::SV, &Interpreter::SRLV, &Interpreter::SRAV,
+    &Interpreter::JR, &Interpreter::JALR, &Interpreter::SV, &Interpreter::SV, &Interpreter::SYSCALL, &Interpreter::BREAK, &Interpreter::SV, &Interpreter::SYNC,
+    &Interpreter::MFHI, &Interpreter::MTHI, &Interpreter::MFLO, &Interpreter::MTLO, &Interpreter::DSLLV, &Interpreter::SV, &Interpreter::DSRLV, &Interpreter::DSRAV,
+    &Interpreter::MULT, &Interpreter::MULTU, &Interpreter::DIV, &Interpreter::DIVU, &Interpreter::DMULT, &Interpreter::DMULTU, &Interpreter::DDIV, &Interpreter::DDIVU,
+    &Interpreter::ADD, &Interpreter::ADDU, &Interpreter::SUB, &Interpreter::SUBU, &Interpreter::AND, &Interpreter::OR, &Interpreter::XOR, &Interpreter::NOR,
+    &Interpreter::SV, &Interpreter::SV, &Interpreter::SLT, &Interpreter::SLTU, &Interpreter::DADD, &Interpreter::DADDU, &Interpreter::DSUB, &Interpreter::DSUBU,
+    &Interpreter::TGE, &Interpreter::TGEU, &Interpreter::TLT, &Interpreter::TLTU, &Interpreter::TEQ, &Interpreter::SV, &Interpreter::TNE, &Interpreter::SV,
+    &Interpreter::DSLL, &Interpreter::SV, &Interpreter::DSRL, &Interpreter::DSRA, &Interpreter::DSLL32, &Interpreter::SV, &Interpreter::DSRL32, &Interpreter::DSRA32
+}};
+
+const Interpreter::InstructionTable Interpreter::regimm_table =
+{{
+    &Interpreter::BLTZ, &Interpreter::BGEZ, &Interpreter::BLTZL, &Interpreter::BGEZL, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV,
+    &Interpreter::TGEI, &Interpreter::TGEIU, &Interpreter::TLTI, &Interpreter::TLTIU, &Interpreter::TEQI, &Interpreter::SV, &Interpreter::TNEI, &Interpreter::SV,
+    &Interpreter::BLTZAL, &Interpreter::BGEZAL, &Interpreter::BLTZALL, &Interpreter::BGEZALL, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV,
+    &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV
+}};
+
+const Interpreter::InstructionTable Interpreter::cop0_table =
+{{
+    &Interpreter::MFC0, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::MTC0, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV,
+    &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV,
+    &Interpreter::TLB, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV,
+    &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV
+}};
+
+const Interpreter::InstructionTable Interpreter::cop1_table =
+{{
+    &Interpreter::MFC1,&Interpreter::DMFC1,&Interpreter::CFC1,&Interpreter::SV,&Interpreter::MTC1,&Interpreter::DMTC1,&Interpreter::CTC1,&Interpreter::SV,
+    &Interpreter::BC  ,&Interpreter::SV   ,&Interpreter::SV  ,&Interpreter::SV,&Interpreter::SV  ,&Interpreter::SV   ,&Interpreter::SV  ,&Interpreter::SV,
+    &Interpreter::S   ,&Interpreter::D    ,&Interpreter::SV  ,&Interpreter::SV,&Interpreter::W   ,&Interpreter::L    ,&Interpreter::SV  ,&Interpreter::SV,
+    &Interpreter::SV  ,&Interpreter::SV   ,&Interpreter::SV  ,&Interpreter::SV,&Interpreter::SV  ,&Interpreter::SV   ,&Interpreter::SV  ,&Interpreter::SV
+}};
+
+const Interpreter::InstructionTable Interpreter::tlb_table =
+{{
+    &Interpreter::SV  ,&Interpreter::TLBR,&Interpreter::TLBWI,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV,&Interpreter::TLBWR,&Interpreter::SV, 
+    &Interpreter::TLBP,&Interpreter::SV  ,&Interpreter::SV   ,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV   ,&Interpreter::SV, 
+    &Interpreter::SV  ,&Interpreter::SV  ,&Interpreter::SV   ,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV   ,&Interpreter::SV, 
+    &Interpreter::ERET,&Interpreter::SV  ,&Interpreter::SV   ,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV   ,&Interpreter::SV, 
+    &Interpreter::SV  ,&Interpreter::SV  ,&Interpreter::SV   ,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV   ,&Interpreter::SV, 
+    &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV,
+    &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV,
+    &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV
+}};
+
+const Interpreter::InstructionTable Interpreter::bc_table =
+{{
+    &Interpreter::BC1F ,&Interpreter::BC1T ,
+    &Interpreter::BC1FL,&Interpreter::BC1TL
+}};
+
+const Interpreter::InstructionTable Interpreter::s_table =
+{{
+    &Interpreter::ADD_S    ,&Interpreter::SUB_S    ,&Interpreter::MUL_S   ,&Interpreter::DIV_S    ,&Interpreter::SQRT_S   ,&Interpreter::ABS_S    ,&Interpreter::MOV_S   ,&Interpreter::NEG_S    , 
+    &Interpreter::ROUND_L_S,&Interpreter::TRUNC_L_S,&Interpreter::CEIL_L_S,&Interpreter::FLOOR_L_S,&Interpreter::ROUND_W_S,&Interpreter::TRUNC_W_S,&Interpreter::CEIL_W_S,&Interpreter::FLOOR_W_S, 
+    &Interpreter::SV       ,&Interpreter::SV       ,&Interpreter::SV      ,&Interpreter::SV       ,&Interpreter::SV       ,&Interpreter::SV       ,&Interpreter::SV      ,&Interpreter::SV       , 
+    &Interpreter::SV       ,&Interpreter::SV       ,&Interpreter::SV      ,&Interpreter::SV       ,&Interpreter::SV       ,&Interpreter::SV       ,&Interpreter::SV      ,&Interpreter::SV       , 
+    &Interpreter::SV       ,&Interpreter::CVT_D_S  ,&Interpreter::SV      ,&Interpreter::SV       ,&Interpreter::CVT_W_S  ,&Interpreter::CVT_L_S  ,&Interpreter::SV      ,&Interpreter::SV       , 
+    &Interpreter::SV       ,&Interpreter::SV       ,&Interpreter::SV      ,&Interpreter::SV       ,&Interpreter::SV       ,&Interpreter::SV       ,&Interpreter::SV      ,&Interpreter::SV       , 
+    &Interpreter::C_F_S    ,&Interpreter::C_UN_S   ,&Interpreter::C_EQ_S  ,&Interpreter::C_UEQ_S  ,&Interpreter::C_OLT_S  ,&Interpreter::C_ULT_S  ,&Interpreter::C_OLE_S ,&Interpreter::C_ULE_S  , 
+    &Interpreter::C_SF_S   ,&Interpreter::C_NGLE_S ,&Interpreter::C_SEQ_S ,&Interpreter::C_NGL_S  ,&Interpreter::C_LT_S   ,&Interpreter::C_NGE_S  ,&Interpreter::C_LE_S  ,&Interpreter::C_NGT_S
+}};
+
+const Interpreter::InstructionTable Interpreter::d_table =
+{{
+    &Interpreter::ADD_D    ,&Interpreter::SUB_D    ,&Interpreter::MUL_D   ,&Interpreter::DIV_D    ,&Interpreter::SQRT_D   ,&Interpreter::ABS_D    ,&Interpreter::MOV_D   ,&Interpreter::NEG_D    ,
+    &Interpreter::ROUND_L_D,&Interpreter::TRUNC_L_D,&Interpreter::CEIL_L_D,&Interpreter::FLOOR_L_D,&Interpreter::ROUND_W_D,&Interpreter::TRUNC_W_D,&Interpreter::CEIL_W_D,&Interpreter::FLOOR_W_D,
+    &Interpreter::SV       ,&Interpreter::SV       ,&Interpreter::SV      ,&Interpreter::SV       ,&Interpreter::SV       ,&Interpreter::SV       ,&Interpreter::SV      ,&Interpreter::SV       ,
+    &Interpreter::SV       ,&Interpreter::SV       ,&Interpreter::SV      ,&Interpreter::SV       ,&Interpreter::SV       ,&Interpreter::SV       ,&Interpreter::SV      ,&Interpreter::SV       ,
+    &Interpreter::CVT_S_D  ,&Interpreter::SV       ,&Interpreter::SV      ,&Interpreter::SV       ,&Interpreter::CVT_W_D  ,&Interpreter::CVT_L_D  ,&Interpreter::SV      ,&Interpreter::SV       ,
+    &Interpreter::SV       ,&Interpreter::SV       ,&Interpreter::SV      ,&Interpreter::SV       ,&Interpreter::SV       ,&Interpreter::SV       ,&Interpreter::SV      ,&Interpreter::SV       ,
+    &Interpreter::C_F_D    ,&Interpreter::C_UN_D   ,&Interpreter::C_EQ_D  ,&Interpreter::C_UEQ_D  ,&Interpreter::C_OLT_D  ,&Interpreter::C_ULT_D  ,&Interpreter::C_OLE_D ,&Interpreter::C_ULE_D  ,
+    &Interpreter::C_SF_D   ,&Interpreter::C_NGLE_D ,&Interpreter::C_SEQ_D ,&Interpreter::C_NGL_D  ,&Interpreter::C_LT_D   ,&Interpreter::C_NGE_D  ,&Interpreter::C_LE_D  ,&Interpreter::C_NGT_D
+}};
+
+const Interpreter::InstructionTable Interpreter::w_table =
+{{
+    &Interpreter::SV     ,&Interpreter::SV     ,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV, 
+    &Interpreter::SV     ,&Interpreter::SV     ,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV, 
+    &Interpreter::SV     ,&Interpreter::SV     ,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV, 
+    &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV,
+    &Interpreter::CVT_S_W, &Interpreter::CVT_D_W, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV,
+    &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV,
+    &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV,
+    &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV
+}};
+
+const Interpreter::InstructionTable Interpreter::l_table =
+{{
+    &Interpreter::SV     ,&Interpreter::SV     ,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV, 
+    &Interpreter::SV     ,&Interpreter::SV     ,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV, 
+    &Interpreter::SV     ,&Interpreter::SV     ,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV,&Interpreter::SV, 
+    &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV,
+    &Interpreter::CVT_S_L, &Interpreter::CVT_D_L, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV,
+    &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV,
+    &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV,
+    &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV, &Interpreter::SV
+}};
+
+// direct RDRAM access, only valid if IMemory::isDirectRDRAM
+static inline uint8_t* rdram_byte(uint32_t address)
+{
+    return (uint8_t*)Bus::rdram.mem + BES(address & (RDRAM_SIZE - 1));
+}
+
+static inline uint16_t* rdram_half(uint32_t address)
+{
+    return (uint16_t*)((uint8_t*)Bus::rdram.mem + HES(address & (RDRAM_SIZE - 2)));
+}
+
+static inline uint32_t* rdram_word(uint32_t address)
+{
+    return Bus::rdram.mem + ((address & (RDRAM_SIZE - 1)) >> 2);
+}
+
+static inline uint64_t rdram_read_dword(uint32_t address)
+{
+    return ((uint64_t)*rdram_word(address) << 32) | *rdram_word(address + 4);
+}
+
 
 
 bool Interpreter::initialize(Bus* bus)
@@ -120,10 +256,10 @@ void Interpreter::hardReset(void)
 
     Bus::state.cp0_reg[CP0_RANDOM_REG] = 0x1F;
     Bus::state.cp0_reg[CP0_STATUS_REG] = 0x34000000;
-    _cp1.setFPRPointers(*this, Bus::state.cp0_reg[CP0_STATUS_REG]);
     Bus::state.cp0_reg[CP0_CONFIG_REG] = 0x0006E463;
     Bus::state.cp0_reg[CP0_PREVID_REG] = 0xb00;
-    Bus::state.cp0_reg[CP0_COUNT_REG] = 0x5000;
+    Bus::state.cycles = 0;
+    _cp0.setCount(0x5000);
     Bus::state.cp0_reg[CP0_CAUSE_REG] = 0x0000005C;
     Bus::state.cp0_reg[CP0_CONTEXT_REG] = 0x007FFFF0;
     Bus::state.cp0_reg[CP0_EPC_REG] = 0xFFFFFFFF;
@@ -223,25 +359,41 @@ void Interpreter::softReset(void)
     _reg[31].u = 0xFFFFFFFFA4001550;
 }
 
-void Interpreter::execute(void)
+void Interpreter::beginExecution(void)
 {
-    LOG_INFO(Interpreter) << "Running...";
     _delay_slot = false;
     CoreControl::stop = false;
     Bus::state.skip_jump = 0;
 
     Bus::state.PC = Bus::state.last_jump_addr = 0xa4000040;
     Bus::state.next_interrupt = 624999;
+
+    // the host FPU mode is per thread, set it again on the first FPU op
+    _host_rounding = -1;
+
+    _skip_poll_loops = _bus->rom->getIdleSkip();
+    _poll.branch = 0;
     _bus->interrupt->initialize(_bus);
+}
+
+void Interpreter::execute(void)
+{
+    LOG_INFO(Interpreter) << "Running...";
+    beginExecution();
 
+#ifdef INTERPRETER_THREADED
+    runThreaded(UINT64_MAX);
+#else
     while (!CoreControl::stop)
     {
         prefetch();
 
         (this->*instruction_table[_cur_instr.op])();
     }
+#endif
 }
 
+template <uint8_t CountPerOp>
 void Interpreter::J(void)
 {
     // DECLARE_JUMP(J,   (PC->f.j.inst_index<<2) | ((PCADDR+4) & 0xF0000000), 1, &reg[0],  0, 0)
@@ -254,6 +406,9 @@ void Interpreter::J(void)
         );
 }
 
+INSTANTIATE_BRANCH(J)
+
+template <uint8_t CountPerOp>
 void Interpreter::JAL(void)
 {
     // DECLARE_JUMP(JAL, (PC->f.j.inst_index<<2) | ((PCADDR+4) & 0xF0000000), 1, &reg[31], 0, 0)
@@ -266,6 +421,9 @@ void Interpreter::JAL(void)
         );
 }
 
+INSTANTIATE_BRANCH(JAL)
+
+template <uint8_t CountPerOp>
 void Interpreter::BEQ(void)
 {
     //DECLARE_JUMP(BEQ, PCADDR + (iimmediate + 1) * 4, irs == irt, &reg[0], 0, 0)
@@ -278,6 +436,9 @@ void Interpreter::BEQ(void)
         );
 }
 
+INSTANTIATE_BRANCH(BEQ)
+
+template <uint8_t CountPerOp>
 void Interpreter::BNE(void)
 {
     // DECLARE_JUMP(BNE, PCADDR + (iimmediate+1)*4, irs != irt, &reg[0], 0, 0)
@@ -290,6 +451,9 @@ void Interpreter::BNE(void)
         );
 }
 
+INSTANTIATE_BRANCH(BNE)
+
+template <uint8_t CountPerOp>
 void Interpreter::BLEZ(void)
 {
     //DECLARE_JUMP(BLEZ,    PCADDR + (iimmediate+1)*4, irs <= 0,   &reg[0], 0, 0)
@@ -302,6 +466,9 @@ void Interpreter::BLEZ(void)
         );
 }
 
+INSTANTIATE_BRANCH(BLEZ)
+
+template <uint8_t CountPerOp>
 void Interpreter::BGTZ(void)
 {
     // DECLARE_JUMP(BGTZ, PCADDR + (iimmediate + 1) * 4, irs > 0, &reg[0], 0, 0)
@@ -314,6 +481,8 @@ void Interpreter::BGTZ(void)
         );
 }
 
+INSTANTIATE_BRANCH(BGTZ)
+
 void Interpreter::ADDI(void)
 {
     if (_cur_instr.rt)
@@ -399,6 +568,7 @@ void Interpreter::SV(void)
     LOG_ERROR(Interpreter) << "OP: " << std::hex << _cur_instr.code << "; Opcode " << _cur_instr.op << " reserved. Stopping...";
 }
 
+template <uint8_t CountPerOp>
 void Interpreter::BEQL(void)
 {
     //DECLARE_JUMP(BEQL, PCADDR + (iimmediate + 1) * 4, irs == irt, &reg[0], 1, 0)
@@ -411,6 +581,9 @@ void Interpreter::BEQL(void)
         );
 }
 
+INSTANTIATE_BRANCH(BEQL)
+
+template <uint8_t CountPerOp>
 void Interpreter::BNEL(void)
 {
     //DECLARE_JUMP(BNEL, PCADDR + (iimmediate + 1) * 4, irs != irt, &reg[0], 1, 0)
@@ -423,6 +596,9 @@ void Interpreter::BNEL(void)
         );
 }
 
+INSTANTIATE_BRANCH(BNEL)
+
+template <uint8_t CountPerOp>
 void Interpreter::BLEZL(void)
 {
     //DECLARE_JUMP(BLEZL,   PCADDR + (iimmediate+1)*4, irs <= 0,   &reg[0], 1, 0)
@@ -435,6 +611,9 @@ void Interpreter::BLEZL(void)
         );
 }
 
+INSTANTIATE_BRANCH(BLEZL)
+
+template <uint8_t CountPerOp>
 void Interpreter::BGTZL(void)
 {
     // DECLARE_JUMP(BGTZL,   PCADDR + (iimmediate+1)*4, irs > 0,    &reg[0], 1, 0)
@@ -447,6 +626,8 @@ void Interpreter::BGTZL(void)
         );
 }
 
+INSTANTIATE_BRANCH(BGTZL)
+
 void Interpreter::DADDI(void)
 {
     if (_cur_instr.rt)
@@ -509,11 +690,18 @@ void Interpreter::LB(void)
     {
         uint32_t addr = ((uint32_t)_reg[_cur_instr.base].u + signextend<int16_t, int32_t>(_cur_instr.offset));
 
-        _bus->mem->readmem(addr, &_reg[_cur_instr.rt].u, SIZE_BYTE);
-
-        if (addr)
+        if (_bus->mem->isDirectRDRAM(addr))
+        {
+            _reg[_cur_instr.rt].s = (int8_t)*rdram_byte(addr);
+        }
+        else
         {
-            _reg[_cur_instr.rt].s = signextend<int8_t, int64_t>((int8_t)_reg[_cur_instr.rt].s);
+            _bus->mem->readmem(addr, &_reg[_cur_instr.rt].u, SIZE_BYTE);
+
+            if (addr)
+            {
+                _reg[_cur_instr.rt].s = signextend<int8_t, int64_t>((int8_t)_reg[_cur_instr.rt].s);
+            }
         }
     }
 
@@ -526,11 +714,18 @@ void Interpreter::LH(void)
     {
         uint32_t addr = ((uint32_t)_reg[_cur_instr.base].u + signextend<int16_t, int32_t>(_cur_instr.offset));
 
-        _bus->mem->readmem(addr, &_reg[_cur_instr.rt].u, SIZE_HWORD);
-
-        if (addr)
+        if (_bus->mem->isDirectRDRAM(addr))
         {
-            _reg[_cur_instr.rt].s = signextend<int16_t, int64_t>((int16_t)_reg[_cur_instr.rt].s);
+            _reg[_cur_instr.rt].s = (int16_t)*rdram_half(addr);
+        }
+        else
+        {
+            _bus->mem->readmem(addr, &_reg[_cur_instr.rt].u, SIZE_HWORD);
+
+            if (addr)
+            {
+                _reg[_cur_instr.rt].s = signextend<int16_t, int64_t>((int16_t)_reg[_cur_instr.rt].s);
+            }
         }
     }
 
@@ -561,11 +756,18 @@ void Interpreter::LW(void)
     {
         uint32_t addr = ((uint32_t)_reg[_cur_instr.base].u + signextend<int16_t, int32_t>(_cur_instr.offset));
 
-        _bus->mem->readmem(addr, &_reg[_cur_instr.rt].u, SIZE_WORD);
-
-        if (addr)
+        if (_bus->mem->isDirectRDRAM(addr))
         {
-            _reg[_cur_instr.rt].s = signextend<int32_t, int64_t>((int32_t)_reg[_cur_instr.rt].s);
+            _reg[_cur_instr.rt].s = (int32_t)*rdram_word(addr);
+        }
+        else
+        {
+            _bus->mem->readmem(addr, &_reg[_cur_instr.rt].u, SIZE_WORD);
+
+            if (addr)
+            {
+                _reg[_cur_instr.rt].s = signextend<int32_t, int64_t>((int32_t)_reg[_cur_instr.rt].s);
+            }
         }
     }
 
@@ -577,8 +779,15 @@ void Interpreter::LBU(void)
     if (_cur_instr.rt)
     {
         uint32_t addr = ((uint32_t)_reg[_cur_instr.base].u + signextend<int16_t, int32_t>(_cur_instr.offset));
-	
-        _bus->mem->readmem(addr, &_reg[_cur_instr.rt].u, SIZE_BYTE);
+
+        if (_bus->mem->isDirectRDRAM(addr))
+        {
+            _reg[_cur_instr.rt].u = *rdram_byte(addr);
+        }
+        else
+        {
+            _bus->mem->readmem(addr, &_reg[_cur_instr.rt].u, SIZE_BYTE);
+        }
     }
 
     ++Bus::state.PC;
@@ -590,7 +799,14 @@ void Interpreter::LHU(void)
     {
         uint32_t addr = ((uint32_t)_reg[_cur_instr.base].u + signextend<int16_t, int32_t>(_cur_instr.offset));
 
-        _bus->mem->readmem(addr, &_reg[_cur_instr.rt].u, SIZE_HWORD);
+        if (_bus->mem->isDirectRDRAM(addr))
+        {
+            _reg[_cur_instr.rt].u = *rdram_half(addr);
+        }
+        else
+        {
+            _bus->mem->readmem(addr, &_reg[_cur_instr.rt].u, SIZE_HWORD);
+        }
     }
 
     ++Bus::state.PC;
@@ -619,7 +835,14 @@ void Interpreter::LWU(void)
     {
         uint32_t addr = ((uint32_t)_reg[_cur_instr.base].u + signextend<int16_t, int32_t>(_cur_instr.offset));
 
-        _bus->mem->readmem(addr, &_reg[_cur_instr.rt].u, SIZE_WORD);
+        if (_bus->mem->isDirectRDRAM(addr))
+        {
+            _reg[_cur_instr.rt].u = *rdram_word(addr);
+        }
+        else
+        {
+            _bus->mem->readmem(addr, &_reg[_cur_instr.rt].u, SIZE_WORD);
+        }
     }
 
     ++Bus::state.PC;
@@ -627,14 +850,34 @@ void Interpreter::LWU(void)
 
 void Interpreter::SB(void)
 {
-    _bus->mem->writemem(((uint32_t)_reg[_cur_instr.base].u + signextend<int16_t, int32_t>(_cur_instr.offset)), (uint8_t)(_reg[_cur_instr.rt].u & 0xFF), SIZE_BYTE);
+    uint32_t addr = ((uint32_t)_reg[_cur_instr.base].u + signextend<int16_t, int32_t>(_cur_instr.offset));
+
+    if (_bus->mem->isDirectRDRAM(addr))
+    {
+        *rdram_byte(addr) = (uint8_t)_reg[_cur_instr.rt].u;
+        invalidateCode(addr);
+    }
+    else
+    {
+        _bus->mem->writemem(addr, (uint8_t)(_reg[_cur_instr.rt].u & 0xFF), SIZE_BYTE);
+    }
 
     ++Bus::state.PC;
 }
 
 void Interpreter::SH(void)
 {
-    _bus->mem->writemem(((uint32_t)_reg[_cur_instr.base].u + signextend<int16_t, int32_t>(_cur_instr.offset)), (uint16_t)(_reg[_cur_instr.rt].u & 0xFFFF), SIZE_HWORD);
+    uint32_t addr = ((uint32_t)_reg[_cur_instr.base].u + signextend<int16_t, int32_t>(_cur_instr.offset));
+
+    if (_bus->mem->isDirectRDRAM(addr))
+    {
+        *rdram_half(addr) = (uint16_t)_reg[_cur_instr.rt].u;
+        invalidateCode(addr);
+    }
+    else
+    {
+        _bus->mem->writemem(addr, (uint16_t)(_reg[_cur_instr.rt].u & 0xFFFF), SIZE_HWORD);
+    }
 
     ++Bus::state.PC;
 }
@@ -660,7 +903,17 @@ void Interpreter::SWL(void)
 
 void Interpreter::SW(void)
 {
-    _bus->mem->writemem(((uint32_t)_reg[_cur_instr.base].u + signextend<int16_t, int32_t>(_cur_instr.offset)), (uint32_t)(_reg[_cur_instr.rt].u & 0xFFFFFFFF), SIZE_WORD);
+    uint32_t addr = ((uint32_t)_reg[_cur_instr.base].u + signextend<int16_t, int32_t>(_cur_instr.offset));
+
+    if (_bus->mem->isDirectRDRAM(addr))
+    {
+        *rdram_word(addr) = (uint32_t)_reg[_cur_instr.rt].u;
+        invalidateCode(addr);
+    }
+    else
+    {
+        _bus->mem->writemem(addr, (uint32_t)(_reg[_cur_instr.rt].u & 0xFFFFFFFF), SIZE_WORD);
+    }
 
     ++Bus::state.PC;
 }
@@ -696,6 +949,17 @@ void Interpreter::SWR(void)
 
 void Interpreter::CACHE(void)
 {
+    // primary instruction cache ops are issued after new code is loaded
+    if ((_cur_instr.rt & 0x03) == 0)
+    {
+        uint32_t addr = ((uint32_t)_reg[_cur_instr.base].u + signextend<int16_t, int32_t>(_cur_instr.offset));
+
+        if ((addr & 0xc0000000) == 0x80000000 && (addr & 0x1fffffff) < RDRAM_SIZE)
+        {
+            invalidateCode(addr & 0x1fffffe0, 32);
+        }
+    }
+
     ++Bus::state.PC;
 }
 
@@ -704,6 +968,7 @@ void Interpreter::LL(void)
     NOT_IMPLEMENTED();
 }
 
+template <bool FR>
 void Interpreter::LWC1(void)
 {
     if (_cp0.COP1Unusable(*this))
@@ -712,21 +977,31 @@ void Interpreter::LWC1(void)
     uint32_t address = ((uint32_t)_reg[_cur_instr.base].u + signextend<int16_t, int32_t>(_cur_instr.offset));
     uint64_t dest = 0;
 
-    _bus->mem->readmem(address, &dest, SIZE_WORD);
+    if (_bus->mem->isDirectRDRAM(address))
+    {
+        dest = *rdram_word(address);
+    }
+    else
+    {
+        _bus->mem->readmem(address, &dest, SIZE_WORD);
+    }
 
     if (address)
     {
-        *((int32_t*)_s_reg[_cur_instr.ft]) = (int32_t)dest;
+        *((int32_t*)fprS<FR>(_cur_instr.ft)) = (int32_t)dest;
     }
 
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(LWC1)
+
 void Interpreter::LLD(void)
 {
     NOT_IMPLEMENTED();
 }
 
+template <bool FR>
 void Interpreter::LDC1(void)
 {
     if (_cp0.COP1Unusable(*this))
@@ -734,18 +1009,34 @@ void Interpreter::LDC1(void)
 
     uint32_t address = ((uint32_t)_reg[_cur_instr.base].u + signextend<int16_t, int32_t>(_cur_instr.offset));
 
-    _bus->mem->readmem(address, (uint64_t*)_d_reg[_cur_instr.ft], SIZE_DWORD);
+    if (_bus->mem->isDirectRDRAM(address))
+    {
+        *((uint64_t*)fprD<FR>(_cur_instr.ft)) = rdram_read_dword(address);
+    }
+    else
+    {
+        _bus->mem->readmem(address, (uint64_t*)fprD<FR>(_cur_instr.ft), SIZE_DWORD);
+    }
 
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(LDC1)
+
 void Interpreter::LD(void)
 {
     if (_cur_instr.rt)
     {
         uint32_t addr = ((uint32_t)_reg[_cur_instr.base].u + signextend<int16_t, int32_t>(_cur_instr.offset));
 
-        _bus->mem->readmem(addr, &_reg[_cur_instr.rt].u, SIZE_DWORD);
+        if (_bus->mem->isDirectRDRAM(addr))
+        {
+            _reg[_cur_instr.rt].u = rdram_read_dword(addr);
+        }
+        else
+        {
+            _bus->mem->readmem(addr, &_reg[_cur_instr.rt].u, SIZE_DWORD);
+        }
     }
 
     ++Bus::state.PC;
@@ -756,63 +1047,425 @@ void Interpreter::SC(void)
     NOT_IMPLEMENTED();
 }
 
+template <bool FR>
 void Interpreter::SWC1(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    _bus->mem->writemem(((uint32_t)_reg[_cur_instr.base].u + signextend<int16_t, int32_t>(_cur_instr.offset)), *((int32_t*)_s_reg[_cur_instr.ft]), SIZE_WORD);
+    uint32_t addr = ((uint32_t)_reg[_cur_instr.base].u + signextend<int16_t, int32_t>(_cur_instr.offset));
+
+    if (_bus->mem->isDirectRDRAM(addr))
+    {
+        *rdram_word(addr) = *((uint32_t*)fprS<FR>(_cur_instr.ft));
+        invalidateCode(addr);
+    }
+    else
+    {
+        _bus->mem->writemem(addr, *((int32_t*)fprS<FR>(_cur_instr.ft)), SIZE_WORD);
+    }
 
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(SWC1)
+
 void Interpreter::SCD(void)
 {
     NOT_IMPLEMENTED();
 }
 
+template <bool FR>
 void Interpreter::SDC1(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    _bus->mem->writemem(((uint32_t)_reg[_cur_instr.base].u + signextend<int16_t, int32_t>(_cur_instr.offset)), *((int64_t*)_d_reg[_cur_instr.ft]), SIZE_DWORD);
+    uint32_t addr = ((uint32_t)_reg[_cur_instr.base].u + signextend<int16_t, int32_t>(_cur_instr.offset));
+
+    if (_bus->mem->isDirectRDRAM(addr))
+    {
+        uint64_t value = *((uint64_t*)fprD<FR>(_cur_instr.ft));
+
+        *rdram_word(addr) = (uint32_t)(value >> 32);
+        *rdram_word(addr + 4) = (uint32_t)value;
+        invalidateCode(addr, 8);
+    }
+    else
+    {
+        _bus->mem->writemem(addr, *((int64_t*)fprD<FR>(_cur_instr.ft)), SIZE_DWORD);
+    }
 
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(SDC1)
+
 void Interpreter::SD(void)
 {
-    _bus->mem->writemem(((uint32_t)_reg[_cur_instr.base].u + signextend<int16_t, int32_t>(_cur_instr.offset)), _reg[_cur_instr.rt].u, SIZE_DWORD);
+    uint32_t addr = ((uint32_t)_reg[_cur_instr.base].u + signextend<int16_t, int32_t>(_cur_instr.offset));
+
+    if (_bus->mem->isDirectRDRAM(addr))
+    {
+        *rdram_word(addr) = (uint32_t)(_reg[_cur_instr.rt].u >> 32);
+        *rdram_word(addr + 4) = (uint32_t)_reg[_cur_instr.rt].u;
+        invalidateCode(addr, 8);
+    }
+    else
+    {
+        _bus->mem->writemem(addr, _reg[_cur_instr.rt].u, SIZE_DWORD);
+    }
 
     ++Bus::state.PC;
 }
 
+template <uint8_t CountPerOp>
 void Interpreter::genericIdle(uint32_t destination, bool take_jump, Register64* link, bool likely, bool cop1)
 {
-    int32_t skip;
+    int64_t skip;
     if (cop1 && _cp0.COP1Unusable(*this))
         return;
 
     if (take_jump)
     {
-        _cp0.updateCount(Bus::state.PC, _bus->rom->getCountPerOp());
-        skip = Bus::state.next_interrupt - Bus::state.cp0_reg[CP0_COUNT_REG];
+        _cp0.updateCount(Bus::state.PC, countPerOp<CountPerOp>());
+        skip = (int64_t)(Bus::state.next_interrupt - Bus::state.cycles);
         if (skip > 3)
         {
-            Bus::state.cp0_reg[CP0_COUNT_REG] += (skip & 0xFFFFFFFC);
+            _cp0.addCycles(skip & ~3LL);
         }
         else
         {
-            genericJump(destination, take_jump, link, likely, cop1);
+            genericJump<CountPerOp>(destination, take_jump, link, likely, cop1);
         }
     }
     else
     {
-        genericJump(destination, take_jump, link, likely, cop1);
+        genericJump<CountPerOp>(destination, take_jump, link, likely, cop1);
+    }
+}
+
+template void Interpreter::genericIdle<0>(uint32_t, bool, Register64*, bool, bool);
+template void Interpreter::genericIdle<1>(uint32_t, bool, Register64*, bool, bool);
+template void Interpreter::genericIdle<2>(uint32_t, bool, Register64*, bool, bool);
+template void Interpreter::genericIdle<3>(uint32_t, bool, Register64*, bool, bool);
+template void Interpreter::genericIdle<4>(uint32_t, bool, Register64*, bool, bool);
+
+template <uint8_t CountPerOp>
+void Interpreter::pollingJump(uint32_t destination, Register64* link, bool likely, bool cop1)
+{
+    uint32_t branch = (uint32_t)Bus::state.PC;
+    uint64_t next_interrupt = Bus::state.next_interrupt;
+
+    genericJump<CountPerOp>(destination, true, link, likely, cop1);
+
+    // an event on the way back may have changed what the loop reads
+    if ((uint32_t)Bus::state.PC != destination || Bus::state.next_interrupt != next_interrupt)
+    {
+        _poll.branch = 0;
+        return;
+    }
+
+    // counted from the loop start to the end of the delay slot
+    uint64_t iteration = (uint64_t)((branch - destination) / 4 + 2) * countPerOp<CountPerOp>();
+
+    if (branch != _poll.branch || Bus::state.cycles - _poll.cycles != iteration)
+    {
+        _poll.branch = branch;
+        _poll.candidate = isPollingLoop(destination, branch);
+        _poll.repeats = 0;
+    }
+    else if (_poll.candidate)
+    {
+        // nothing but an event changes memory the loop reads, so once its
+        // registers come back unchanged every further iteration is the same
+        if (memcmp(_poll.regs, _reg, sizeof(_poll.regs)))
+        {
+            _poll.repeats = 0;
+        }
+        else if (++_poll.repeats >= POLL_LOOP_REPEATS)
+        {
+            uint64_t skip;
+
+            if (pollingLoopSkip(destination, branch, iteration, &skip))
+            {
+                _cp0.addCycles(skip * iteration);
+            }
+            else
+            {
+                _poll.candidate = false;
+            }
+        }
+    }
+
+    if (_poll.candidate)
+    {
+        memcpy(_poll.regs, _reg, sizeof(_poll.regs));
+    }
+
+    _poll.cycles = Bus::state.cycles;
+}
+
+template void Interpreter::pollingJump<0>(uint32_t, Register64*, bool, bool);
+template void Interpreter::pollingJump<1>(uint32_t, Register64*, bool, bool);
+template void Interpreter::pollingJump<2>(uint32_t, Register64*, bool, bool);
+template void Interpreter::pollingJump<3>(uint32_t, Register64*, bool, bool);
+template void Interpreter::pollingJump<4>(uint32_t, Register64*, bool, bool);
+
+bool Interpreter::isPollingLoop(uint32_t start, uint32_t branch)
+{
+    // the body and delay slot may only load, compute and branch out of the loop
+    for (uint32_t pc = start; pc != branch + 8; pc += 4)
+    {
+        if (pc == branch)
+        {
+            continue;
+        }
+
+        uint32_t* mem = _bus->mem->fetch(pc);
+
+        if (nullptr == mem)
+        {
+            return false;
+        }
+
+        Instruction instr;
+        instr.code = *mem;
+
+        switch (instr.op)
+        {
+        case 0: // SPECIAL
+            switch (instr.func)
+            {
+            case 0: // SLL
+            case 2: // SRL
+            case 3: // SRA
+            case 4: // SLLV
+            case 6: // SRLV
+            case 7: // SRAV
+            case 33: // ADDU
+            case 35: // SUBU
+            case 36: // AND
+            case 37: // OR
+            case 38: // XOR
+            case 39: // NOR
+            case 42: // SLT
+            case 43: // SLTU
+                break;
+            default:
+                return false;
+            }
+            break;
+
+        case 4: // BEQ
+        case 5: // BNE
+        case 6: // BLEZ
+        case 7: // BGTZ
+        {
+            uint32_t target = pc + 4 + (signextend<int16_t, int32_t>(instr.immediate) << 2);
+
+            // exits only, with their delay slot inside the loop
+            if (pc + 4 >= branch || (target >= start && target <= branch + 4))
+            {
+                return false;
+            }
+            break;
+        }
+
+        case 9: // ADDIU
+        case 10: // SLTI
+        case 11: // SLTIU
+        case 12: // ANDI
+        case 13: // ORI
+        case 14: // XORI
+        case 15: // LUI
+        case 32: // LB
+        case 33: // LH
+        case 35: // LW
+        case 36: // LBU
+        case 37: // LHU
+        case 39: // LWU
+        case 55: // LD
+            break;
+
+        default:
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// registers that only change when an event is processed
+static bool isEventRegister(uint32_t address)
+{
+    switch (address >> 16)
+    {
+    case 0x0404:
+        return Bus::rcp.sp.dma_done == 0 &&
+            (RSP_REG(address) == SP_STATUS_REG || RSP_REG(address) == SP_DMA_FULL_REG || RSP_REG(address) == SP_DMA_BUSY_REG);
+    case 0x0410:
+        return DPC_REG(address) == DPC_STATUS_REG;
+    case 0x0430:
+        return MI_REG(address) == MI_INTR_REG || MI_REG(address) == MI_INTR_MASK_REG;
+    case 0x0460:
+        return PI_REG(address) == PI_STATUS_REG;
+    case 0x0480:
+        return SI_REG(address) == SI_STATUS_REG;
+    }
+
+    return false;
+}
+
+bool Interpreter::pollingLoopSkip(uint32_t start, uint32_t branch, uint64_t iteration, uint64_t* skip)
+{
+    // whole iterations, the one that reaches the event is run
+    *skip = (Bus::state.next_interrupt > Bus::state.cycles) ? (Bus::state.next_interrupt - Bus::state.cycles - 1) / iteration : 0;
+
+    // follow the registers as far as the load addresses need them
+    uint64_t value[32];
+    uint32_t known = ~0u;
+
+    for (uint32_t i = 0; i < 32; i++)
+    {
+        value[i] = _reg[i].u;
     }
+
+    for (uint32_t pc = start; pc != branch + 8; pc += 4)
+    {
+        if (pc == branch)
+        {
+            continue;
+        }
+
+        Instruction instr;
+        instr.code = *_bus->mem->fetch(pc);
+
+        uint64_t rs = value[instr.rs];
+        uint64_t imm = (uint64_t)signextend<int16_t, int64_t>(instr.immediate);
+        bool valid = ((known >> instr.rs) & 1) != 0;
+        uint32_t dest = instr.rt;
+        uint32_t size = 0;
+
+        switch (instr.op)
+        {
+        case 0: // SPECIAL
+            dest = instr.rd;
+            valid = valid && ((known >> instr.rt) & 1) != 0;
+
+            if (instr.func == 33) // ADDU
+            {
+                rs = (uint64_t)signextend<int32_t, int64_t>((int32_t)(rs + value[instr.rt]));
+            }
+            else if (instr.func == 37) // OR
+            {
+                rs |= value[instr.rt];
+            }
+            else
+            {
+                valid = false;
+            }
+            break;
+
+        case 4: // BEQ
+        case 5: // BNE
+        case 6: // BLEZ
+        case 7: // BGTZ
+            dest = 0;
+            break;
+
+        case 9: // ADDIU
+            rs = (uint64_t)signextend<int32_t, int64_t>((int32_t)(rs + imm));
+            break;
+
+        case 13: // ORI
+            rs |= instr.immediate;
+            break;
+
+        case 15: // LUI
+            rs = (uint64_t)signextend<int32_t, int64_t>((int32_t)(instr.immediate << 16));
+            valid = true;
+            break;
+
+        case 32: // LB
+        case 36: // LBU
+            size = 1;
+            break;
+
+        case 33: // LH
+        case 37: // LHU
+            size = 2;
+            break;
+
+        case 35: // LW
+        case 39: // LWU
+            size = 4;
+            break;
+
+        case 55: // LD
+            size = 8;
+            break;
+
+        default:
+            valid = false;
+            break;
+        }
+
+        if (size != 0)
+        {
+            uint32_t address = (uint32_t)(rs + imm);
+
+            if (!valid || (address & (size - 1)))
+            {
+                return false;
+            }
+
+            if ((address & 0xc0000000) != 0x80000000)
+            {
+                if (!(address = TLB::virtual_to_physical_address(_bus, address, TLB_FAST_READ)))
+                {
+                    return false;
+                }
+            }
+
+            address &= 0x1fffffff;
+
+            if ((address >> 16) == 0x0440 && VI_REG(address) == VI_CURRENT_REG)
+            {
+                // the line moves on by itself, stop before any load would see the next one
+                uint64_t offset = (uint64_t)((pc - start) / 4) * _bus->rom->getCountPerOp();
+                uint64_t seen = Bus::state.cycles - iteration + offset;
+                uint64_t line = (uint32_t)(Bus::state.vi_delay - (uint32_t)(Bus::state.next_vi - seen));
+                uint64_t rate = CoreControl::VIRefreshRate;
+                uint64_t first = Bus::state.cycles + offset;
+
+                if (rate == 0)
+                {
+                    return false;
+                }
+
+                uint64_t change = seen + std::min<uint64_t>((line / rate / 2 + 1) * 2 * rate, 0x100000000ULL) - line;
+                *skip = (change <= first) ? 0 : std::min(*skip, (change - first - 1) / iteration + 1);
+            }
+            else if (address >= RDRAM_SIZE && !isEventRegister(address))
+            {
+                return false;
+            }
+
+            valid = false;
+        }
+
+        if (dest != 0)
+        {
+            value[dest] = rs;
+            known = valid ? (known | (1u << dest)) : (known & ~(1u << dest));
+        }
+    }
+
+    return true;
 }
 
+template <uint8_t CountPerOp>
 void Interpreter::genericJump(uint32_t destination, bool take_jump, Register64* link, bool likely, bool cop1)
 {
     if (cop1 && _cp0.COP1Unusable(*this))
@@ -829,10 +1482,9 @@ void Interpreter::genericJump(uint32_t destination, bool take_jump, Register64*
         Bus::state.PC += 1;
         _delay_slot = true;
 
-        prefetch();
-        (this->*instruction_table[_cur_instr.op])();
+        executeDelaySlot();
 
-        _cp0.updateCount(Bus::state.PC, _bus->rom->getCountPerOp());
+        _cp0.updateCount(Bus::state.PC, countPerOp<CountPerOp>());
         _delay_slot = false;
         if (take_jump && !Bus::state.skip_jump)
         {
@@ -842,16 +1494,28 @@ void Interpreter::genericJump(uint32_t destination, bool take_jump, Register64*
     else
     {
         Bus::state.PC += 2;
-        _cp0.updateCount(Bus::state.PC, _bus->rom->getCountPerOp());
+        _cp0.updateCount(Bus::state.PC, countPerOp<CountPerOp>());
     }
 
     Bus::state.last_jump_addr = (uint32_t)Bus::state.PC;
-    if (Bus::state.next_interrupt <= Bus::state.cp0_reg[CP0_COUNT_REG])
+    if (Bus::state.next_interrupt <= Bus::state.cycles)
     {
         _bus->interrupt->generateInterrupt();
     }
 }
 
+template void Interpreter::genericJump<0>(uint32_t, bool, Register64*, bool, bool);
+template void Interpreter::genericJump<1>(uint32_t, bool, Register64*, bool, bool);
+template void Interpreter::genericJump<2>(uint32_t, bool, Register64*, bool, bool);
+template void Interpreter::genericJump<3>(uint32_t, bool, Register64*, bool, bool);
+template void Interpreter::genericJump<4>(uint32_t, bool, Register64*, bool, bool);
+
+void Interpreter::executeDelaySlot(void)
+{
+    prefetch();
+    (this->*instruction_table[_cur_instr.op])();
+}
+
 void Interpreter::globalJump(uint32_t addr)
 {
     Bus::state.PC = addr;
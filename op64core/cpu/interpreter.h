@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <array>
 #include <cstdint>
 
 #include <oplog.h>
@@ -21,10 +22,50 @@
 #define DO_JUMP(target, condition, link, likely, cop1) \
     if (target == ((uint32_t)Bus::state.PC) && _check_nop) \
     { \
-        genericIdle(target, condition, link, likely, cop1); \
+        genericIdle<CountPerOp>(target, condition, link, likely, cop1); \
         return; \
     } \
-    genericJump(target, condition, link, likely, cop1);
+    if ((condition) && _skip_poll_loops && (target) <= ((uint32_t)Bus::state.PC) && ((uint32_t)Bus::state.PC) - (target) < POLL_LOOP_BYTES) \
+    { \
+        pollingJump<CountPerOp>(target, link, likely, cop1); \
+        return; \
+    } \
+    genericJump<CountPerOp>(target, condition, link, likely, cop1);
+
+// branches are built for each count per op, 0 reads it from the ROM
+#define INSTANTIATE_BRANCH(name) \
+    template void Interpreter::name<0>(void); \
+    template void Interpreter::name<1>(void); \
+    template void Interpreter::name<2>(void); \
+    template void Interpreter::name<3>(void); \
+    template void Interpreter::name<4>(void);
+
+// FPR accesses are built for each setting of Status.FR, the plain handler
+// used by the decode tables picks one from Status
+#define INSTANTIATE_FPR(name) \
+    template void Interpreter::name<false>(void); \
+    template void Interpreter::name<true>(void); \
+    void Interpreter::name(void) \
+    { \
+        if (fr()) \
+        { \
+            name<true>(); \
+        } \
+        else \
+        { \
+            name<false>(); \
+        } \
+    }
+
+// backward branches over at most this many bytes are checked for polling loops,
+// which are skipped once they came back this often without a change
+#define POLL_LOOP_BYTES 64
+#define POLL_LOOP_REPEATS 3
+
+// labels as values give a dispatch loop with one indirect jump per instruction
+#if defined(__GNUC__) || defined(__clang__)
+#define INTERPRETER_THREADED
+#endif
 
 
 class Interpreter : public ICPU
@@ -50,7 +91,7 @@ public:
     virtual void generalException(void);
     virtual void TLBRefillException(unsigned int address, TLBProbeMode mode, bool miss);
 
-private:
+protected:
     inline void prefetch(void)
     {
         uint32_t* mem = _bus->mem->fetch(Bus::state.PC);
@@ -68,231 +109,489 @@ private:
         _cur_instr.code = mem[0];
     }
 
-private:
+    // reset execution state before entering the run loop
+    void beginExecution(void);
+
+#ifdef INTERPRETER_THREADED
+    // runs until stopped or the cycle count reaches end, see interpreter_threaded.cpp
+    void runThreaded(uint64_t end);
+
+    // dispatch loop specialized for the ROM's count per op and Status.FR,
+    // returns early when FR changes
+    template <uint8_t CountPerOp, bool FR>
+    void runVariant(uint64_t end);
+#endif
+
+    // count per op for a branch built with CountPerOp, 0 takes it from the ROM
+    template <uint8_t CountPerOp>
+    inline uint8_t countPerOp(void)
+    {
+        return CountPerOp ? CountPerOp : _bus->rom->getCountPerOp();
+    }
+
+    inline bool fr(void)
+    {
+        return (Bus::state.cp0_reg[CP0_STATUS_REG] & 0x04000000) != 0;
+    }
+
+    // FPRs as seen with the given FR, with FR clear the odd registers are
+    // the upper halves of the even ones
+    template <bool FR>
+    inline float* fprS(uint32_t index)
+    {
+        return FR ? (float*)&_fgr[index] + IS_BIG_ENDIAN : (float*)&_fgr[index >> 1] + ((index & 1) ^ IS_BIG_ENDIAN);
+    }
+
+    template <bool FR>
+    inline double* fprD(uint32_t index)
+    {
+        return (double*)&_fgr[FR ? index : index >> 1];
+    }
+
+    // sets the host rounding mode if it is not already in effect
+    void useRounding(int32_t mode);
+
     // cpu states
     bool _check_nop = false;
+
+    // skip polling loops to the next event, per ROM
+    bool _skip_poll_loops = true;
+
+private:
     bool _non_ieee_mode = true; // for testing
 
+    // the short loop last branched back through and how often it came
+    // back with all registers unchanged
+    struct PollingLoop
+    {
+        uint32_t branch = 0;
+        bool candidate = false;
+        uint32_t repeats = 0;
+        uint64_t cycles = 0;
+        uint64_t regs[32];
+    } _poll;
+
 protected:
 
+    template <uint8_t CountPerOp>
     void genericJump(uint32_t destination, bool take_jump, Register64* link, bool likely, bool cop1);
+    template <uint8_t CountPerOp>
     void genericIdle(uint32_t destination, bool take_jump, Register64* link, bool likely, bool cop1);
 
-    virtual void J(void);
-    virtual void JAL(void);
-    virtual void BEQ(void);
-    virtual void BNE(void);
-    virtual void BLEZ(void);
-    virtual void BGTZ(void);
-    virtual void ADDI(void);
-    virtual void ADDIU(void);
-    virtual void SLTI(void);
-    virtual void SLTIU(void);
-    virtual void ANDI(void);
-    virtual void ORI(void);
-    virtual void XORI(void);
-    virtual void LUI(void);
-    virtual void SV(void);
-    virtual void BEQL(void);
-    virtual void BNEL(void);
-    virtual void BLEZL(void);
-    virtual void BGTZL(void);
-    virtual void DADDI(void);
-    virtual void DADDIU(void);
-    virtual void LDL(void);
-    virtual void LDR(void);
-    virtual void LB(void);
-    virtual void LH(void);
-    virtual void LWL(void);
-    virtual void LW(void);
-    virtual void LBU(void);
-    virtual void LHU(void);
-    virtual void LWR(void);
-    virtual void LWU(void);
-    virtual void SB(void);
-    virtual void SH(void);
-    virtual void SWL(void);
-    virtual void SW(void);
-    virtual void SDL(void);
-    virtual void SDR(void);
-    virtual void SWR(void);
-    virtual void CACHE(void);
-    virtual void LL(void);
-    virtual void LWC1(void);
-    virtual void LLD(void);
-    virtual void LDC1(void);
-    virtual void LD(void);
-    virtual void SC(void);
-    virtual void SWC1(void);
-    virtual void SCD(void);
-    virtual void SDC1(void);
-    virtual void SD(void);
-
-    virtual void SLL(void);
-    virtual void SRL(void);
-    virtual void SRA(void);
-    virtual void SLLV(void);
-    virtual void SRLV(void);
-    virtual void SRAV(void);
-    virtual void JR(void);
-    virtual void JALR(void);
-    virtual void SYSCALL(void);
-    virtual void BREAK(void);
-    virtual void SYNC(void);
-    virtual void MFHI(void);
-    virtual void MTHI(void);
-    virtual void MFLO(void);
-    virtual void MTLO(void);
-    virtual void DSLLV(void);
-    virtual void DSRLV(void);
-    virtual void DSRAV(void);
-    virtual void MULT(void);
-    virtual void MULTU(void);
-    virtual void DIV(void);
-    virtual void DIVU(void);
-    virtual void DMULT(void);
-    virtual void DMULTU(void);
-    virtual void DDIV(void);
-    virtual void DDIVU(void);
-    virtual void ADD(void);
-    virtual void ADDU(void);
-    virtual void SUB(void);
-    virtual void SUBU(void);
-    virtual void AND(void);
-    virtual void OR(void);
-    virtual void XOR(void);
-    virtual void NOR(void);
-    virtual void SLT(void);
-    virtual void SLTU(void);
-    virtual void DADD(void);
-    virtual void DADDU(void);
-    virtual void DSUB(void);
-    virtual void DSUBU(void);
-    virtual void TGE(void);
-    virtual void TGEU(void);
-    virtual void TLT(void);
-    virtual void TLTU(void);
-    virtual void TEQ(void);
-    virtual void TNE(void);
-    virtual void DSLL(void);
-    virtual void DSRL(void);
-    virtual void DSRA(void);
-    virtual void DSLL32(void);
-    virtual void DSRL32(void);
-    virtual void DSRA32(void);
-
-    virtual void BLTZ(void);
-    virtual void BGEZ(void);
-    virtual void BLTZL(void);
-    virtual void BGEZL(void);
-    virtual void TGEI(void);
-    virtual void TGEIU(void);
-    virtual void TLTI(void);
-    virtual void TLTIU(void);
-    virtual void TEQI(void);
-    virtual void TNEI(void);
-    virtual void BLTZAL(void);
-    virtual void BGEZAL(void);
-    virtual void BLTZALL(void);
-    virtual void BGEZALL(void);
-
-    virtual void MFC0(void);
-    virtual void MTC0(void);
-
-    virtual void MFC1(void);
-    virtual void DMFC1(void);
-    virtual void CFC1(void);
-    virtual void MTC1(void);
-    virtual void DMTC1(void);
-    virtual void CTC1(void);
-
-    virtual void TLBR(void);
-    virtual void TLBWI(void);
-    virtual void TLBWR(void);
-    virtual void TLBP(void);
-    virtual void ERET(void);
-
-    virtual void BC1F(void);
-    virtual void BC1T(void);
-    virtual void BC1FL(void);
-    virtual void BC1TL(void);
-
-    virtual void ADD_S(void);
-    virtual void SUB_S(void);
-    virtual void MUL_S(void);
-    virtual void DIV_S(void);
-    virtual void SQRT_S(void);
-    virtual void ABS_S(void);
-    virtual void MOV_S(void);
-    virtual void NEG_S(void);
-    virtual void ROUND_L_S(void);
-    virtual void TRUNC_L_S(void);
-    virtual void CEIL_L_S(void);
-    virtual void FLOOR_L_S(void);
-    virtual void ROUND_W_S(void);
-    virtual void TRUNC_W_S(void);
-    virtual void CEIL_W_S(void);
-    virtual void FLOOR_W_S(void);
-    virtual void CVT_D_S(void);
-    virtual void CVT_W_S(void);
-    virtual void CVT_L_S(void);
-    virtual void C_F_S(void);
-    virtual void C_UN_S(void);
-    virtual void C_EQ_S(void);
-    virtual void C_UEQ_S(void);
-    virtual void C_OLT_S(void);
-    virtual void C_ULT_S(void);
-    virtual void C_OLE_S(void);
-    virtual void C_ULE_S(void);
-    virtual void C_SF_S(void);
-    virtual void C_NGLE_S(void);
-    virtual void C_SEQ_S(void);
-    virtual void C_NGL_S(void);
-    virtual void C_LT_S(void);
-    virtual void C_NGE_S(void);
-    virtual void C_LE_S(void);
-    virtual void C_NGT_S(void);
-
-    virtual void ADD_D(void);
-    virtual void SUB_D(void);
-    virtual void MUL_D(void);
-    virtual void DIV_D(void);
-    virtual void SQRT_D(void);
-    virtual void ABS_D(void);
-    virtual void MOV_D(void);
-    virtual void NEG_D(void);
-    virtual void ROUND_L_D(void);
-    virtual void TRUNC_L_D(void);
-    virtual void CEIL_L_D(void);
-    virtual void FLOOR_L_D(void);
-    virtual void ROUND_W_D(void);
-    virtual void TRUNC_W_D(void);
-    virtual void CEIL_W_D(void);
-    virtual void FLOOR_W_D(void);
-    virtual void CVT_S_D(void);
-    virtual void CVT_W_D(void);
-    virtual void CVT_L_D(void);
-    virtual void C_F_D(void);
-    virtual void C_UN_D(void);
-    virtual void C_EQ_D(void);
-    virtual void C_UEQ_D(void);
-    virtual void C_OLT_D(void);
-    virtual void C_ULT_D(void);
-    virtual void C_OLE_D(void);
-    virtual void C_ULE_D(void);
-    virtual void C_SF_D(void);
-    virtual void C_NGLE_D(void);
-    virtual void C_SEQ_D(void);
-    virtual void C_NGL_D(void);
-    virtual void C_LT_D(void);
-    virtual void C_NGE_D(void);
-    virtual void C_LE_D(void);
-    virtual void C_NGT_D(void);
-
-    virtual void CVT_S_W(void);
-    virtual void CVT_D_W(void);
-
-    virtual void CVT_D_L(void);
-    virtual void CVT_S_L(void);
+    // taken short backward branch, fast forwards once the loop is seen polling
+    template <uint8_t CountPerOp>
+    void pollingJump(uint32_t destination, Register64* link, bool likely, bool cop1);
+    bool isPollingLoop(uint32_t start, uint32_t branch);
+    bool pollingLoopSkip(uint32_t start, uint32_t branch, uint64_t iteration, uint64_t* skip);
+
+    // fetch and run the instruction following a branch
+    virtual void executeDelaySlot(void);
+
+    template <uint8_t CountPerOp = 0>
+    void J(void);
+    template <uint8_t CountPerOp = 0>
+    void JAL(void);
+    template <uint8_t CountPerOp = 0>
+    void BEQ(void);
+    template <uint8_t CountPerOp = 0>
+    void BNE(void);
+    template <uint8_t CountPerOp = 0>
+    void BLEZ(void);
+    template <uint8_t CountPerOp = 0>
+    void BGTZ(void);
+    void ADDI(void);
+    void ADDIU(void);
+    void SLTI(void);
+    void SLTIU(void);
+    void ANDI(void);
+    void ORI(void);
+    void XORI(void);
+    void LUI(void);
+    void SV(void);
+    template <uint8_t CountPerOp = 0>
+    void BEQL(void);
+    template <uint8_t CountPerOp = 0>
+    void BNEL(void);
+    template <uint8_t CountPerOp = 0>
+    void BLEZL(void);
+    template <uint8_t CountPerOp = 0>
+    void BGTZL(void);
+    void DADDI(void);
+    void DADDIU(void);
+    void LDL(void);
+    void LDR(void);
+    void LB(void);
+    void LH(void);
+    void LWL(void);
+    void LW(void);
+    void LBU(void);
+    void LHU(void);
+    void LWR(void);
+    void LWU(void);
+    void SB(void);
+    void SH(void);
+    void SWL(void);
+    void SW(void);
+    void SDL(void);
+    void SDR(void);
+    void SWR(void);
+    void CACHE(void);
+    void LL(void);
+    void LWC1(void);
+    template <bool FR>
+    void LWC1(void);
+    void LLD(void);
+    void LDC1(void);
+    template <bool FR>
+    void LDC1(void);
+    void LD(void);
+    void SC(void);
+    void SWC1(void);
+    template <bool FR>
+    void SWC1(void);
+    void SCD(void);
+    void SDC1(void);
+    template <bool FR>
+    void SDC1(void);
+    void SD(void);
+
+    void SLL(void);
+    void SRL(void);
+    void SRA(void);
+    void SLLV(void);
+    void SRLV(void);
+    void SRAV(void);
+    template <uint8_t CountPerOp = 0>
+    void JR(void);
+    template <uint8_t CountPerOp = 0>
+    void JALR(void);
+    void SYSCALL(void);
+    void BREAK(void);
+    void SYNC(void);
+    void MFHI(void);
+    void MTHI(void);
+    void MFLO(void);
+    void MTLO(void);
+    void DSLLV(void);
+    void DSRLV(void);
+    void DSRAV(void);
+    void MULT(void);
+    void MULTU(void);
+    void DIV(void);
+    void DIVU(void);
+    void DMULT(void);
+    void DMULTU(void);
+    void DDIV(void);
+    void DDIVU(void);
+    void ADD(void);
+    void ADDU(void);
+    void SUB(void);
+    void SUBU(void);
+    void AND(void);
+    void OR(void);
+    void XOR(void);
+    void NOR(void);
+    void SLT(void);
+    void SLTU(void);
+    void DADD(void);
+    void DADDU(void);
+    void DSUB(void);
+    void DSUBU(void);
+    void TGE(void);
+    void TGEU(void);
+    void TLT(void);
+    void TLTU(void);
+    void TEQ(void);
+    void TNE(void);
+    void DSLL(void);
+    void DSRL(void);
+    void DSRA(void);
+    void DSLL32(void);
+    void DSRL32(void);
+    void DSRA32(void);
+
+    template <uint8_t CountPerOp = 0>
+    void BLTZ(void);
+    template <uint8_t CountPerOp = 0>
+    void BGEZ(void);
+    template <uint8_t CountPerOp = 0>
+    void BLTZL(void);
+    template <uint8_t CountPerOp = 0>
+    void BGEZL(void);
+    void TGEI(void);
+    void TGEIU(void);
+    void TLTI(void);
+    void TLTIU(void);
+    void TEQI(void);
+    void TNEI(void);
+    template <uint8_t CountPerOp = 0>
+    void BLTZAL(void);
+    template <uint8_t CountPerOp = 0>
+    void BGEZAL(void);
+    template <uint8_t CountPerOp = 0>
+    void BLTZALL(void);
+    template <uint8_t CountPerOp = 0>
+    void BGEZALL(void);
+
+    void MFC0(void);
+    void MTC0(void);
+
+    void MFC1(void);
+    template <bool FR>
+    void MFC1(void);
+    void DMFC1(void);
+    template <bool FR>
+    void DMFC1(void);
+    void CFC1(void);
+    void MTC1(void);
+    template <bool FR>
+    void MTC1(void);
+    void DMTC1(void);
+    template <bool FR>
+    void DMTC1(void);
+    void CTC1(void);
+
+    void TLBR(void);
+    void TLBWI(void);
+    void TLBWR(void);
+    void TLBP(void);
+    void ERET(void);
+
+    template <uint8_t CountPerOp = 0>
+    void BC1F(void);
+    template <uint8_t CountPerOp = 0>
+    void BC1T(void);
+    template <uint8_t CountPerOp = 0>
+    void BC1FL(void);
+    template <uint8_t CountPerOp = 0>
+    void BC1TL(void);
+
+    void ADD_S(void);
+    template <bool FR>
+    void ADD_S(void);
+    void SUB_S(void);
+    template <bool FR>
+    void SUB_S(void);
+    void MUL_S(void);
+    template <bool FR>
+    void MUL_S(void);
+    void DIV_S(void);
+    template <bool FR>
+    void DIV_S(void);
+    void SQRT_S(void);
+    template <bool FR>
+    void SQRT_S(void);
+    void ABS_S(void);
+    template <bool FR>
+    void ABS_S(void);
+    void MOV_S(void);
+    template <bool FR>
+    void MOV_S(void);
+    void NEG_S(void);
+    template <bool FR>
+    void NEG_S(void);
+    void ROUND_L_S(void);
+    void TRUNC_L_S(void);
+    template <bool FR>
+    void TRUNC_L_S(void);
+    void CEIL_L_S(void);
+    void FLOOR_L_S(void);
+    void ROUND_W_S(void);
+    template <bool FR>
+    void ROUND_W_S(void);
+    void TRUNC_W_S(void);
+    template <bool FR>
+    void TRUNC_W_S(void);
+    void CEIL_W_S(void);
+    void FLOOR_W_S(void);
+    void CVT_D_S(void);
+    template <bool FR>
+    void CVT_D_S(void);
+    void CVT_W_S(void);
+    template <bool FR>
+    void CVT_W_S(void);
+    void CVT_L_S(void);
+    template <bool FR>
+    void CVT_L_S(void);
+    void C_F_S(void);
+    void C_UN_S(void);
+    void C_EQ_S(void);
+    template <bool FR>
+    void C_EQ_S(void);
+    void C_UEQ_S(void);
+    template <bool FR>
+    void C_UEQ_S(void);
+    void C_OLT_S(void);
+    template <bool FR>
+    void C_OLT_S(void);
+    void C_ULT_S(void);
+    template <bool FR>
+    void C_ULT_S(void);
+    void C_OLE_S(void);
+    template <bool FR>
+    void C_OLE_S(void);
+    void C_ULE_S(void);
+    void C_SF_S(void);
+    void C_NGLE_S(void);
+    void C_SEQ_S(void);
+    void C_NGL_S(void);
+    void C_LT_S(void);
+    template <bool FR>
+    void C_LT_S(void);
+    void C_NGE_S(void);
+    void C_LE_S(void);
+    template <bool FR>
+    void C_LE_S(void);
+    void C_NGT_S(void);
+    template <bool FR>
+    void C_NGT_S(void);
+
+    void ADD_D(void);
+    template <bool FR>
+    void ADD_D(void);
+    void SUB_D(void);
+    template <bool FR>
+    void SUB_D(void);
+    void MUL_D(void);
+    template <bool FR>
+    void MUL_D(void);
+    void DIV_D(void);
+    template <bool FR>
+    void DIV_D(void);
+    void SQRT_D(void);
+    template <bool FR>
+    void SQRT_D(void);
+    void ABS_D(void);
+    template <bool FR>
+    void ABS_D(void);
+    void MOV_D(void);
+    template <bool FR>
+    void MOV_D(void);
+    void NEG_D(void);
+    template <bool FR>
+    void NEG_D(void);
+    void ROUND_L_D(void);
+    void TRUNC_L_D(void);
+    void CEIL_L_D(void);
+    void FLOOR_L_D(void);
+    void ROUND_W_D(void);
+    template <bool FR>
+    void ROUND_W_D(void);
+    void TRUNC_W_D(void);
+    template <bool FR>
+    void TRUNC_W_D(void);
+    void CEIL_W_D(void);
+    void FLOOR_W_D(void);
+    void CVT_S_D(void);
+    template <bool FR>
+    void CVT_S_D(void);
+    void CVT_W_D(void);
+    template <bool FR>
+    void CVT_W_D(void);
+    void CVT_L_D(void);
+    template <bool FR>
+    void CVT_L_D(void);
+    void C_F_D(void);
+    void C_UN_D(void);
+    void C_EQ_D(void);
+    template <bool FR>
+    void C_EQ_D(void);
+    void C_UEQ_D(void);
+    void C_OLT_D(void);
+    void C_ULT_D(void);
+    void C_OLE_D(void);
+    void C_ULE_D(void);
+    void C_SF_D(void);
+    void C_NGLE_D(void);
+    void C_SEQ_D(void);
+    void C_NGL_D(void);
+    void C_LT_D(void);
+    template <bool FR>
+    void C_LT_D(void);
+    void C_NGE_D(void);
+    void C_LE_D(void);
+    template <bool FR>
+    void C_LE_D(void);
+    void C_NGT_D(void);
+
+    void CVT_S_W(void);
+    template <bool FR>
+    void CVT_S_W(void);
+    void CVT_D_W(void);
+    template <bool FR>
+    void CVT_D_W(void);
+
+    void CVT_D_L(void);
+    template <bool FR>
+    void CVT_D_L(void);
+    void CVT_S_L(void);
+    template <bool FR>
+    void CVT_S_L(void);
+
+    inline void SPECIAL(void)
+    {
+        (this->*special_table[_cur_instr.func])();
+    }
+
+    inline void REGIMM(void)
+    {
+        (this->*regimm_table[_cur_instr.rt])();
+    }
+
+    inline void COP0(void)
+    {
+        (this->*cop0_table[_cur_instr.rs])();
+    }
+
+    inline void COP1(void)
+    {
+        (this->*cop1_table[_cur_instr.fmt])();
+    }
+
+    inline void TLB(void)
+    {
+        (this->*tlb_table[_cur_instr.func])();
+    }
+
+    inline void BC(void)
+    {
+        (this->*bc_table[_cur_instr.ft])();
+    }
+
+    inline void S(void)
+    {
+        (this->*s_table[_cur_instr.func])();
+    }
+
+    inline void D(void)
+    {
+        (this->*d_table[_cur_instr.func])();
+    }
+
+    inline void W(void)
+    {
+        (this->*w_table[_cur_instr.func])();
+    }
+
+    inline void L(void)
+    {
+        (this->*l_table[_cur_instr.func])();
+    }
 
+    // decode tables, the handlers are plain members so every call through
+    // them is a direct call into this class
+    typedef void(Interpreter::*instruction_ptr)(void);
+    typedef std::array<instruction_ptr, 64> InstructionTable;
+
+    static const InstructionTable instruction_table;
+    static const InstructionTable special_table;
+    static const InstructionTable regimm_table;
+    static const InstructionTable cop0_table;
+    static const InstructionTable cop1_table;
+    static const InstructionTable tlb_table;
+    static const InstructionTable bc_table;
+    static const InstructionTable s_table;
+    static const InstructionTable d_table;
+    static const InstructionTable w_table;
+    static const InstructionTable l_table;
 };
@@ -60,29 +60,31 @@ void Interpreter::MTC0(void)
         _cp0.updateCount(Bus::state.PC, _bus->rom->getCountPerOp());
 
         Bus::state.interrupt_unsafe_state = true;
-        if (Bus::state.next_interrupt <= Bus::state.cp0_reg[CP0_COUNT_REG])
+        if (Bus::state.next_interrupt <= Bus::state.cycles)
             _bus->interrupt->generateInterrupt();
 
         Bus::state.interrupt_unsafe_state = false;
 
-        _bus->interrupt->translateEventQueueBy((uint32_t)_reg[_cur_instr.rt].u & 0xFFFFFFFF);
-        Bus::state.cp0_reg[CP0_COUNT_REG] = (uint32_t)_reg[_cur_instr.rt].u & 0xFFFFFFFF;
+        _cp0.setCount((uint32_t)_reg[_cur_instr.rt].u);
+        _bus->interrupt->scheduleCompare();
         break;
     case CP0_ENTRYHI_REG:
+        if (((uint32_t)_reg[_cur_instr.rt].u & 0xFF) != (Bus::state.cp0_reg[CP0_ENTRYHI_REG] & 0xFF))
+        {
+            TLB::tlb_flush(_cp0.tlb);
+        }
         Bus::state.cp0_reg[CP0_ENTRYHI_REG] = (uint32_t)_reg[_cur_instr.rt].u;
         break;
     case CP0_COMPARE_REG:
         _cp0.updateCount(Bus::state.PC, _bus->rom->getCountPerOp());
-        _bus->interrupt->deleteEvent(COMPARE_INT);
-        _bus->interrupt->addInterruptEventCount(COMPARE_INT, (uint32_t)_reg[_cur_instr.rt].u);
         Bus::state.cp0_reg[CP0_COMPARE_REG] = (uint32_t)_reg[_cur_instr.rt].u;
+        _bus->interrupt->scheduleCompare();
         Bus::state.cp0_reg[CP0_CAUSE_REG] &= 0xFFFF7FFF; //Timer interupt is clear
         break;
     case CP0_STATUS_REG:
         if (((uint32_t)_reg[_cur_instr.rt].u & 0x04000000) != (Bus::state.cp0_reg[CP0_STATUS_REG] & 0x04000000))
         {
             _cp1.shuffleFPRData(*this, Bus::state.cp0_reg[CP0_STATUS_REG], (uint32_t)_reg[_cur_instr.rt].u);
-            _cp1.setFPRPointers(*this, (uint32_t)_reg[_cur_instr.rt].u);
         }
         Bus::state.cp0_reg[CP0_STATUS_REG] = (uint32_t)_reg[_cur_instr.rt].u;
         _cp0.updateCount(Bus::state.PC, _bus->rom->getCountPerOp());
@@ -90,7 +92,7 @@ void Interpreter::MTC0(void)
         _bus->interrupt->checkInterrupt();
 
         Bus::state.interrupt_unsafe_state = true;
-        if (Bus::state.next_interrupt <= Bus::state.cp0_reg[CP0_COUNT_REG])
+        if (Bus::state.next_interrupt <= Bus::state.cycles)
             _bus->interrupt->generateInterrupt();
 
         Bus::state.interrupt_unsafe_state = false;
@@ -148,6 +150,10 @@ void Interpreter::TLBR(void)
     uint8_t state1 = _cp0.state[index][1];
 
     TLB::tlb_read(_cp0.tlb, index, &entry_hi);
+    if ((entry_hi & 0xFF) != (Bus::state.cp0_reg[CP0_ENTRYHI_REG] & 0xFF))
+    {
+        TLB::tlb_flush(_cp0.tlb);
+    }
     Bus::state.cp0_reg[CP0_ENTRYHI_REG] = entry_hi;
     Bus::state.cp0_reg[CP0_ENTRYLO0_REG] = (pfn0 >> 6) | state0;
     Bus::state.cp0_reg[CP0_ENTRYLO1_REG] = (pfn1 >> 6) | state1;
@@ -227,6 +233,6 @@ void Interpreter::ERET(void)
     _llbit = 0;
     _bus->interrupt->checkInterrupt();
     Bus::state.last_jump_addr = Bus::state.PC;
-    if (Bus::state.next_interrupt <= Bus::state.cp0_reg[CP0_COUNT_REG])
+    if (Bus::state.next_interrupt <= Bus::state.cycles)
         _bus->interrupt->generateInterrupt();
 }
@@ -8,24 +8,41 @@
 #include <core/bus.h>
 
 
+// the host FPU keeps the last mode set here, so arithmetic only pays for a
+// switch after CTC1 or a conversion in a fixed mode
+inline void Interpreter::useRounding(int32_t mode)
+{
+    if (mode != _host_rounding)
+    {
+        set_rounding(mode);
+        _host_rounding = mode;
+    }
+}
+
+template <bool FR>
 void Interpreter::MFC1(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    _reg[_cur_instr.rt].s = *(int32_t*)_s_reg[_cur_instr.fs];
+    _reg[_cur_instr.rt].s = *(int32_t*)fprS<FR>(_cur_instr.fs);
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(MFC1)
+
+template <bool FR>
 void Interpreter::DMFC1(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    _reg[_cur_instr.rt].s = *(int64_t*)_d_reg[_cur_instr.fs];
+    _reg[_cur_instr.rt].s = *(int64_t*)fprD<FR>(_cur_instr.fs);
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(DMFC1)
+
 void Interpreter::CFC1(void)
 {
     if (_cp0.COP1Unusable(*this))
@@ -43,24 +60,30 @@ void Interpreter::CFC1(void)
     ++Bus::state.PC;
 }
 
+template <bool FR>
 void Interpreter::MTC1(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    *((int32_t*)_s_reg[_cur_instr.fs]) = (int32_t)_reg[_cur_instr.rt].s;
+    *((int32_t*)fprS<FR>(_cur_instr.fs)) = (int32_t)_reg[_cur_instr.rt].s;
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(MTC1)
+
+template <bool FR>
 void Interpreter::DMTC1(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    *((int64_t*)_d_reg[_cur_instr.fs]) = _reg[_cur_instr.rt].s;
+    *((int64_t*)fprD<FR>(_cur_instr.fs)) = _reg[_cur_instr.rt].s;
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(DMTC1)
+
 void Interpreter::CTC1(void)
 {
     if (_cp0.COP1Unusable(*this))
@@ -69,26 +92,14 @@ void Interpreter::CTC1(void)
     if (_cur_instr.fs == 31)
         _FCR31 = (int32_t)_reg[_cur_instr.rt].s;
 
-    switch (_FCR31 & 3)
-    {
-    case 0:
-        rounding_mode = ROUND_MODE; // Round to nearest, or to even if equidistant
-        break;
-    case 1:
-        rounding_mode = TRUNC_MODE; // Truncate (toward 0)
-        break;
-    case 2:
-        rounding_mode = CEIL_MODE; // Round up (toward +infinity) 
-        break;
-    case 3:
-        rounding_mode = FLOOR_MODE; // Round down (toward -infinity) 
-        break;
-    }
+    updateRoundingMode();
+    useRounding(rounding_mode);
     //if ((FCR31 >> 7) & 0x1F) printf("FPU Exception enabled : %x\n",
     //                 (int)((FCR31 >> 7) & 0x1F));
     ++Bus::state.PC;
 }
 
+template <uint8_t CountPerOp>
 void Interpreter::BC1F(void)
 {
     // DECLARE_JUMP(BC1F,  PCADDR + (iimmediate+1)*4, (FCR31 & 0x800000)==0, &reg[0], 0, 1)
@@ -101,6 +112,9 @@ void Interpreter::BC1F(void)
         );
 }
 
+INSTANTIATE_BRANCH(BC1F)
+
+template <uint8_t CountPerOp>
 void Interpreter::BC1T(void)
 {
     // DECLARE_JUMP(BC1T,  PCADDR + (iimmediate+1)*4, (FCR31 & 0x800000)!=0, &reg[0], 0, 1)
@@ -113,6 +127,9 @@ void Interpreter::BC1T(void)
         );
 }
 
+INSTANTIATE_BRANCH(BC1T)
+
+template <uint8_t CountPerOp>
 void Interpreter::BC1FL(void)
 {
     // DECLARE_JUMP(BC1FL, PCADDR + (iimmediate+1)*4, (FCR31 & 0x800000)==0, &reg[0], 1, 1)
@@ -125,6 +142,9 @@ void Interpreter::BC1FL(void)
         );
 }
 
+INSTANTIATE_BRANCH(BC1FL)
+
+template <uint8_t CountPerOp>
 void Interpreter::BC1TL(void)
 {
     // DECLARE_JUMP(BC1TL, PCADDR + (iimmediate+1)*4, (FCR31 & 0x800000)!=0, &reg[0], 1, 1)
@@ -137,112 +157,134 @@ void Interpreter::BC1TL(void)
         );
 }
 
+INSTANTIATE_BRANCH(BC1TL)
+
+template <bool FR>
 void Interpreter::ADD_S(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    set_rounding(rounding_mode);
-    *(float*)_s_reg[_cur_instr.fd] = add_f32((float*)_s_reg[_cur_instr.fs], (float*)_s_reg[_cur_instr.ft]);
+    useRounding(rounding_mode);
+    *fprS<FR>(_cur_instr.fd) = add_f32(fprS<FR>(_cur_instr.fs), fprS<FR>(_cur_instr.ft));
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(ADD_S)
+
+template <bool FR>
 void Interpreter::SUB_S(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    set_rounding(rounding_mode);
-    *(float*)_s_reg[_cur_instr.fd] = sub_f32((float*)_s_reg[_cur_instr.fs], (float*)_s_reg[_cur_instr.ft]);
+    useRounding(rounding_mode);
+    *fprS<FR>(_cur_instr.fd) = sub_f32(fprS<FR>(_cur_instr.fs), fprS<FR>(_cur_instr.ft));
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(SUB_S)
+
+template <bool FR>
 void Interpreter::MUL_S(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    set_rounding(rounding_mode);
-    *(float*)_s_reg[_cur_instr.fd] = mul_f32((float*)_s_reg[_cur_instr.fs], (float*)_s_reg[_cur_instr.ft]);
+    useRounding(rounding_mode);
+    *fprS<FR>(_cur_instr.fd) = mul_f32(fprS<FR>(_cur_instr.fs), fprS<FR>(_cur_instr.ft));
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(MUL_S)
+
+template <bool FR>
 void Interpreter::DIV_S(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    if ((_FCR31 & 0x400) && *_s_reg[_cur_instr.ft] == 0)
+    if ((_FCR31 & 0x400) && *fprS<FR>(_cur_instr.ft) == 0)
     {
         // This warning goes nuts in DK64???
         //LOG_WARNING(Interpreter) << "Divide by 0";
     }
 
-    set_rounding(rounding_mode);
-    *(float*)_s_reg[_cur_instr.fd] = div_f32((float*)_s_reg[_cur_instr.fs], (float*)_s_reg[_cur_instr.ft]);
+    useRounding(rounding_mode);
+    *fprS<FR>(_cur_instr.fd) = div_f32(fprS<FR>(_cur_instr.fs), fprS<FR>(_cur_instr.ft));
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(DIV_S)
+
+template <bool FR>
 void Interpreter::SQRT_S(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    set_rounding(rounding_mode);
-    *(float*)_s_reg[_cur_instr.fd] = sqrt_f32((float*)_s_reg[_cur_instr.fs]);
+    useRounding(rounding_mode);
+    *fprS<FR>(_cur_instr.fd) = sqrt_f32(fprS<FR>(_cur_instr.fs));
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(SQRT_S)
+
+template <bool FR>
 void Interpreter::ABS_S(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    set_rounding(rounding_mode);
-    *(float*)_s_reg[_cur_instr.fd] = abs_f32((float*)_s_reg[_cur_instr.fs]);
+    *fprS<FR>(_cur_instr.fd) = abs_f32(fprS<FR>(_cur_instr.fs));
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(ABS_S)
+
+template <bool FR>
 void Interpreter::MOV_S(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    set_rounding(rounding_mode);
-    *(float*)_s_reg[_cur_instr.fd] = *(float*)_s_reg[_cur_instr.fs];
+    *fprS<FR>(_cur_instr.fd) = *fprS<FR>(_cur_instr.fs);
 
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(MOV_S)
+
+template <bool FR>
 void Interpreter::NEG_S(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    set_rounding(rounding_mode);
-    *(float*)_s_reg[_cur_instr.fd] = neg_f32((float*)_s_reg[_cur_instr.fs]);
+    *fprS<FR>(_cur_instr.fd) = neg_f32(fprS<FR>(_cur_instr.fs));
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(NEG_S)
+
 void Interpreter::ROUND_L_S(void)
 {
     NOT_IMPLEMENTED();
 }
 
+template <bool FR>
 void Interpreter::TRUNC_L_S(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    uint32_t saved_mode = rounding_mode;
-
-    set_rounding(TRUNC_MODE);
-    *(int64_t*)_d_reg[_cur_instr.fd] = trunc_f32_to_i64((float*)_s_reg[_cur_instr.fs]);
-    set_rounding(saved_mode);
+    *(int64_t*)fprD<FR>(_cur_instr.fd) = trunc_f32_to_i64(fprS<FR>(_cur_instr.fs));
 
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(TRUNC_L_S)
+
 void Interpreter::CEIL_L_S(void)
 {
     NOT_IMPLEMENTED();
@@ -253,34 +295,33 @@ void Interpreter::FLOOR_L_S(void)
     NOT_IMPLEMENTED();
 }
 
+template <bool FR>
 void Interpreter::ROUND_W_S(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    uint32_t saved_mode = rounding_mode;
-
-    set_rounding(ROUND_MODE);
-    *(int32_t*)_s_reg[_cur_instr.fd] = f32_to_i32((float*)_s_reg[_cur_instr.fs]);
-    set_rounding(saved_mode);
+    useRounding(ROUND_MODE);
+    *(int32_t*)fprS<FR>(_cur_instr.fd) = f32_to_i32(fprS<FR>(_cur_instr.fs));
 
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(ROUND_W_S)
+
+template <bool FR>
 void Interpreter::TRUNC_W_S(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    uint32_t saved_mode = rounding_mode;
-
-    set_rounding(TRUNC_MODE);
-    *(int32_t*)_s_reg[_cur_instr.fd] = trunc_f32_to_i32((float*)_s_reg[_cur_instr.fs]);
-    set_rounding(saved_mode);
+    *(int32_t*)fprS<FR>(_cur_instr.fd) = trunc_f32_to_i32(fprS<FR>(_cur_instr.fs));
 
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(TRUNC_W_S)
+
 void Interpreter::CEIL_W_S(void)
 {
     NOT_IMPLEMENTED();
@@ -291,36 +332,44 @@ void Interpreter::FLOOR_W_S(void)
     NOT_IMPLEMENTED();
 }
 
+template <bool FR>
 void Interpreter::CVT_D_S(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    set_rounding(rounding_mode);
-    *(double*)_d_reg[_cur_instr.fd] = f32_to_f64((float*)_s_reg[_cur_instr.fs]);
+    *fprD<FR>(_cur_instr.fd) = f32_to_f64(fprS<FR>(_cur_instr.fs));
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(CVT_D_S)
+
+template <bool FR>
 void Interpreter::CVT_W_S(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    set_rounding(rounding_mode);
-    *(int32_t*)_s_reg[_cur_instr.fd] = f32_to_i32((float*)_s_reg[_cur_instr.fs]);
+    useRounding(rounding_mode);
+    *(int32_t*)fprS<FR>(_cur_instr.fd) = f32_to_i32(fprS<FR>(_cur_instr.fs));
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(CVT_W_S)
+
+template <bool FR>
 void Interpreter::CVT_L_S(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    set_rounding(rounding_mode);
-    *(int64_t*)_d_reg[_cur_instr.fd] = f32_to_i64((float*)_s_reg[_cur_instr.fs]);
+    useRounding(rounding_mode);
+    *(int64_t*)fprD<FR>(_cur_instr.fd) = f32_to_i64(fprS<FR>(_cur_instr.fs));
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(CVT_L_S)
+
 void Interpreter::C_F_S(void)
 {
     NOT_IMPLEMENTED();
@@ -331,12 +380,13 @@ void Interpreter::C_UN_S(void)
     NOT_IMPLEMENTED();
 }
 
+template <bool FR>
 void Interpreter::C_EQ_S(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    uint8_t result = c_cmp_32(_s_reg[_cur_instr.fs], _s_reg[_cur_instr.ft]);
+    uint8_t result = c_cmp_32(fprS<FR>(_cur_instr.fs), fprS<FR>(_cur_instr.ft));
 
     if (result == CMP_UNORDERED)
     {
@@ -349,12 +399,15 @@ void Interpreter::C_EQ_S(void)
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(C_EQ_S)
+
+template <bool FR>
 void Interpreter::C_UEQ_S(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    uint8_t result = c_cmp_32(_s_reg[_cur_instr.fs], _s_reg[_cur_instr.ft]);
+    uint8_t result = c_cmp_32(fprS<FR>(_cur_instr.fs), fprS<FR>(_cur_instr.ft));
 
     if (result == CMP_UNORDERED)
     {
@@ -367,12 +420,15 @@ void Interpreter::C_UEQ_S(void)
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(C_UEQ_S)
+
+template <bool FR>
 void Interpreter::C_OLT_S(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    uint8_t result = c_cmp_32(_s_reg[_cur_instr.fs], _s_reg[_cur_instr.ft]);
+    uint8_t result = c_cmp_32(fprS<FR>(_cur_instr.fs), fprS<FR>(_cur_instr.ft));
 
     if (result == CMP_UNORDERED)
     {
@@ -385,12 +441,15 @@ void Interpreter::C_OLT_S(void)
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(C_OLT_S)
+
+template <bool FR>
 void Interpreter::C_ULT_S(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    uint8_t result = c_cmp_32(_s_reg[_cur_instr.fs], _s_reg[_cur_instr.ft]);
+    uint8_t result = c_cmp_32(fprS<FR>(_cur_instr.fs), fprS<FR>(_cur_instr.ft));
 
     if (result == CMP_UNORDERED)
     {
@@ -403,12 +462,15 @@ void Interpreter::C_ULT_S(void)
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(C_ULT_S)
+
+template <bool FR>
 void Interpreter::C_OLE_S(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    uint8_t result = c_cmp_32(_s_reg[_cur_instr.fs], _s_reg[_cur_instr.ft]);
+    uint8_t result = c_cmp_32(fprS<FR>(_cur_instr.fs), fprS<FR>(_cur_instr.ft));
 
     if (result == CMP_UNORDERED)
     {
@@ -421,6 +483,8 @@ void Interpreter::C_OLE_S(void)
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(C_OLE_S)
+
 void Interpreter::C_ULE_S(void)
 {
     NOT_IMPLEMENTED();
@@ -446,12 +510,13 @@ void Interpreter::C_NGL_S(void)
     NOT_IMPLEMENTED();
 }
 
+template <bool FR>
 void Interpreter::C_LT_S(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    uint8_t result = c_cmp_32(_s_reg[_cur_instr.fs], _s_reg[_cur_instr.ft]);
+    uint8_t result = c_cmp_32(fprS<FR>(_cur_instr.fs), fprS<FR>(_cur_instr.ft));
 
     if (result == CMP_UNORDERED)
     {
@@ -464,17 +529,20 @@ void Interpreter::C_LT_S(void)
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(C_LT_S)
+
 void Interpreter::C_NGE_S(void)
 {
     NOT_IMPLEMENTED();
 }
 
+template <bool FR>
 void Interpreter::C_LE_S(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    uint8_t result = c_cmp_32(_s_reg[_cur_instr.fs], _s_reg[_cur_instr.ft]);
+    uint8_t result = c_cmp_32(fprS<FR>(_cur_instr.fs), fprS<FR>(_cur_instr.ft));
 
     if (result == CMP_UNORDERED)
     {
@@ -487,12 +555,15 @@ void Interpreter::C_LE_S(void)
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(C_LE_S)
+
+template <bool FR>
 void Interpreter::C_NGT_S(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    uint8_t result = c_cmp_32(_s_reg[_cur_instr.fs], _s_reg[_cur_instr.ft]);
+    uint8_t result = c_cmp_32(fprS<FR>(_cur_instr.fs), fprS<FR>(_cur_instr.ft));
 
     if (result == CMP_UNORDERED)
     {
@@ -505,91 +576,115 @@ void Interpreter::C_NGT_S(void)
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(C_NGT_S)
+
+template <bool FR>
 void Interpreter::ADD_D(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    set_rounding(rounding_mode);
-    *((double*)_d_reg[_cur_instr.fd]) = add_f64((double*)_d_reg[_cur_instr.fs], (double*)_d_reg[_cur_instr.ft]);
+    useRounding(rounding_mode);
+    *(fprD<FR>(_cur_instr.fd)) = add_f64(fprD<FR>(_cur_instr.fs), fprD<FR>(_cur_instr.ft));
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(ADD_D)
+
+template <bool FR>
 void Interpreter::SUB_D(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    set_rounding(rounding_mode);
-    *((double*)_d_reg[_cur_instr.fd]) = sub_f64((double*)_d_reg[_cur_instr.fs], (double*)_d_reg[_cur_instr.ft]);
+    useRounding(rounding_mode);
+    *(fprD<FR>(_cur_instr.fd)) = sub_f64(fprD<FR>(_cur_instr.fs), fprD<FR>(_cur_instr.ft));
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(SUB_D)
+
+template <bool FR>
 void Interpreter::MUL_D(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    set_rounding(rounding_mode);
-    *((double*)_d_reg[_cur_instr.fd]) = mul_f64((double*)_d_reg[_cur_instr.fs], (double*)_d_reg[_cur_instr.ft]);
+    useRounding(rounding_mode);
+    *(fprD<FR>(_cur_instr.fd)) = mul_f64(fprD<FR>(_cur_instr.fs), fprD<FR>(_cur_instr.ft));
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(MUL_D)
+
+template <bool FR>
 void Interpreter::DIV_D(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    if ((_FCR31 & 0x400) && *_d_reg[_cur_instr.ft] == 0)
+    if ((_FCR31 & 0x400) && *fprD<FR>(_cur_instr.ft) == 0)
     {
         //LOG_WARNING(Interpreter) << "Divide by 0";
     }
 
-    set_rounding(rounding_mode);
-    *((double*)_d_reg[_cur_instr.fd]) = div_f64((double*)_d_reg[_cur_instr.fs], (double*)_d_reg[_cur_instr.ft]);
+    useRounding(rounding_mode);
+    *(fprD<FR>(_cur_instr.fd)) = div_f64(fprD<FR>(_cur_instr.fs), fprD<FR>(_cur_instr.ft));
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(DIV_D)
+
+template <bool FR>
 void Interpreter::SQRT_D(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    set_rounding(rounding_mode);
-    *((double*)_d_reg[_cur_instr.fd]) = sqrt_f64((double*)_d_reg[_cur_instr.fs]);
+    useRounding(rounding_mode);
+    *(fprD<FR>(_cur_instr.fd)) = sqrt_f64(fprD<FR>(_cur_instr.fs));
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(SQRT_D)
+
+template <bool FR>
 void Interpreter::ABS_D(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    set_rounding(rounding_mode);
-    *(double*)_d_reg[_cur_instr.fd] = abs_f64((double*)_d_reg[_cur_instr.fs]);
+    *fprD<FR>(_cur_instr.fd) = abs_f64(fprD<FR>(_cur_instr.fs));
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(ABS_D)
+
+template <bool FR>
 void Interpreter::MOV_D(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    set_rounding(rounding_mode);
-    *((int64_t*)_d_reg[_cur_instr.fd]) = *((int64_t*)_d_reg[_cur_instr.fs]);
+    *((int64_t*)fprD<FR>(_cur_instr.fd)) = *((int64_t*)fprD<FR>(_cur_instr.fs));
 
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(MOV_D)
+
+template <bool FR>
 void Interpreter::NEG_D(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    *((double*)_d_reg[_cur_instr.fd]) = neg_f64((double*)_d_reg[_cur_instr.fs]);
+    *(fprD<FR>(_cur_instr.fd)) = neg_f64(fprD<FR>(_cur_instr.fs));
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(NEG_D)
+
 void Interpreter::ROUND_L_D(void)
 {
     NOT_IMPLEMENTED();
@@ -610,34 +705,33 @@ void Interpreter::FLOOR_L_D(void)
     NOT_IMPLEMENTED();
 }
 
+template <bool FR>
 void Interpreter::ROUND_W_D(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    uint32_t saved_mode = rounding_mode;
-
-    set_rounding(ROUND_MODE);
-    *(int32_t*)_s_reg[_cur_instr.fd] = f64_to_i32((double*)_d_reg[_cur_instr.fs]);
-    set_rounding(saved_mode);
+    useRounding(ROUND_MODE);
+    *(int32_t*)fprS<FR>(_cur_instr.fd) = f64_to_i32(fprD<FR>(_cur_instr.fs));
 
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(ROUND_W_D)
+
+template <bool FR>
 void Interpreter::TRUNC_W_D(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    uint32_t saved_mode = rounding_mode;
-
-    set_rounding(TRUNC_MODE);
-    *(int32_t*)_s_reg[_cur_instr.fd] = trunc_f64_to_i32((double*)_d_reg[_cur_instr.fs]);
-    set_rounding(saved_mode);
+    *(int32_t*)fprS<FR>(_cur_instr.fd) = trunc_f64_to_i32(fprD<FR>(_cur_instr.fs));
 
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(TRUNC_W_D)
+
 void Interpreter::CEIL_W_D(void)
 {
     NOT_IMPLEMENTED();
@@ -648,36 +742,45 @@ void Interpreter::FLOOR_W_D(void)
     NOT_IMPLEMENTED();
 }
 
+template <bool FR>
 void Interpreter::CVT_S_D(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    set_rounding(rounding_mode);
-    *((float*)_s_reg[_cur_instr.fd]) = f64_to_f32((double*)_d_reg[_cur_instr.fs]);
+    useRounding(rounding_mode);
+    *(fprS<FR>(_cur_instr.fd)) = f64_to_f32(fprD<FR>(_cur_instr.fs));
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(CVT_S_D)
+
+template <bool FR>
 void Interpreter::CVT_W_D(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    set_rounding(rounding_mode);
-    *((int32_t*)_s_reg[_cur_instr.fd]) = f64_to_i32((double*)_d_reg[_cur_instr.fs]);
+    useRounding(rounding_mode);
+    *((int32_t*)fprS<FR>(_cur_instr.fd)) = f64_to_i32(fprD<FR>(_cur_instr.fs));
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(CVT_W_D)
+
+template <bool FR>
 void Interpreter::CVT_L_D(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    set_rounding(rounding_mode);
-    *((int64_t*)_d_reg[_cur_instr.fd]) = f64_to_i64((double*)_d_reg[_cur_instr.fs]);
+    useRounding(rounding_mode);
+    *((int64_t*)fprD<FR>(_cur_instr.fd)) = f64_to_i64(fprD<FR>(_cur_instr.fs));
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(CVT_L_D)
+
 void Interpreter::C_F_D(void)
 {
     NOT_IMPLEMENTED();
@@ -688,12 +791,13 @@ void Interpreter::C_UN_D(void)
     NOT_IMPLEMENTED();
 }
 
+template <bool FR>
 void Interpreter::C_EQ_D(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    uint8_t result = c_cmp_64(_d_reg[_cur_instr.fs], _d_reg[_cur_instr.ft]);
+    uint8_t result = c_cmp_64(fprD<FR>(_cur_instr.fs), fprD<FR>(_cur_instr.ft));
 
     if (result == CMP_UNORDERED)
     {
@@ -706,6 +810,8 @@ void Interpreter::C_EQ_D(void)
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(C_EQ_D)
+
 void Interpreter::C_UEQ_D(void)
 {
     NOT_IMPLEMENTED();
@@ -751,12 +857,13 @@ void Interpreter::C_NGL_D(void)
     NOT_IMPLEMENTED();
 }
 
+template <bool FR>
 void Interpreter::C_LT_D(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    uint8_t result = c_cmp_64(_d_reg[_cur_instr.fs], _d_reg[_cur_instr.ft]);
+    uint8_t result = c_cmp_64(fprD<FR>(_cur_instr.fs), fprD<FR>(_cur_instr.ft));
 
     if (result == CMP_UNORDERED)
     {
@@ -769,17 +876,20 @@ void Interpreter::C_LT_D(void)
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(C_LT_D)
+
 void Interpreter::C_NGE_D(void)
 {
     NOT_IMPLEMENTED();
 }
 
+template <bool FR>
 void Interpreter::C_LE_D(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    uint8_t result = c_cmp_64(_d_reg[_cur_instr.fs], _d_reg[_cur_instr.ft]);
+    uint8_t result = c_cmp_64(fprD<FR>(_cur_instr.fs), fprD<FR>(_cur_instr.ft));
 
     if (result == CMP_UNORDERED)
     {
@@ -792,47 +902,60 @@ void Interpreter::C_LE_D(void)
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(C_LE_D)
+
 void Interpreter::C_NGT_D(void)
 {
     NOT_IMPLEMENTED();
 }
 
+template <bool FR>
 void Interpreter::CVT_S_W(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    set_rounding(rounding_mode);
-    *((float*)_s_reg[_cur_instr.fd]) = i32_to_f32(*(int32_t*)_s_reg[_cur_instr.fs]);
+    useRounding(rounding_mode);
+    *(fprS<FR>(_cur_instr.fd)) = i32_to_f32(*(int32_t*)fprS<FR>(_cur_instr.fs));
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(CVT_S_W)
+
+template <bool FR>
 void Interpreter::CVT_D_W(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    set_rounding(rounding_mode);
-    *((double*)_d_reg[_cur_instr.fd]) = i32_to_f64(*(int32_t*)_s_reg[_cur_instr.fs]);
+    *(fprD<FR>(_cur_instr.fd)) = i32_to_f64(*(int32_t*)fprS<FR>(_cur_instr.fs));
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(CVT_D_W)
+
+template <bool FR>
 void Interpreter::CVT_D_L(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    set_rounding(rounding_mode);
-    *((double*)_d_reg[_cur_instr.fd]) = i64_to_f64(*(int64_t*)_d_reg[_cur_instr.fs]);
+    useRounding(rounding_mode);
+    *(fprD<FR>(_cur_instr.fd)) = i64_to_f64(*(int64_t*)fprD<FR>(_cur_instr.fs));
     ++Bus::state.PC;
 }
 
+INSTANTIATE_FPR(CVT_D_L)
+
+template <bool FR>
 void Interpreter::CVT_S_L(void)
 {
     if (_cp0.COP1Unusable(*this))
         return;
 
-    set_rounding(rounding_mode);
-    *((float*)_s_reg[_cur_instr.fd]) = i64_to_f32(*(int64_t*)_d_reg[_cur_instr.fs]);
+    useRounding(rounding_mode);
+    *(fprS<FR>(_cur_instr.fd)) = i64_to_f32(*(int64_t*)fprD<FR>(_cur_instr.fs));
     ++Bus::state.PC;
 }
+
+INSTANTIATE_FPR(CVT_S_L)
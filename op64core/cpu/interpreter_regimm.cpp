@@ -6,6 +6,7 @@
 #include <core/bus.h>
 
 
+template <uint8_t CountPerOp>
 void Interpreter::BLTZ(void)
 {
     // DECLARE_JUMP(BLTZ, PCADDR + (iimmediate+1)*4, irs < 0, &reg[0], 0, 0)
@@ -18,6 +19,9 @@ void Interpreter::BLTZ(void)
         );
 }
 
+INSTANTIATE_BRANCH(BLTZ)
+
+template <uint8_t CountPerOp>
 void Interpreter::BGEZ(void)
 {
     // DECLARE_JUMP(BGEZ, PCADDR + (iimmediate + 1) * 4, irs >= 0, &reg[0], 0, 0)
@@ -30,6 +34,9 @@ void Interpreter::BGEZ(void)
         );
 }
 
+INSTANTIATE_BRANCH(BGEZ)
+
+template <uint8_t CountPerOp>
 void Interpreter::BLTZL(void)
 {
     // DECLARE_JUMP(BLTZL,   PCADDR + (iimmediate+1)*4, irs < 0,    &reg[0],  1, 0)
@@ -42,6 +49,9 @@ void Interpreter::BLTZL(void)
         );
 }
 
+INSTANTIATE_BRANCH(BLTZL)
+
+template <uint8_t CountPerOp>
 void Interpreter::BGEZL(void)
 {
     // DECLARE_JUMP(BGEZL,   PCADDR + (iimmediate+1)*4, irs >= 0,   &reg[0],  1, 0)
@@ -54,6 +64,8 @@ void Interpreter::BGEZL(void)
         );
 }
 
+INSTANTIATE_BRANCH(BGEZL)
+
 void Interpreter::TGEI(void)
 {
     NOT_IMPLEMENTED();
@@ -84,6 +96,7 @@ void Interpreter::TNEI(void)
     NOT_IMPLEMENTED();
 }
 
+template <uint8_t CountPerOp>
 void Interpreter::BLTZAL(void)
 {
     // DECLARE_JUMP(BLTZAL, PCADDR + (iimmediate + 1) * 4, irs < 0, &reg[31], 0, 0)
@@ -96,6 +109,9 @@ void Interpreter::BLTZAL(void)
         );
 }
 
+INSTANTIATE_BRANCH(BLTZAL)
+
+template <uint8_t CountPerOp>
 void Interpreter::BGEZAL(void)
 {
     // DECLARE_JUMP(BGEZAL, PCADDR + (iimmediate + 1) * 4, irs >= 0, &reg[31], 0, 0)
@@ -108,6 +124,9 @@ void Interpreter::BGEZAL(void)
         );
 }
 
+INSTANTIATE_BRANCH(BGEZAL)
+
+template <uint8_t CountPerOp>
 void Interpreter::BLTZALL(void)
 {
     // DECLARE_JUMP(BLTZALL, PCADDR + (iimmediate+1)*4, irs < 0,    &reg[31], 1, 0)
@@ -120,6 +139,9 @@ void Interpreter::BLTZALL(void)
         );
 }
 
+INSTANTIATE_BRANCH(BLTZALL)
+
+template <uint8_t CountPerOp>
 void Interpreter::BGEZALL(void)
 {
     // DECLARE_JUMP(BGEZALL, PCADDR + (iimmediate+1)*4, irs >= 0,   &reg[31], 1, 0)
@@ -132,3 +154,5 @@ void Interpreter::BGEZALL(void)
         false
         );
 }
+
+INSTANTIATE_BRANCH(BGEZALL)
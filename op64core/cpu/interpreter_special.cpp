@@ -73,20 +73,26 @@ void Interpreter::SRAV(void)
     ++Bus::state.PC;
 }
 
+template <uint8_t CountPerOp>
 void Interpreter::JR(void)
 {
     //DECLARE_JUMP(JR,   irs32, 1, &reg[0],    0, 0)
 
-    genericJump((uint32_t)_reg[_cur_instr.rs].u, true, &_reg[0], false, false);
+    genericJump<CountPerOp>((uint32_t)_reg[_cur_instr.rs].u, true, &_reg[0], false, false);
 }
 
+INSTANTIATE_BRANCH(JR)
+
+template <uint8_t CountPerOp>
 void Interpreter::JALR(void)
 {
     // DECLARE_JUMP(JALR, irs32, 1, PC->f.r.rd, 0, 0)
 
-    genericJump((uint32_t)_reg[_cur_instr.rs].u, true, &_reg[_cur_instr.rd], false, false);
+    genericJump<CountPerOp>((uint32_t)_reg[_cur_instr.rs].u, true, &_reg[_cur_instr.rd], false, false);
 }
 
+INSTANTIATE_BRANCH(JALR)
+
 void Interpreter::SYSCALL(void)
 {
     Bus::state.cp0_reg[CP0_CAUSE_REG] = 8 << 2;
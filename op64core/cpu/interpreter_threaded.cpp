@@ -0,0 +1,486 @@
+/* Threaded dispatch for the interpreter. Every encoding is decoded to its
+ * own label in one step and reached with a single indirect jump, using
+ * labels as values. A copy of the loop is built for each count per op and
+ * setting of Status.FR so branches and FPR accesses do not look them up.
+ * Compilers without labels as values use the table loop */
+
+#include <cstdint>
+
+#include <cpu/interpreter.h>
+
+#ifdef INTERPRETER_THREADED
+
+
+// keys into the label table, the primary opcode says how its key is formed
+enum : uint32_t
+{
+    KEY_PRIMARY = 0,
+    KEY_SPECIAL = KEY_PRIMARY + 64,
+    KEY_REGIMM = KEY_SPECIAL + 64,
+    KEY_COP0 = KEY_REGIMM + 32,
+    KEY_COP1 = KEY_COP0 + 32,   // format * 64 + function
+    KEY_COUNT = KEY_COP1 + 32 * 64
+};
+
+struct DecodeRule
+{
+    uint16_t base;
+    uint8_t shift;
+    uint16_t mask;
+    uint8_t func;
+};
+
+#define PRIMARY(op) { KEY_PRIMARY + op, 0, 0, 0 }
+
+static const DecodeRule DECODE_RULES[64] =
+{
+    { KEY_SPECIAL, 0, 0, 0x3f }, { KEY_REGIMM, 16, 0x1f, 0 }, PRIMARY(2), PRIMARY(3), PRIMARY(4), PRIMARY(5), PRIMARY(6), PRIMARY(7),
+    PRIMARY(8), PRIMARY(9), PRIMARY(10), PRIMARY(11), PRIMARY(12), PRIMARY(13), PRIMARY(14), PRIMARY(15),
+    { KEY_COP0, 21, 0x1f, 0 }, { KEY_COP1, 15, 0x7c0, 0x3f }, PRIMARY(18), PRIMARY(19), PRIMARY(20), PRIMARY(21), PRIMARY(22), PRIMARY(23),
+    PRIMARY(24), PRIMARY(25), PRIMARY(26), PRIMARY(27), PRIMARY(28), PRIMARY(29), PRIMARY(30), PRIMARY(31),
+    PRIMARY(32), PRIMARY(33), PRIMARY(34), PRIMARY(35), PRIMARY(36), PRIMARY(37), PRIMARY(38), PRIMARY(39),
+    PRIMARY(40), PRIMARY(41), PRIMARY(42), PRIMARY(43), PRIMARY(44), PRIMARY(45), PRIMARY(46), PRIMARY(47),
+    PRIMARY(48), PRIMARY(49), PRIMARY(50), PRIMARY(51), PRIMARY(52), PRIMARY(53), PRIMARY(54), PRIMARY(55),
+    PRIMARY(56), PRIMARY(57), PRIMARY(58), PRIMARY(59), PRIMARY(60), PRIMARY(61), PRIMARY(62), PRIMARY(63)
+};
+
+#undef PRIMARY
+
+static inline uint32_t decodeKey(uint32_t code)
+{
+    const DecodeRule& rule = DECODE_RULES[code >> 26];
+    return rule.base + ((code >> rule.shift) & rule.mask) + (code & rule.func);
+}
+
+
+#define L(name) &&op_##name
+
+// handlers are called directly, TLB still goes through its table
+#define HANDLER(name) \
+    op_##name: \
+    Interpreter::name(); \
+    DISPATCH();
+
+#define BRANCH(name) \
+    op_##name: \
+    Interpreter::name<CountPerOp>(); \
+    LEAVE_ON_FR(); \
+    DISPATCH();
+
+#define FPR(name) \
+    op_##name: \
+    Interpreter::name<FR>(); \
+    DISPATCH();
+
+// handlers that write Status, or reach an interrupt where a state may be
+// loaded, check FR before going on with this variant
+#define STATUS(name) \
+    op_##name: \
+    Interpreter::name(); \
+    LEAVE_ON_FR(); \
+    DISPATCH();
+
+#define LEAVE_ON_FR() \
+    if (fr() != FR) \
+    { \
+        return; \
+    }
+
+#define DISPATCH() \
+    if (CoreControl::stop || Bus::state.cycles >= end) \
+    { \
+        return; \
+    } \
+    prefetch(); \
+    goto *labels[decodeKey(_cur_instr.code)]
+
+void Interpreter::runThreaded(uint64_t end)
+{
+    typedef void(Interpreter::*variant_ptr)(uint64_t);
+
+    static const variant_ptr variants[5][2] =
+    {
+        { &Interpreter::runVariant<0, false>, &Interpreter::runVariant<0, true> },
+        { &Interpreter::runVariant<1, false>, &Interpreter::runVariant<1, true> },
+        { &Interpreter::runVariant<2, false>, &Interpreter::runVariant<2, true> },
+        { &Interpreter::runVariant<3, false>, &Interpreter::runVariant<3, true> },
+        { &Interpreter::runVariant<4, false>, &Interpreter::runVariant<4, true> }
+    };
+
+    // fixed by the ROM, anything out of range falls back to reading it at run time
+    uint8_t count_per_op = _bus->rom->getCountPerOp();
+
+    if (count_per_op >= 5)
+    {
+        count_per_op = 0;
+    }
+
+    while (!CoreControl::stop && Bus::state.cycles < end)
+    {
+        (this->*variants[count_per_op][fr()])(end);
+    }
+}
+
+template <uint8_t CountPerOp, bool FR>
+void Interpreter::runVariant(uint64_t end)
+{
+    static void* const primary[64] =
+    {
+        L(SV), L(SV), L(J), L(JAL), L(BEQ), L(BNE), L(BLEZ), L(BGTZ),
+        L(ADDI), L(ADDIU), L(SLTI), L(SLTIU), L(ANDI), L(ORI), L(XORI), L(LUI),
+        L(SV), L(SV), L(SV), L(SV), L(BEQL), L(BNEL), L(BLEZL), L(BGTZL),
+        L(DADDI), L(DADDIU), L(LDL), L(LDR), L(SV), L(SV), L(SV), L(SV),
+        L(LB), L(LH), L(LWL), L(LW), L(LBU), L(LHU), L(LWR), L(LWU),
+        L(SB), L(SH), L(SWL), L(SW), L(SDL), L(SDR), L(SWR), L(CACHE),
+        L(LL), L(LWC1), L(SV), L(SV), L(LLD), L(LDC1), L(SV), L(LD),
+        L(SC), L(SWC1), L(SV), L(SV), L(SCD), L(SDC1), L(SV), L(SD)
+    };
+
+    static void* const special[64] =
+    {
+        L(SLL), L(SV), L(SRL), L(SRA), L(SLLV), L(SV), L(SRLV), L(SRAV),
+        L(JR), L(JALR), L(SV), L(SV), L(SYSCALL), L(BREAK), L(SV), L(SYNC),
+        L(MFHI), L(MTHI), L(MFLO), L(MTLO), L(DSLLV), L(SV), L(DSRLV), L(DSRAV),
+        L(MULT), L(MULTU), L(DIV), L(DIVU), L(DMULT), L(DMULTU), L(DDIV), L(DDIVU),
+        L(ADD), L(ADDU), L(SUB), L(SUBU), L(AND), L(OR), L(XOR), L(NOR),
+        L(SV), L(SV), L(SLT), L(SLTU), L(DADD), L(DADDU), L(DSUB), L(DSUBU),
+        L(TGE), L(TGEU), L(TLT), L(TLTU), L(TEQ), L(SV), L(TNE), L(SV),
+        L(DSLL), L(SV), L(DSRL), L(DSRA), L(DSLL32), L(SV), L(DSRL32), L(DSRA32)
+    };
+
+    static void* const regimm[32] =
+    {
+        L(BLTZ), L(BGEZ), L(BLTZL), L(BGEZL), L(SV), L(SV), L(SV), L(SV),
+        L(TGEI), L(TGEIU), L(TLTI), L(TLTIU), L(TEQI), L(SV), L(TNEI), L(SV),
+        L(BLTZAL), L(BGEZAL), L(BLTZALL), L(BGEZALL), L(SV), L(SV), L(SV), L(SV),
+        L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV)
+    };
+
+    static void* const cop0[32] =
+    {
+        L(MFC0), L(SV), L(SV), L(SV), L(MTC0), L(SV), L(SV), L(SV),
+        L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV),
+        L(TLB), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV),
+        L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV)
+    };
+
+    static void* const cop1[32] =
+    {
+        L(MFC1), L(DMFC1), L(CFC1), L(SV), L(MTC1), L(DMTC1), L(CTC1), L(SV),
+        L(BC), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV),
+        L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV),
+        L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV)
+    };
+
+    static void* const s[64] =
+    {
+        L(ADD_S), L(SUB_S), L(MUL_S), L(DIV_S), L(SQRT_S), L(ABS_S), L(MOV_S), L(NEG_S),
+        L(ROUND_L_S), L(TRUNC_L_S), L(CEIL_L_S), L(FLOOR_L_S), L(ROUND_W_S), L(TRUNC_W_S), L(CEIL_W_S), L(FLOOR_W_S),
+        L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV),
+        L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV),
+        L(SV), L(CVT_D_S), L(SV), L(SV), L(CVT_W_S), L(CVT_L_S), L(SV), L(SV),
+        L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV),
+        L(C_F_S), L(C_UN_S), L(C_EQ_S), L(C_UEQ_S), L(C_OLT_S), L(C_ULT_S), L(C_OLE_S), L(C_ULE_S),
+        L(C_SF_S), L(C_NGLE_S), L(C_SEQ_S), L(C_NGL_S), L(C_LT_S), L(C_NGE_S), L(C_LE_S), L(C_NGT_S)
+    };
+
+    static void* const d[64] =
+    {
+        L(ADD_D), L(SUB_D), L(MUL_D), L(DIV_D), L(SQRT_D), L(ABS_D), L(MOV_D), L(NEG_D),
+        L(ROUND_L_D), L(TRUNC_L_D), L(CEIL_L_D), L(FLOOR_L_D), L(ROUND_W_D), L(TRUNC_W_D), L(CEIL_W_D), L(FLOOR_W_D),
+        L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV),
+        L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV),
+        L(CVT_S_D), L(SV), L(SV), L(SV), L(CVT_W_D), L(CVT_L_D), L(SV), L(SV),
+        L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV),
+        L(C_F_D), L(C_UN_D), L(C_EQ_D), L(C_UEQ_D), L(C_OLT_D), L(C_ULT_D), L(C_OLE_D), L(C_ULE_D),
+        L(C_SF_D), L(C_NGLE_D), L(C_SEQ_D), L(C_NGL_D), L(C_LT_D), L(C_NGE_D), L(C_LE_D), L(C_NGT_D)
+    };
+
+    static void* const w[64] =
+    {
+        L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV),
+        L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV),
+        L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV),
+        L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV),
+        L(CVT_S_W), L(CVT_D_W), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV),
+        L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV),
+        L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV),
+        L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV)
+    };
+
+    static void* const l[64] =
+    {
+        L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV),
+        L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV),
+        L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV),
+        L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV),
+        L(CVT_S_L), L(CVT_D_L), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV),
+        L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV),
+        L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV),
+        L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV), L(SV)
+    };
+
+    // filled on the first run of each variant, FR changes come back here
+    static void* labels[KEY_COUNT];
+    static bool labels_built = false;
+
+    if (!labels_built)
+    {
+        for (uint32_t i = 0; i < 64; i++)
+        {
+            labels[KEY_PRIMARY + i] = primary[i];
+            labels[KEY_SPECIAL + i] = special[i];
+        }
+
+        for (uint32_t i = 0; i < 32; i++)
+        {
+            labels[KEY_REGIMM + i] = regimm[i];
+            labels[KEY_COP0 + i] = cop0[i];
+        }
+
+        for (uint32_t fmt = 0; fmt < 32; fmt++)
+        {
+            for (uint32_t func = 0; func < 64; func++)
+            {
+                void* label;
+
+                switch (fmt)
+                {
+                case 16: label = s[func]; break;
+                case 17: label = d[func]; break;
+                case 20: label = w[func]; break;
+                case 21: label = l[func]; break;
+                default: label = cop1[fmt]; break;
+                }
+
+                labels[KEY_COP1 + fmt * 64 + func] = label;
+            }
+        }
+
+        labels_built = true;
+    }
+
+    DISPATCH();
+
+    BRANCH(J)
+    BRANCH(JAL)
+    BRANCH(BEQ)
+    BRANCH(BNE)
+    BRANCH(BLEZ)
+    BRANCH(BGTZ)
+    HANDLER(ADDI)
+    HANDLER(ADDIU)
+    HANDLER(SLTI)
+    HANDLER(SLTIU)
+    HANDLER(ANDI)
+    HANDLER(ORI)
+    HANDLER(XORI)
+    HANDLER(LUI)
+    HANDLER(SV)
+    BRANCH(BEQL)
+    BRANCH(BNEL)
+    BRANCH(BLEZL)
+    BRANCH(BGTZL)
+    HANDLER(DADDI)
+    HANDLER(DADDIU)
+    HANDLER(LDL)
+    HANDLER(LDR)
+    HANDLER(LB)
+    HANDLER(LH)
+    HANDLER(LWL)
+    HANDLER(LW)
+    HANDLER(LBU)
+    HANDLER(LHU)
+    HANDLER(LWR)
+    HANDLER(LWU)
+    HANDLER(SB)
+    HANDLER(SH)
+    HANDLER(SWL)
+    HANDLER(SW)
+    HANDLER(SDL)
+    HANDLER(SDR)
+    HANDLER(SWR)
+    HANDLER(CACHE)
+    HANDLER(LL)
+    FPR(LWC1)
+    HANDLER(LLD)
+    FPR(LDC1)
+    HANDLER(LD)
+    HANDLER(SC)
+    FPR(SWC1)
+    HANDLER(SCD)
+    FPR(SDC1)
+    HANDLER(SD)
+    HANDLER(SLL)
+    HANDLER(SRL)
+    HANDLER(SRA)
+    HANDLER(SLLV)
+    HANDLER(SRLV)
+    HANDLER(SRAV)
+    BRANCH(JR)
+    BRANCH(JALR)
+    HANDLER(SYSCALL)
+    HANDLER(BREAK)
+    HANDLER(SYNC)
+    HANDLER(MFHI)
+    HANDLER(MTHI)
+    HANDLER(MFLO)
+    HANDLER(MTLO)
+    HANDLER(DSLLV)
+    HANDLER(DSRLV)
+    HANDLER(DSRAV)
+    HANDLER(MULT)
+    HANDLER(MULTU)
+    HANDLER(DIV)
+    HANDLER(DIVU)
+    HANDLER(DMULT)
+    HANDLER(DMULTU)
+    HANDLER(DDIV)
+    HANDLER(DDIVU)
+    HANDLER(ADD)
+    HANDLER(ADDU)
+    HANDLER(SUB)
+    HANDLER(SUBU)
+    HANDLER(AND)
+    HANDLER(OR)
+    HANDLER(XOR)
+    HANDLER(NOR)
+    HANDLER(SLT)
+    HANDLER(SLTU)
+    HANDLER(DADD)
+    HANDLER(DADDU)
+    HANDLER(DSUB)
+    HANDLER(DSUBU)
+    HANDLER(TGE)
+    HANDLER(TGEU)
+    HANDLER(TLT)
+    HANDLER(TLTU)
+    HANDLER(TEQ)
+    HANDLER(TNE)
+    HANDLER(DSLL)
+    HANDLER(DSRL)
+    HANDLER(DSRA)
+    HANDLER(DSLL32)
+    HANDLER(DSRL32)
+    HANDLER(DSRA32)
+    BRANCH(BLTZ)
+    BRANCH(BGEZ)
+    BRANCH(BLTZL)
+    BRANCH(BGEZL)
+    HANDLER(TGEI)
+    HANDLER(TGEIU)
+    HANDLER(TLTI)
+    HANDLER(TLTIU)
+    HANDLER(TEQI)
+    HANDLER(TNEI)
+    BRANCH(BLTZAL)
+    BRANCH(BGEZAL)
+    BRANCH(BLTZALL)
+    BRANCH(BGEZALL)
+    HANDLER(MFC0)
+    STATUS(MTC0)
+    STATUS(TLB)
+    FPR(MFC1)
+    FPR(DMFC1)
+    HANDLER(CFC1)
+    FPR(MTC1)
+    FPR(DMTC1)
+    HANDLER(CTC1)
+
+    op_BC:
+    switch (_cur_instr.ft)
+    {
+    case 0: Interpreter::BC1F<CountPerOp>(); break;
+    case 1: Interpreter::BC1T<CountPerOp>(); break;
+    case 2: Interpreter::BC1FL<CountPerOp>(); break;
+    case 3: Interpreter::BC1TL<CountPerOp>(); break;
+    default: Interpreter::SV(); break;
+    }
+    LEAVE_ON_FR();
+    DISPATCH();
+
+    FPR(ADD_S)
+    FPR(SUB_S)
+    FPR(MUL_S)
+    FPR(DIV_S)
+    FPR(SQRT_S)
+    FPR(ABS_S)
+    FPR(MOV_S)
+    FPR(NEG_S)
+    HANDLER(ROUND_L_S)
+    FPR(TRUNC_L_S)
+    HANDLER(CEIL_L_S)
+    HANDLER(FLOOR_L_S)
+    FPR(ROUND_W_S)
+    FPR(TRUNC_W_S)
+    HANDLER(CEIL_W_S)
+    HANDLER(FLOOR_W_S)
+    FPR(CVT_D_S)
+    FPR(CVT_W_S)
+    FPR(CVT_L_S)
+    HANDLER(C_F_S)
+    HANDLER(C_UN_S)
+    FPR(C_EQ_S)
+    FPR(C_UEQ_S)
+    FPR(C_OLT_S)
+    FPR(C_ULT_S)
+    FPR(C_OLE_S)
+    HANDLER(C_ULE_S)
+    HANDLER(C_SF_S)
+    HANDLER(C_NGLE_S)
+    HANDLER(C_SEQ_S)
+    HANDLER(C_NGL_S)
+    FPR(C_LT_S)
+    HANDLER(C_NGE_S)
+    FPR(C_LE_S)
+    FPR(C_NGT_S)
+    FPR(ADD_D)
+    FPR(SUB_D)
+    FPR(MUL_D)
+    FPR(DIV_D)
+    FPR(SQRT_D)
+    FPR(ABS_D)
+    FPR(MOV_D)
+    FPR(NEG_D)
+    HANDLER(ROUND_L_D)
+    HANDLER(TRUNC_L_D)
+    HANDLER(CEIL_L_D)
+    HANDLER(FLOOR_L_D)
+    FPR(ROUND_W_D)
+    FPR(TRUNC_W_D)
+    HANDLER(CEIL_W_D)
+    HANDLER(FLOOR_W_D)
+    FPR(CVT_S_D)
+    FPR(CVT_W_D)
+    FPR(CVT_L_D)
+    HANDLER(C_F_D)
+    HANDLER(C_UN_D)
+    FPR(C_EQ_D)
+    HANDLER(C_UEQ_D)
+    HANDLER(C_OLT_D)
+    HANDLER(C_ULT_D)
+    HANDLER(C_OLE_D)
+    HANDLER(C_ULE_D)
+    HANDLER(C_SF_D)
+    HANDLER(C_NGLE_D)
+    HANDLER(C_SEQ_D)
+    HANDLER(C_NGL_D)
+    FPR(C_LT_D)
+    HANDLER(C_NGE_D)
+    FPR(C_LE_D)
+    HANDLER(C_NGT_D)
+    FPR(CVT_S_W)
+    FPR(CVT_D_W)
+    FPR(CVT_S_L)
+    FPR(CVT_D_L)
+}
+
+#undef LEAVE_ON_FR
+#undef DISPATCH
+#undef STATUS
+#undef FPR
+#undef BRANCH
+#undef HANDLER
+#undef L
+
+#endif
@@ -1,9 +1,13 @@
+#include <algorithm>
+
 #include <oplog.h>
+#include <oppreproc.h>
 
 #include "icpu.h"
 #include "interrupthandler.h"
 #include "cp0.h"
 
+#include <core/savestate.h>
 #include <core/systiming.h>
 #include <cheat/cheatengine.h>
 #include <mem/imemory.h>
@@ -16,49 +20,24 @@
 #include <ui/corecontrol.h>
 
 
-static bool _SPECIAL_done = false;
-
-bool Interrupt::operator<(const Interrupt& i) const
+void InterruptHandler::updateNextEvent(void)
 {
-    if (this->count - Bus::state.cp0_reg[CP0_COUNT_REG] < 0x80000000)
-    {
-        if (i.count - Bus::state.cp0_reg[CP0_COUNT_REG] < 0x80000000)
-        {
-            if ((this->count - Bus::state.cp0_reg[CP0_COUNT_REG]) < (i.count - Bus::state.cp0_reg[CP0_COUNT_REG]))
-                return true;
+    // pending CHECK_INT is stored as 0 so it always comes first
+    uint64_t best = _events[0];
+    uint32_t best_order = _order[0];
+    uint32_t slot = 0;
 
-            return false;
-        }
-        else
-        {
-            if ((Bus::state.cp0_reg[CP0_COUNT_REG] - i.count) < 0x10000000)
-            {
-                switch (i.type)
-                {
-                case SPECIAL_INT:
-                    if (_SPECIAL_done)
-                        return true;
-                    else
-                        return false;
-                    break;
-                default:
-                    return false;
-                }
-            }
-            
-            return true;
-        }
+    // events due at the same cycle run in the order they were added
+    for (uint32_t i = 1; i < NUM_EVENT_TYPES; i++)
+    {
+        bool earlier = _events[i] < best || (_events[i] == best && (int32_t)(_order[i] - best_order) < 0);
+        best = earlier ? _events[i] : best;
+        best_order = earlier ? _order[i] : best_order;
+        slot = earlier ? i : slot;
     }
 
-    return false;
-}
-
-bool Interrupt::operator==(const Interrupt& i) const
-{
-    if (this->type == i.type)
-        return true;
-
-    return false;
+    _next = (best != EVENT_NONE) ? (1 << slot) : 0;
+    Bus::state.next_interrupt = best;
 }
 
 InterruptHandler::InterruptHandler(void)
@@ -74,53 +53,38 @@ void InterruptHandler::initialize(Bus* bus)
     _bus = bus;
 
     Bus::state.interrupt_unsafe_state = false;
-    _SPECIAL_done = true;
-    Bus::state.next_vi = Bus::state.next_interrupt = 5000;
-    Bus::state.vi_delay = Bus::state.next_vi;
+    Bus::state.next_vi = Bus::state.cycles + 5000;
+    Bus::state.vi_delay = 5000;
     Bus::state.vi_field = 0;
 
     // reset the queue
-    q.clear();
+    fill_array(_events, 0, NUM_EVENT_TYPES, EVENT_NONE);
+    fill_array(_order, 0, NUM_EVENT_TYPES, 0u);
+    _next_order = 0;
 
     addInterruptEventCount(VI_INT, Bus::state.next_vi);
-    addInterruptEventCount(SPECIAL_INT, 0);
 }
 
-void InterruptHandler::addInterruptEvent(int32_t type, uint32_t delay)
+void InterruptHandler::addInterruptEvent(int32_t type, uint64_t delay)
 {
-    if (findEvent(type)) {
-        LOG_WARNING(InterruptHandler) << "Two events of type 0x" << std::hex << type << " in interrupt queue";
-    }
-
-    uint32_t count = Bus::state.cp0_reg[CP0_COUNT_REG] + delay;
-    bool special = (type == SPECIAL_INT);
-
-    if (Bus::state.cp0_reg[CP0_COUNT_REG] > 0x80000000)
-        _SPECIAL_done = false;
-
-    Interrupt event(type, count);
-
-    auto iter = q.begin();
+    addInterruptEventCount(type, Bus::state.cycles + delay);
+}
 
-    for (; iter != q.end(); iter++)
+void InterruptHandler::addInterruptEventCount(int32_t type, uint64_t count)
+{
+    if (!isEventType(type))
     {
-        if (event < *iter && !special)
-            break;
+        LOG_WARNING(InterruptHandler) << "Unknown interrupt queue event type " << std::hex << type;
+        return;
     }
 
-    if (iter != q.end() && type != SPECIAL_INT)
-    {
-        while (iter != q.end() && (*iter).count == count)
-            iter++;
+    if (findEvent(type)) {
+        LOG_WARNING(InterruptHandler) << "Two events of type 0x" << std::hex << type << " in interrupt queue";
     }
-    
-    q.insert(iter, event);
-    Bus::state.next_interrupt = q.front().count;
-}
 
-void InterruptHandler::addInterruptEventCount(int32_t type, uint32_t count)
-{
-    addInterruptEvent(type, (count - Bus::state.cp0_reg[CP0_COUNT_REG]));
+    _events[eventSlot(type)] = count;
+    _order[eventSlot(type)] = _next_order++;
+    updateNextEvent();
 }
 
 void InterruptHandler::generateInterrupt(void)
@@ -138,57 +102,62 @@ void InterruptHandler::generateInterrupt(void)
             CoreControl::doHardReset = false;
             return;
         }
+
+        // a loaded state brings its own queue, _next is read after this
+        if (SaveState::pending())
+        {
+            SaveState::process(_bus);
+        }
+
+        if (_bus->rewind->pending())
+        {
+            _bus->rewind->process(_bus);
+        }
+        else if (_next == VI_INT)
+        {
+            _bus->rewind->vi(_bus);
+        }
     }
 
-    Interrupt& top = q.front();
+    // a task on the RSP thread may turn out not to raise its interrupt
+    if (_next == SP_INT && Bus::rcp.sp.syncTask(_bus) && _next != SP_INT)
+        return;
+
+    if (_next == 0)
+        return;
+
+    int32_t top = _next;
 
     if (Bus::state.skip_jump)
     {
         uint32_t dest = Bus::state.skip_jump;
         Bus::state.skip_jump = 0;
 
-        if (top.count > Bus::state.cp0_reg[CP0_COUNT_REG] || (Bus::state.cp0_reg[CP0_COUNT_REG] - top.count) < 0x80000000)
-        {
-            Bus::state.next_interrupt = top.count;
-        }
-        else
-        {
-            Bus::state.next_interrupt = 0;
-        }
-
+        Bus::state.next_interrupt = _events[eventSlot(top)];
         Bus::state.last_jump_addr = dest;
         _bus->cpu->globalJump(dest);
         return;
     }
 
-    switch (top.type)
-    {
-    case SPECIAL_INT:
+    switch (top)
     {
-        if (Bus::state.cp0_reg[CP0_COUNT_REG] > 0x10000000)
-            return;
-
-        popInterruptEvent();
-        addInterruptEventCount(SPECIAL_INT, 0);
-        return;
-    }
-        break;
     case VI_INT:
     {
         if (_vi_counter < 60)
         {
             if (_vi_counter == 0)
             {
-                _bus->cheat->applyCheats(ENTRY_BOOT);
+                _bus->cheat->applyCheats(_bus, ENTRY_BOOT);
             }
             _vi_counter++;
         }
         else
         {
-            _bus->cheat->applyCheats(ENTRY_VI);
+            _bus->cheat->applyCheats(_bus, ENTRY_VI);
         }
 
         _bus->plugins->gfx()->UpdateScreen();
+        _bus->cpu->invalidateHostRounding();
 
         _bus->systimer->doVILimit();
 
@@ -221,10 +190,11 @@ void InterruptHandler::generateInterrupt(void)
         break;
     case COMPARE_INT:
     {
+        // COUNT matches COMPARE again after a full wrap
+        uint32_t delay = Bus::state.cp0_reg[CP0_COMPARE_REG] - Bus::state.cp0_reg[CP0_COUNT_REG];
+
         popInterruptEvent();
-        Bus::state.cp0_reg[CP0_COUNT_REG] += _bus->rom->getCountPerOp();
-        addInterruptEventCount(COMPARE_INT, Bus::state.cp0_reg[CP0_COMPARE_REG]);
-        Bus::state.cp0_reg[CP0_COUNT_REG] -= _bus->rom->getCountPerOp();
+        addInterruptEvent(COMPARE_INT, (delay != 0) ? delay : 0x100000000ULL);
 
         Bus::state.cp0_reg[CP0_CAUSE_REG] = (Bus::state.cp0_reg[CP0_CAUSE_REG] | 0x8000) & 0xFFFFFF83;
         if ((Bus::state.cp0_reg[CP0_STATUS_REG] & 7) != 1)
@@ -286,7 +256,7 @@ void InterruptHandler::generateInterrupt(void)
     {
         if (Bus::rcp.ai.reg[AI_STATUS_REG] & 0x80000000) // full
         {
-            uint32_t ai_event = findEvent(AI_INT);
+            uint64_t ai_event = findEvent(AI_INT);
             popInterruptEvent();
             Bus::rcp.ai.reg[AI_STATUS_REG] &= ~0x80000000;
             Bus::rcp.ai.fifo[0].delay = Bus::rcp.ai.fifo[1].delay;
@@ -394,6 +364,7 @@ void InterruptHandler::generateInterrupt(void)
         break;
     case NMI_INT:
     {
+        Bus::rcp.sp.syncTask(_bus);
         popInterruptEvent();
         // setup r4300 Status flags: reset TS and SR, set BEV, ERL, and SR
         Bus::state.cp0_reg[CP0_STATUS_REG] = (Bus::state.cp0_reg[CP0_STATUS_REG] & ~0x00380000) | 0x00500004;
@@ -401,7 +372,7 @@ void InterruptHandler::generateInterrupt(void)
         // simulate the soft reset code which would run from the PIF ROM
         _bus->cpu->softReset();
         // clear all interrupts, reset interrupt counters back to 0
-        Bus::state.cp0_reg[CP0_COUNT_REG] = 0;
+        _bus->cpu->getCP0().setCount(0);
         _vi_counter = 0;
         initialize(_bus);
         // clear the audio status register so that subsequent write_ai() calls will work properly
@@ -425,19 +396,18 @@ void InterruptHandler::generateInterrupt(void)
         break;
     default:
     {
-        LOG_WARNING(InterruptHandler) << "Unknown interrupt queue event type " << std::hex << top.type;
+        LOG_WARNING(InterruptHandler) << "Unknown interrupt queue event type " << std::hex << top;
         popInterruptEvent();
     }
         break;
     }
 
     _bus->cpu->generalException();
-
-    // TODO future savestate
 }
 
 void InterruptHandler::doHardReset(void)
 {
+    Bus::rcp.sp.syncTask(_bus);
     _bus->mem->initialize(_bus);
     _bus->cpu->hardReset();
     _bus->cpu->softReset();
@@ -457,27 +427,18 @@ void InterruptHandler::doHardReset(void)
 
 void InterruptHandler::popInterruptEvent(void)
 {
-    if (q.front().type == SPECIAL_INT)
-        _SPECIAL_done = true;
-
-    q.pop_front();
+    if (_next == 0)
+        return;
 
-    if (!q.empty() && (q.front().count > Bus::state.cp0_reg[CP0_COUNT_REG] || (Bus::state.cp0_reg[CP0_COUNT_REG] - q.front().count) < 0x80000000))
-    {
-        Bus::state.next_interrupt = q.front().count;
-    }
-    else
-    {
-        Bus::state.next_interrupt = 0;
-    }
+    _events[eventSlot(_next)] = EVENT_NONE;
+    updateNextEvent();
 }
 
-uint32_t InterruptHandler::findEvent(int32_t type)
+uint64_t InterruptHandler::findEvent(int32_t type)
 {
-    auto event = std::find(q.begin(), q.end(), Interrupt(type));
-    if (event != q.end())
+    if (isEventType(type) && _events[eventSlot(type)] != EVENT_NONE)
     {
-        return (*event).count;
+        return _events[eventSlot(type)];
     }
 
     return 0;
@@ -500,34 +461,25 @@ void InterruptHandler::checkInterrupt(void)
     if (Bus::state.cp0_reg[CP0_STATUS_REG] & Bus::state.cp0_reg[CP0_CAUSE_REG] & 0xFF00)
     {
         // Overrides the sort and make this the next interrupt
-        q.push_front(Interrupt(CHECK_INT, Bus::state.cp0_reg[CP0_COUNT_REG]));
-        Bus::state.next_interrupt = Bus::state.cp0_reg[CP0_COUNT_REG];
+        _events[eventSlot(CHECK_INT)] = 0;
+        _order[eventSlot(CHECK_INT)] = _next_order++;
+        updateNextEvent();
     }
 }
 
 void InterruptHandler::deleteEvent(int32_t type)
 {
-    if (q.empty())
+    if (!isEventType(type))
         return;
 
-    auto event = std::find(q.begin(), q.end(), Interrupt(type));
-    if (event != q.end())
-    {
-        q.erase(event);
-    }
+    _events[eventSlot(type)] = EVENT_NONE;
+    updateNextEvent();
 }
 
-void InterruptHandler::translateEventQueueBy(uint32_t base)
+void InterruptHandler::scheduleCompare(void)
 {
     deleteEvent(COMPARE_INT);
-    deleteEvent(SPECIAL_INT);
-
-    std::for_each(q.begin(), q.end(), [&](Interrupt& i){
-        i.count = (i.count - Bus::state.cp0_reg[CP0_COUNT_REG]) + base;
-    });
-
-    addInterruptEventCount(COMPARE_INT, Bus::state.cp0_reg[CP0_COMPARE_REG]);
-    addInterruptEventCount(SPECIAL_INT, 0);
+    addInterruptEvent(COMPARE_INT, (uint32_t)(Bus::state.cp0_reg[CP0_COMPARE_REG] - Bus::state.cp0_reg[CP0_COUNT_REG]));
 }
 
 void InterruptHandler::softReset(void)
@@ -535,3 +487,26 @@ void InterruptHandler::softReset(void)
     addInterruptEvent(HW2_INT, 0);  /* Hardware 2 Interrupt immediately */
     addInterruptEvent(NMI_INT, 50000000);  /* Non maskable Interrupt after 1/2 second */
 }
+
+void InterruptHandler::saveState(StateWriter& writer)
+{
+    writer.putBytes(_events, sizeof(_events));
+    writer.putBytes(_order, sizeof(_order));
+    writer.put(_next_order);
+    writer.put(_next);
+    writer.put(_vi_counter);
+}
+
+void InterruptHandler::loadState(StateReader& reader)
+{
+    reader.getBytes(_events, sizeof(_events));
+    reader.getBytes(_order, sizeof(_order));
+    reader.get(_next_order);
+    reader.get(_next);
+    reader.get(_vi_counter);
+
+    if (_next != 0 && !isEventType(_next))
+    {
+        _next = 0;
+    }
+}
@@ -1,52 +1,25 @@
 #pragma once
 #include <cstdint>
-#include <deque>
 
 #define VI_INT      0x001
 #define COMPARE_INT 0x002
 #define CHECK_INT   0x004
 #define SI_INT      0x008
 #define PI_INT      0x010
-#define SPECIAL_INT 0x020
 #define AI_INT      0x040
 #define SP_INT      0x080
 #define DP_INT      0x100
 #define HW2_INT     0x200
 #define NMI_INT     0x400
 
-class Bus;
-
-struct Interrupt
-{
-    int32_t type;
-    uint32_t count;
-
-    Interrupt(int32_t t) : type(t), count(0)
-    {}
+#define NUM_EVENT_TYPES 11
 
-    Interrupt(int32_t t, uint32_t c) : type(t), count(c)
-    {}
+// slot value of an event type that is not scheduled
+#define EVENT_NONE UINT64_MAX
 
-    Interrupt(const Interrupt& x) : type(x.type), count(x.count)
-    {}
-
-    Interrupt& operator= (const Interrupt& x)
-    {
-        if (this != &x)
-        {
-            type = x.type;
-            count = x.count;
-        }
-
-        return *this;
-    }
-
-    bool operator<(const Interrupt& i) const;
-    bool operator==(const Interrupt& i) const;
-};
-
-
-typedef std::deque<Interrupt> InterruptQueue;
+class Bus;
+class StateReader;
+class StateWriter;
 
 class InterruptHandler
 {
@@ -55,25 +28,59 @@ public:
     ~InterruptHandler(void);
 
     void initialize(Bus* bus);
-    void addInterruptEvent(int32_t type, uint32_t delay);
-    void addInterruptEventCount(int32_t type, uint32_t count);
+
+    // delay and count are in cycles, see ProgramState::cycles
+    void addInterruptEvent(int32_t type, uint64_t delay);
+    void addInterruptEventCount(int32_t type, uint64_t count);
     void generateInterrupt(void);
     void checkInterrupt(void);
-    uint32_t findEvent(int32_t type);
+    uint64_t findEvent(int32_t type);
     void deleteEvent(int32_t type);
-    void translateEventQueueBy(uint32_t base);
+
+    // reschedules the timer interrupt after a write to COUNT or COMPARE
+    void scheduleCompare(void);
 
     void softReset(void);
 
+    void saveState(StateWriter& writer);
+    void loadState(StateReader& reader);
+
 private:
     void doHardReset(void);
     void popInterruptEvent(void);
+    void updateNextEvent(void);
+
+    static inline bool isEventType(int32_t type)
+    {
+        return type > 0 && type <= NMI_INT && !(type & (type - 1));
+    }
+
+    static inline uint32_t eventSlot(int32_t type)
+    {
+        uint32_t slot = 0;
+
+        while (!(type & 1))
+        {
+            type >>= 1;
+            slot++;
+        }
+
+        return slot;
+    }
 
 private:
     // alias
     Bus* _bus;
 
-    InterruptQueue q;
+    // cycle each event type is due at, or EVENT_NONE
+    uint64_t _events[NUM_EVENT_TYPES];
+
+    // when each event was added, keeps events due at the same cycle FIFO
+    uint32_t _order[NUM_EVENT_TYPES];
+    uint32_t _next_order = 0;
+
+    // type of the next event to run, 0 if none are pending
+    int32_t _next = 0;
 
     int32_t _vi_counter = 0;
 };
@@ -0,0 +1,612 @@
+#include <vector>
+
+#include <oplog.h>
+#include <oputil.h>
+
+#include <globalstrings.h>
+
+#include <cpu/recompiler.h>
+#include <cpu/interrupthandler.h>
+
+#include <mem/fastmem.h>
+#include <rom/rom.h>
+#include <ui/configstore.h>
+
+using namespace GlobalStrings;
+
+
+#define CODE_BUFFER_SIZE (32 * 1024 * 1024)
+#define MAX_BLOCK_INSTRUCTIONS 128
+#define MAX_BLOCK_CODE_SIZE (MAX_BLOCK_INSTRUCTIONS * 128 + 64)
+
+// calling convention
+#ifdef _MSC_VER
+static const X64Reg ARG_REG[3] = { RCX, RDX, R8 };
+#else
+static const X64Reg ARG_REG[3] = { RDI, RSI, RDX };
+#endif
+
+// holds &_reg[0] in generated code
+static const X64Reg BASE_REG = RBX;
+
+
+bool Recompiler::initialize(Bus* bus)
+{
+    LOG_INFO(Recompiler) << "Initializing...";
+
+    if (!_emitter.allocate(CODE_BUFFER_SIZE))
+    {
+        LOG_ERROR(Recompiler) << "Could not allocate code buffer";
+        return false;
+    }
+
+    _fastmem = false;
+
+    if (ConfigStore::getInstance().getBool(CFG_SECTION_CORE, CFG_FASTMEM))
+    {
+        _fastmem = FastMem::getInstance().map(&Recompiler::handleFault, this);
+    }
+
+    return Interpreter::initialize(bus);
+}
+
+void Recompiler::uninitialize(Bus* bus)
+{
+    flushBlocks();
+    _emitter.release();
+
+    if (_fastmem)
+    {
+        FastMem::getInstance().unmap();
+        _fastmem = false;
+    }
+
+    Interpreter::uninitialize(bus);
+}
+
+void Recompiler::hardReset(void)
+{
+    flushBlocks();
+
+    Interpreter::hardReset();
+}
+
+void Recompiler::execute(void)
+{
+    LOG_INFO(Recompiler) << "Running...";
+    beginExecution();
+
+    while (!CoreControl::stop)
+    {
+        uint32_t* host = _bus->mem->fetch(Bus::state.PC);
+
+        if (nullptr == host)
+        {
+            LOG_ERROR(Recompiler) << "Execution address " << std::hex << (uint32_t)Bus::state.PC << " not found. Stopping...";
+            CoreControl::stop = true;
+            break;
+        }
+
+        CodeBlock* block = getBlock(Bus::state.PC, host);
+
+        if (nullptr == block)
+        {
+            // not cacheable, interpret one instruction
+            step(host);
+            continue;
+        }
+
+        uint32_t end = block->end;
+        _block_invalidated = false;
+
+        if (block->code())
+        {
+            // ran off the end of the block without leaving it
+            Bus::state.PC = end;
+        }
+    }
+}
+
+void Recompiler::invalidateCodePage(uint32_t page)
+{
+    _blocks.invalidatePage(page);
+    FastMem::getInstance().protectCode(page, false);
+    _block_invalidated = true;
+}
+
+void Recompiler::flushBlocks(void)
+{
+    for (uint32_t page = 0; page < CODE_PAGE_COUNT; page++)
+    {
+        if (_code_pages[page])
+        {
+            FastMem::getInstance().protectCode(page, false);
+        }
+    }
+
+    _blocks.clear();
+    fill_array(_code_pages, 0, CODE_PAGE_COUNT, false);
+    _fastmem_sites.clear();
+    _emitter.reset();
+
+    _block_invalidated = true;
+}
+
+uint32_t Recompiler::interpretInstruction(Recompiler* cpu, uint32_t pc, const uint32_t* host)
+{
+    Bus::state.PC = pc;
+    cpu->step(host);
+
+    return ((uint32_t)Bus::state.PC == pc + 4) && !cpu->_block_invalidated && !CoreControl::stop;
+}
+
+bool Recompiler::handleFault(void* context, uintptr_t* rip, bool transient)
+{
+    Recompiler* cpu = (Recompiler*)context;
+    auto it = cpu->_fastmem_sites.find(*rip);
+
+    if (it == cpu->_fastmem_sites.end())
+    {
+        return false;
+    }
+
+    // accesses that keep faulting (MMIO, TLB mapped, framebuffer) go
+    // straight to the interpreter from now on
+    if (!transient)
+    {
+        X64Emitter::patchJump(it->second.start, it->second.slow);
+    }
+
+    *rip = (uintptr_t)it->second.slow;
+
+    return true;
+}
+
+Recompiler::CodeBlock* Recompiler::getBlock(uint32_t pc, uint32_t* host)
+{
+    // only code in RDRAM is compiled
+    uint8_t* rdram = (uint8_t*)Bus::rdram.mem;
+
+    if ((uint8_t*)host < rdram || (uint8_t*)host >= rdram + RDRAM_SIZE)
+    {
+        return nullptr;
+    }
+
+    uint32_t physaddr = (uint32_t)((uint8_t*)host - rdram);
+    CodeBlock* block = _blocks.find(physaddr);
+
+    if (nullptr == block || block->address != pc)
+    {
+        block = compileBlock(pc, host, physaddr);
+    }
+
+    return block;
+}
+
+Recompiler::CodeBlock* Recompiler::compileBlock(uint32_t pc, uint32_t* host, uint32_t physaddr)
+{
+    if (_emitter.freeSpace() < MAX_BLOCK_CODE_SIZE)
+    {
+        LOG_DEBUG(Recompiler) << "Code buffer full, flushing";
+        flushBlocks();
+    }
+
+    CodeBlock* block = new CodeBlock;
+    block->address = pc;
+    block->code = (BlockFunc)_emitter.getCursor();
+
+    // prologue, keeping the stack aligned and leaving shadow space for calls
+    _emitter.push(BASE_REG);
+    _emitter.aluRegImm(ALU_SUB, RSP, 32, true);
+    _emitter.movRegImm64(BASE_REG, (uint64_t)(uintptr_t)_reg);
+
+    struct SlowPath
+    {
+        uint8_t* start;
+        uint8_t* access;
+        uint8_t* resume;
+        uint32_t pc;
+        const uint32_t* host;
+    };
+
+    std::vector<uint8_t*> exits;
+    std::vector<SlowPath> slowpaths;
+    bool terminated = false;
+
+    for (uint32_t count = 0; count < MAX_BLOCK_INSTRUCTIONS; count++)
+    {
+        Instruction instr;
+        instr.code = host[0];
+
+        uint8_t* start = _emitter.getCursor();
+        uint8_t* access = _fastmem ? compileMemoryAccess(instr) : nullptr;
+
+        if (nullptr != access)
+        {
+            slowpaths.push_back({ start, access, _emitter.getCursor(), pc, host });
+        }
+        else if (!compileInstruction(instr))
+        {
+            compileInterpreterCall(pc, host);
+
+            if (isBlockEnd(instr))
+            {
+                // PC has already been set by the branch
+                exits.push_back(_emitter.jmp());
+                terminated = true;
+                break;
+            }
+
+            _emitter.testRegReg8(RAX, RAX);
+            exits.push_back(_emitter.jcc(CC_E));
+        }
+
+        pc += 4;
+        host++;
+
+        // blocks never cross a page so they can be dropped per page
+        if ((pc & 0xFFF) == 0)
+        {
+            break;
+        }
+    }
+
+    block->end = pc;
+
+    if (!terminated)
+    {
+        _emitter.movRegImm32(RAX, 1);
+        _emitter.aluRegImm(ALU_ADD, RSP, 32, true);
+        _emitter.pop(BASE_REG);
+        _emitter.ret();
+    }
+
+    for (uint8_t* exit : exits)
+    {
+        _emitter.bindLabel(exit);
+    }
+
+    uint8_t* exit = _emitter.getCursor();
+
+    _emitter.aluRegReg(ALU_XOR, RAX, RAX, false);
+    _emitter.aluRegImm(ALU_ADD, RSP, 32, true);
+    _emitter.pop(BASE_REG);
+    _emitter.ret();
+
+    // fastmem fallbacks, entered from the fault handler
+    for (SlowPath& path : slowpaths)
+    {
+        uint8_t* slow = _emitter.getCursor();
+
+        compileInterpreterCall(path.pc, path.host);
+        _emitter.testRegReg8(RAX, RAX);
+        _emitter.bindLabel(_emitter.jcc(CC_E), exit);
+        _emitter.bindLabel(_emitter.jmp(), path.resume);
+
+        _fastmem_sites[(uintptr_t)path.access] = { path.start, slow };
+    }
+
+    _code_pages[physaddr >> CODE_PAGE_SHIFT] = true;
+    FastMem::getInstance().protectCode(physaddr >> CODE_PAGE_SHIFT, true);
+
+    return _blocks.insert(physaddr, block);
+}
+
+void Recompiler::compileInterpreterCall(uint32_t pc, const uint32_t* host)
+{
+    _emitter.movRegImm64(ARG_REG[0], (uint64_t)(uintptr_t)this);
+    _emitter.movRegImm32(ARG_REG[1], pc);
+    _emitter.movRegImm64(ARG_REG[2], (uint64_t)(uintptr_t)host);
+    _emitter.callAbs((const void*)&Recompiler::interpretInstruction);
+}
+
+uint8_t* Recompiler::compileMemoryAccess(Instruction instr)
+{
+    uint8_t bits;
+    bool sign = false;
+    bool store = false;
+
+    switch (instr.op)
+    {
+    case 32: // LB
+        bits = 8;
+        sign = true;
+        break;
+    case 33: // LH
+        bits = 16;
+        sign = true;
+        break;
+    case 35: // LW
+        bits = 32;
+        sign = true;
+        break;
+    case 36: // LBU
+        bits = 8;
+        break;
+    case 37: // LHU
+        bits = 16;
+        break;
+    case 39: // LWU
+        bits = 32;
+        break;
+    case 55: // LD
+        bits = 64;
+        break;
+    case 40: // SB
+        bits = 8;
+        store = true;
+        break;
+    case 41: // SH
+        bits = 16;
+        store = true;
+        break;
+    case 43: // SW
+        bits = 32;
+        store = true;
+        break;
+    case 63: // SD
+        bits = 64;
+        store = true;
+        break;
+    default:
+        return nullptr;
+    }
+
+    // loads into r0 are skipped entirely by the interpreter
+    if (!store && 0 == instr.rt)
+    {
+        return nullptr;
+    }
+
+    int32_t simm = signextend<int16_t, int32_t>((int16_t)instr.immediate);
+
+    // guest address, aligned like the RDRAM controller and swizzled
+    // into the host word order
+    _emitter.movRegMem(RAX, BASE_REG, regOffset(instr.base), false);
+    if (simm)
+    {
+        _emitter.aluRegImm(ALU_ADD, RAX, simm, false);
+    }
+    if (bits >= 16)
+    {
+        _emitter.aluRegImm(ALU_AND, RAX, (bits == 16) ? ~1 : ~3, false);
+    }
+    if (bits <= 16)
+    {
+        _emitter.aluRegImm(ALU_XOR, RAX, (bits == 8) ? 3 : 2, false);
+    }
+
+    _emitter.movRegImm64(RDX, (uint64_t)(uintptr_t)FastMem::getInstance().getBase());
+
+    uint8_t* access;
+
+    if (store)
+    {
+        _emitter.movRegMem(RCX, BASE_REG, regOffset(instr.rt), bits == 64);
+        if (bits == 64)
+        {
+            _emitter.shiftRegImm(SHIFT_ROL, RCX, 32, true);
+        }
+
+        access = _emitter.getCursor();
+        _emitter.storeIndexed(RDX, RAX, RCX, bits);
+
+        // mark the page dirty, the slow path does it through invalidateCode
+        _emitter.shiftRegImm(SHIFT_SHR, RAX, CODE_PAGE_SHIFT, false);
+        _emitter.aluRegImm(ALU_AND, RAX, CODE_PAGE_COUNT - 1, false);
+        _emitter.movRegImm64(RDX, (uint64_t)(uintptr_t)_dirty_pages);
+        _emitter.movRegImm32(RCX, 1);
+        _emitter.storeIndexed(RDX, RAX, RCX, 8);
+    }
+    else
+    {
+        access = _emitter.getCursor();
+        _emitter.loadIndexed(RCX, RDX, RAX, bits, sign);
+
+        if (bits == 64)
+        {
+            _emitter.shiftRegImm(SHIFT_ROL, RCX, 32, true);
+        }
+        _emitter.movMemReg(BASE_REG, regOffset(instr.rt), RCX, true);
+    }
+
+    return access;
+}
+
+bool Recompiler::compileInstruction(Instruction instr)
+{
+    int32_t rs = regOffset(instr.rs);
+    int32_t rt = regOffset(instr.rt);
+    int32_t rd = regOffset(instr.rd);
+    int32_t simm = signextend<int16_t, int32_t>((int16_t)instr.immediate);
+
+    switch (instr.op)
+    {
+    case 0: // SPECIAL
+        switch (instr.func)
+        {
+        case 0: // SLL
+        case 2: // SRL
+        case 3: // SRA
+            if (instr.rd)
+            {
+                static const X64ShiftOp ops[4] = { SHIFT_SHL, SHIFT_SHL, SHIFT_SHR, SHIFT_SAR };
+
+                _emitter.movRegMem(RAX, BASE_REG, rt, false);
+                if (instr.sa)
+                {
+                    _emitter.shiftRegImm(ops[instr.func], RAX, instr.sa, false);
+                }
+                _emitter.movsxdRegReg(RAX, RAX);
+                _emitter.movMemReg(BASE_REG, rd, RAX, true);
+            }
+            return true;
+        case 4: // SLLV
+        case 6: // SRLV
+        case 7: // SRAV
+            if (instr.rd)
+            {
+                static const X64ShiftOp ops[4] = { SHIFT_SHL, SHIFT_SHL, SHIFT_SHR, SHIFT_SAR };
+
+                _emitter.movRegMem(RCX, BASE_REG, rs, false);
+                _emitter.movRegMem(RAX, BASE_REG, rt, false);
+                _emitter.shiftRegCL(ops[instr.func & 3], RAX, false);
+                _emitter.movsxdRegReg(RAX, RAX);
+                _emitter.movMemReg(BASE_REG, rd, RAX, true);
+            }
+            return true;
+        case 16: // MFHI
+            _emitter.movRegMem(RAX, BASE_REG, hiOffset(), true);
+            _emitter.movMemReg(BASE_REG, rd, RAX, true);
+            return true;
+        case 17: // MTHI
+            _emitter.movRegMem(RAX, BASE_REG, rs, true);
+            _emitter.movMemReg(BASE_REG, hiOffset(), RAX, true);
+            return true;
+        case 18: // MFLO
+            _emitter.movRegMem(RAX, BASE_REG, loOffset(), true);
+            _emitter.movMemReg(BASE_REG, rd, RAX, true);
+            return true;
+        case 19: // MTLO
+            _emitter.movRegMem(RAX, BASE_REG, rs, true);
+            _emitter.movMemReg(BASE_REG, loOffset(), RAX, true);
+            return true;
+        case 20: // DSLLV
+        case 22: // DSRLV
+        case 23: // DSRAV
+        {
+            static const X64ShiftOp ops[4] = { SHIFT_SHL, SHIFT_SHL, SHIFT_SHR, SHIFT_SAR };
+
+            _emitter.movRegMem(RCX, BASE_REG, rs, false);
+            _emitter.movRegMem(RAX, BASE_REG, rt, true);
+            _emitter.shiftRegCL(ops[instr.func & 3], RAX, true);
+            _emitter.movMemReg(BASE_REG, rd, RAX, true);
+            return true;
+        }
+        case 24: // MULT
+        case 25: // MULTU
+            _emitter.movRegMem(RAX, BASE_REG, rs, false);
+            if (instr.func == 24)
+            {
+                _emitter.imulMem32(BASE_REG, rt);
+            }
+            else
+            {
+                _emitter.mulMem32(BASE_REG, rt);
+            }
+            _emitter.movsxdRegReg(RAX, RAX);
+            _emitter.movMemReg(BASE_REG, loOffset(), RAX, true);
+            _emitter.movsxdRegReg(RDX, RDX);
+            _emitter.movMemReg(BASE_REG, hiOffset(), RDX, true);
+            return true;
+        case 32: // ADD
+        case 33: // ADDU
+        case 34: // SUB
+        case 35: // SUBU
+            _emitter.movRegMem(RAX, BASE_REG, rs, false);
+            _emitter.aluRegMem((instr.func & 2) ? ALU_SUB : ALU_ADD, RAX, BASE_REG, rt, false);
+            _emitter.movsxdRegReg(RAX, RAX);
+            _emitter.movMemReg(BASE_REG, rd, RAX, true);
+            return true;
+        case 36: // AND
+        case 37: // OR
+        case 38: // XOR
+        case 39: // NOR
+            if (instr.rd)
+            {
+                static const X64AluOp ops[4] = { ALU_AND, ALU_OR, ALU_XOR, ALU_OR };
+
+                _emitter.movRegMem(RAX, BASE_REG, rs, true);
+                _emitter.aluRegMem(ops[instr.func & 3], RAX, BASE_REG, rt, true);
+                if (instr.func == 39)
+                {
+                    _emitter.notReg(RAX, true);
+                }
+                _emitter.movMemReg(BASE_REG, rd, RAX, true);
+            }
+            return true;
+        case 42: // SLT
+        case 43: // SLTU
+            _emitter.movRegMem(RAX, BASE_REG, rs, true);
+            _emitter.aluRegMem(ALU_CMP, RAX, BASE_REG, rt, true);
+            _emitter.setcc((instr.func == 42) ? CC_L : CC_B, RAX);
+            _emitter.movzxRegReg8(RAX, RAX);
+            _emitter.movMemReg(BASE_REG, rd, RAX, true);
+            return true;
+        case 44: // DADD
+        case 45: // DADDU
+        case 46: // DSUB
+        case 47: // DSUBU
+            _emitter.movRegMem(RAX, BASE_REG, rs, true);
+            _emitter.aluRegMem((instr.func & 2) ? ALU_SUB : ALU_ADD, RAX, BASE_REG, rt, true);
+            _emitter.movMemReg(BASE_REG, rd, RAX, true);
+            return true;
+        case 56: // DSLL
+        case 58: // DSRL
+        case 59: // DSRA
+        case 60: // DSLL32
+        case 62: // DSRL32
+        case 63: // DSRA32
+        {
+            static const X64ShiftOp ops[4] = { SHIFT_SHL, SHIFT_SHL, SHIFT_SHR, SHIFT_SAR };
+            uint8_t shift = (uint8_t)(instr.sa + ((instr.func & 4) ? 32 : 0));
+
+            _emitter.movRegMem(RAX, BASE_REG, rt, true);
+            if (shift)
+            {
+                _emitter.shiftRegImm(ops[instr.func & 3], RAX, shift, true);
+            }
+            _emitter.movMemReg(BASE_REG, rd, RAX, true);
+            return true;
+        }
+        }
+        return false;
+    case 8:  // ADDI
+    case 9:  // ADDIU
+        if (instr.rt)
+        {
+            _emitter.movRegMem(RAX, BASE_REG, rs, false);
+            _emitter.aluRegImm(ALU_ADD, RAX, simm, false);
+            _emitter.movsxdRegReg(RAX, RAX);
+            _emitter.movMemReg(BASE_REG, rt, RAX, true);
+        }
+        return true;
+    case 10: // SLTI
+    case 11: // SLTIU
+        _emitter.movRegMem(RAX, BASE_REG, rs, true);
+        _emitter.aluRegImm(ALU_CMP, RAX, simm, true);
+        _emitter.setcc((instr.op == 10) ? CC_L : CC_B, RAX);
+        _emitter.movzxRegReg8(RAX, RAX);
+        _emitter.movMemReg(BASE_REG, rt, RAX, true);
+        return true;
+    case 12: // ANDI
+    case 13: // ORI
+    case 14: // XORI
+    {
+        static const X64AluOp ops[3] = { ALU_AND, ALU_OR, ALU_XOR };
+
+        _emitter.movRegMem(RAX, BASE_REG, rs, true);
+        _emitter.aluRegImm(ops[instr.op - 12], RAX, (int32_t)instr.immediate, true);
+        _emitter.movMemReg(BASE_REG, rt, RAX, true);
+        return true;
+    }
+    case 15: // LUI
+        if (instr.rt)
+        {
+            _emitter.movRegImm64(RAX, (uint64_t)signextend<int32_t, int64_t>((int32_t)(instr.immediate << 16)));
+            _emitter.movMemReg(BASE_REG, rt, RAX, true);
+        }
+        return true;
+    case 24: // DADDI
+    case 25: // DADDIU
+        if (instr.rt)
+        {
+            _emitter.movRegMem(RAX, BASE_REG, rs, true);
+            _emitter.aluRegImm(ALU_ADD, RAX, simm, true);
+            _emitter.movMemReg(BASE_REG, rt, RAX, true);
+        }
+        return true;
+    }
+
+    return false;
+}
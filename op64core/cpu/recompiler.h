@@ -0,0 +1,97 @@
+/* Block recompiler for x86-64 hosts.
+ * ALU instructions are translated to native code, everything else
+ * calls back into the interpreter handlers so timing matches exactly */
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "interpreter.h"
+#include "blockcache.h"
+#include "x64emitter.h"
+
+
+class Recompiler : public Interpreter
+{
+    typedef uint32_t(*BlockFunc)(void);
+
+    struct CodeBlock
+    {
+        uint32_t address;   // virtual start address
+        uint32_t end;       // virtual address following the block
+        BlockFunc code;
+    };
+
+    // fastmem access that falls back to the interpreter when it faults
+    struct FastmemSite
+    {
+        uint8_t* start;     // start of the inline sequence, patched on permanent faults
+        uint8_t* slow;      // out of line interpreter call
+    };
+
+public:
+    Recompiler(void) = default;
+    ~Recompiler(void) = default;
+
+    virtual uint32_t getCPUType(void)
+    {
+        return CPU_JIT;
+    }
+
+    virtual bool initialize(Bus* bus);
+    virtual void uninitialize(Bus* bus);
+    virtual void execute(void);
+
+    virtual void hardReset(void);
+
+protected:
+    virtual void invalidateCodePage(uint32_t page);
+
+private:
+    CodeBlock* getBlock(uint32_t pc, uint32_t* host);
+    CodeBlock* compileBlock(uint32_t pc, uint32_t* host, uint32_t physaddr);
+    bool compileInstruction(Instruction instr);
+    void compileInterpreterCall(uint32_t pc, const uint32_t* host);
+    uint8_t* compileMemoryAccess(Instruction instr);
+    void flushBlocks(void);
+
+    static bool handleFault(void* context, uintptr_t* rip, bool transient);
+
+    inline void step(const uint32_t* host)
+    {
+        _check_nop = (host[1] == 0);
+        _cur_instr.code = host[0];
+
+        (this->*instruction_table[_cur_instr.op])();
+    }
+
+    // called from generated code for instructions without a native translation
+    static uint32_t interpretInstruction(Recompiler* cpu, uint32_t pc, const uint32_t* host);
+
+    // register operand offsets from the base register
+    inline int32_t regOffset(uint32_t reg)
+    {
+        return (int32_t)(reg * sizeof(Register64));
+    }
+
+    inline int32_t hiOffset(void)
+    {
+        return (int32_t)((uint8_t*)&_hi - (uint8_t*)_reg);
+    }
+
+    inline int32_t loOffset(void)
+    {
+        return (int32_t)((uint8_t*)&_lo - (uint8_t*)_reg);
+    }
+
+private:
+    X64Emitter _emitter;
+    BlockCache<CodeBlock> _blocks;
+
+    // keyed by the address of the faulting host instruction
+    std::unordered_map<uintptr_t, FastmemSite> _fastmem_sites;
+
+    bool _fastmem = false;
+    bool _block_invalidated = false;
+};
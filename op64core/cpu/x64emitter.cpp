@@ -0,0 +1,409 @@
+#ifdef _MSC_VER
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#include "x64emitter.h"
+
+
+X64Emitter::~X64Emitter(void)
+{
+    release();
+}
+
+bool X64Emitter::allocate(size_t size)
+{
+    release();
+
+#ifdef _MSC_VER
+    _base = (uint8_t*)VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+#else
+    void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    _base = (mem == MAP_FAILED) ? nullptr : (uint8_t*)mem;
+#endif
+
+    if (nullptr == _base)
+    {
+        return false;
+    }
+
+    _cursor = _base;
+    _size = size;
+
+    return true;
+}
+
+void X64Emitter::release(void)
+{
+    if (nullptr == _base)
+    {
+        return;
+    }
+
+#ifdef _MSC_VER
+    VirtualFree(_base, 0, MEM_RELEASE);
+#else
+    munmap(_base, _size);
+#endif
+
+    _base = _cursor = nullptr;
+    _size = 0;
+}
+
+void X64Emitter::emitRex(bool w64, uint8_t reg, uint8_t rm, bool force)
+{
+    uint8_t rex = 0x40 | (w64 ? 0x08 : 0) | ((reg & 8) ? 0x04 : 0) | ((rm & 8) ? 0x01 : 0);
+
+    if (rex != 0x40 || force)
+    {
+        emit8(rex);
+    }
+}
+
+void X64Emitter::emitModRMReg(uint8_t reg, uint8_t rm)
+{
+    emit8(0xC0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+void X64Emitter::emitModRMMem(uint8_t reg, uint8_t base, int32_t disp)
+{
+    uint8_t mod;
+
+    if (disp == 0 && (base & 7) != RBP)
+    {
+        mod = 0x00;
+    }
+    else if (disp >= -128 && disp <= 127)
+    {
+        mod = 0x40;
+    }
+    else
+    {
+        mod = 0x80;
+    }
+
+    emit8(mod | ((reg & 7) << 3) | (base & 7));
+
+    // rsp/r12 based addressing needs a SIB byte
+    if ((base & 7) == RSP)
+    {
+        emit8(0x24);
+    }
+
+    if (mod == 0x40)
+    {
+        emit8((uint8_t)disp);
+    }
+    else if (mod == 0x80)
+    {
+        emit32((uint32_t)disp);
+    }
+}
+
+void X64Emitter::emitRexIndexed(bool w64, uint8_t reg, uint8_t base, uint8_t index, bool force)
+{
+    uint8_t rex = 0x40 | (w64 ? 0x08 : 0) | ((reg & 8) ? 0x04 : 0) | ((index & 8) ? 0x02 : 0) | ((base & 8) ? 0x01 : 0);
+
+    if (rex != 0x40 || force)
+    {
+        emit8(rex);
+    }
+}
+
+void X64Emitter::emitModRMIndexed(uint8_t reg, uint8_t base, uint8_t index)
+{
+    // rbp/r13 based addressing needs an explicit displacement
+    bool disp = ((base & 7) == RBP);
+
+    emit8((disp ? 0x44 : 0x04) | ((reg & 7) << 3));
+    emit8(((index & 7) << 3) | (base & 7));
+
+    if (disp)
+    {
+        emit8(0);
+    }
+}
+
+void X64Emitter::push(X64Reg reg)
+{
+    emitRex(false, 0, reg);
+    emit8(0x50 | (reg & 7));
+}
+
+void X64Emitter::pop(X64Reg reg)
+{
+    emitRex(false, 0, reg);
+    emit8(0x58 | (reg & 7));
+}
+
+void X64Emitter::ret(void)
+{
+    emit8(0xC3);
+}
+
+void X64Emitter::movRegImm32(X64Reg dst, uint32_t imm)
+{
+    emitRex(false, 0, dst);
+    emit8(0xB8 | (dst & 7));
+    emit32(imm);
+}
+
+void X64Emitter::movRegImm64(X64Reg dst, uint64_t imm)
+{
+    if (imm <= 0xFFFFFFFF)
+    {
+        // zero extends
+        movRegImm32(dst, (uint32_t)imm);
+    }
+    else if ((int64_t)imm == (int64_t)(int32_t)imm)
+    {
+        // sign extends
+        emitRex(true, 0, dst);
+        emit8(0xC7);
+        emitModRMReg(0, dst);
+        emit32((uint32_t)imm);
+    }
+    else
+    {
+        emitRex(true, 0, dst);
+        emit8(0xB8 | (dst & 7));
+        emit64(imm);
+    }
+}
+
+void X64Emitter::movRegReg(X64Reg dst, X64Reg src, bool w64)
+{
+    emitRex(w64, src, dst);
+    emit8(0x89);
+    emitModRMReg(src, dst);
+}
+
+void X64Emitter::movRegMem(X64Reg dst, X64Reg base, int32_t disp, bool w64)
+{
+    emitRex(w64, dst, base);
+    emit8(0x8B);
+    emitModRMMem(dst, base, disp);
+}
+
+void X64Emitter::movMemReg(X64Reg base, int32_t disp, X64Reg src, bool w64)
+{
+    emitRex(w64, src, base);
+    emit8(0x89);
+    emitModRMMem(src, base, disp);
+}
+
+void X64Emitter::movsxdRegReg(X64Reg dst, X64Reg src)
+{
+    emitRex(true, dst, src);
+    emit8(0x63);
+    emitModRMReg(dst, src);
+}
+
+void X64Emitter::movzxRegReg8(X64Reg dst, X64Reg src)
+{
+    emitRex(false, dst, src, (src >= RSP && src <= RDI));
+    emit8(0x0F);
+    emit8(0xB6);
+    emitModRMReg(dst, src);
+}
+
+void X64Emitter::loadIndexed(X64Reg dst, X64Reg base, X64Reg index, uint8_t bits, bool sign)
+{
+    switch (bits)
+    {
+    case 8:
+        emitRexIndexed(sign, dst, base, index);
+        emit8(0x0F);
+        emit8(sign ? 0xBE : 0xB6);
+        break;
+    case 16:
+        emitRexIndexed(sign, dst, base, index);
+        emit8(0x0F);
+        emit8(sign ? 0xBF : 0xB7);
+        break;
+    case 32:
+        emitRexIndexed(sign, dst, base, index);
+        emit8(sign ? 0x63 : 0x8B);
+        break;
+    default:
+        emitRexIndexed(true, dst, base, index);
+        emit8(0x8B);
+        break;
+    }
+
+    emitModRMIndexed(dst, base, index);
+}
+
+void X64Emitter::storeIndexed(X64Reg base, X64Reg index, X64Reg src, uint8_t bits)
+{
+    switch (bits)
+    {
+    case 8:
+        emitRexIndexed(false, src, base, index, (src >= RSP && src <= RDI));
+        emit8(0x88);
+        break;
+    case 16:
+        emit8(0x66);
+        emitRexIndexed(false, src, base, index);
+        emit8(0x89);
+        break;
+    case 32:
+        emitRexIndexed(false, src, base, index);
+        emit8(0x89);
+        break;
+    default:
+        emitRexIndexed(true, src, base, index);
+        emit8(0x89);
+        break;
+    }
+
+    emitModRMIndexed(src, base, index);
+}
+
+void X64Emitter::aluRegMem(X64AluOp op, X64Reg dst, X64Reg base, int32_t disp, bool w64)
+{
+    emitRex(w64, dst, base);
+    emit8((op << 3) | 0x03);
+    emitModRMMem(dst, base, disp);
+}
+
+void X64Emitter::aluRegReg(X64AluOp op, X64Reg dst, X64Reg src, bool w64)
+{
+    emitRex(w64, src, dst);
+    emit8((op << 3) | 0x01);
+    emitModRMReg(src, dst);
+}
+
+void X64Emitter::aluRegImm(X64AluOp op, X64Reg dst, int32_t imm, bool w64)
+{
+    emitRex(w64, 0, dst);
+
+    if (imm >= -128 && imm <= 127)
+    {
+        emit8(0x83);
+        emitModRMReg(op, dst);
+        emit8((uint8_t)imm);
+    }
+    else
+    {
+        emit8(0x81);
+        emitModRMReg(op, dst);
+        emit32((uint32_t)imm);
+    }
+}
+
+void X64Emitter::shiftRegImm(X64ShiftOp op, X64Reg reg, uint8_t imm, bool w64)
+{
+    emitRex(w64, 0, reg);
+
+    if (imm == 1)
+    {
+        emit8(0xD1);
+        emitModRMReg(op, reg);
+    }
+    else
+    {
+        emit8(0xC1);
+        emitModRMReg(op, reg);
+        emit8(imm);
+    }
+}
+
+void X64Emitter::shiftRegCL(X64ShiftOp op, X64Reg reg, bool w64)
+{
+    emitRex(w64, 0, reg);
+    emit8(0xD3);
+    emitModRMReg(op, reg);
+}
+
+void X64Emitter::notReg(X64Reg reg, bool w64)
+{
+    emitRex(w64, 0, reg);
+    emit8(0xF7);
+    emitModRMReg(2, reg);
+}
+
+void X64Emitter::imulMem32(X64Reg base, int32_t disp)
+{
+    emitRex(false, 0, base);
+    emit8(0xF7);
+    emitModRMMem(5, base, disp);
+}
+
+void X64Emitter::mulMem32(X64Reg base, int32_t disp)
+{
+    emitRex(false, 0, base);
+    emit8(0xF7);
+    emitModRMMem(4, base, disp);
+}
+
+void X64Emitter::setcc(X64Cond cond, X64Reg dst)
+{
+    emitRex(false, 0, dst, (dst >= RSP && dst <= RDI));
+    emit8(0x0F);
+    emit8(0x90 | cond);
+    emitModRMReg(0, dst);
+}
+
+void X64Emitter::testRegReg8(X64Reg a, X64Reg b)
+{
+    emitRex(false, b, a, (a >= RSP && a <= RDI) || (b >= RSP && b <= RDI));
+    emit8(0x84);
+    emitModRMReg(b, a);
+}
+
+void X64Emitter::callAbs(const void* func)
+{
+    movRegImm64(RAX, (uint64_t)(uintptr_t)func);
+    emit8(0xFF);
+    emitModRMReg(2, RAX);
+}
+
+uint8_t* X64Emitter::jcc(X64Cond cond)
+{
+    emit8(0x0F);
+    emit8(0x80 | cond);
+
+    uint8_t* rel = _cursor;
+    emit32(0);
+
+    return rel;
+}
+
+uint8_t* X64Emitter::jmp(void)
+{
+    emit8(0xE9);
+
+    uint8_t* rel = _cursor;
+    emit32(0);
+
+    return rel;
+}
+
+void X64Emitter::bindLabel(uint8_t* rel)
+{
+    bindLabel(rel, _cursor);
+}
+
+void X64Emitter::bindLabel(uint8_t* rel, uint8_t* target)
+{
+    int32_t offset = (int32_t)(target - (rel + 4));
+
+    for (int i = 0; i < 4; i++)
+    {
+        rel[i] = (uint8_t)(offset >> (i * 8));
+    }
+}
+
+void X64Emitter::patchJump(uint8_t* location, uint8_t* target)
+{
+    int32_t offset = (int32_t)(target - (location + 5));
+
+    location[0] = 0xE9;
+
+    for (int i = 0; i < 4; i++)
+    {
+        location[i + 1] = (uint8_t)(offset >> (i * 8));
+    }
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+/************************************************************************/
+/* Minimal x86-64 code emitter used by the recompiler                   */
+/************************************************************************/
+
+enum X64Reg : uint8_t
+{
+    RAX = 0, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+    R8, R9, R10, R11, R12, R13, R14, R15
+};
+
+enum X64Cond : uint8_t
+{
+    CC_B = 0x2,
+    CC_AE = 0x3,
+    CC_E = 0x4,
+    CC_NE = 0x5,
+    CC_L = 0xC,
+    CC_GE = 0xD
+};
+
+// opcode extensions for the 0x81/0x83 group, also used for r/m forms
+enum X64AluOp : uint8_t
+{
+    ALU_ADD = 0,
+    ALU_OR = 1,
+    ALU_AND = 4,
+    ALU_SUB = 5,
+    ALU_XOR = 6,
+    ALU_CMP = 7
+};
+
+// opcode extensions for the 0xC1/0xD3 group
+enum X64ShiftOp : uint8_t
+{
+    SHIFT_ROL = 0,
+    SHIFT_SHL = 4,
+    SHIFT_SHR = 5,
+    SHIFT_SAR = 7
+};
+
+class X64Emitter
+{
+public:
+    X64Emitter(void) = default;
+    ~X64Emitter(void);
+
+    bool allocate(size_t size);
+    void release(void);
+
+    // rewind to the start of the buffer, discarding all emitted code
+    inline void reset(void)
+    {
+        _cursor = _base;
+    }
+
+    inline size_t freeSpace(void)
+    {
+        return _size - (_cursor - _base);
+    }
+
+    inline uint8_t* getCursor(void)
+    {
+        return _cursor;
+    }
+
+    void push(X64Reg reg);
+    void pop(X64Reg reg);
+    void ret(void);
+
+    void movRegImm32(X64Reg dst, uint32_t imm);
+    void movRegImm64(X64Reg dst, uint64_t imm);
+    void movRegReg(X64Reg dst, X64Reg src, bool w64);
+    void movRegMem(X64Reg dst, X64Reg base, int32_t disp, bool w64);
+    void movMemReg(X64Reg base, int32_t disp, X64Reg src, bool w64);
+    void movsxdRegReg(X64Reg dst, X64Reg src);
+    void movzxRegReg8(X64Reg dst, X64Reg src);
+
+    // [base + index] accesses of 8 to 64 bits, signed loads extend to 64 bits
+    void loadIndexed(X64Reg dst, X64Reg base, X64Reg index, uint8_t bits, bool sign);
+    void storeIndexed(X64Reg base, X64Reg index, X64Reg src, uint8_t bits);
+
+    void aluRegMem(X64AluOp op, X64Reg dst, X64Reg base, int32_t disp, bool w64);
+    void aluRegReg(X64AluOp op, X64Reg dst, X64Reg src, bool w64);
+    void aluRegImm(X64AluOp op, X64Reg dst, int32_t imm, bool w64);
+    void shiftRegImm(X64ShiftOp op, X64Reg reg, uint8_t imm, bool w64);
+    void shiftRegCL(X64ShiftOp op, X64Reg reg, bool w64);
+    void notReg(X64Reg reg, bool w64);
+
+    // edx:eax = eax * m32
+    void imulMem32(X64Reg base, int32_t disp);
+    void mulMem32(X64Reg base, int32_t disp);
+
+    void setcc(X64Cond cond, X64Reg dst);
+    void testRegReg8(X64Reg a, X64Reg b);
+
+    void callAbs(const void* func);
+
+    // forward jumps return the rel32 field to be patched with bindLabel
+    uint8_t* jcc(X64Cond cond);
+    uint8_t* jmp(void);
+    void bindLabel(uint8_t* rel);
+    void bindLabel(uint8_t* rel, uint8_t* target);
+
+    // overwrite code at location with a jump to target
+    static void patchJump(uint8_t* location, uint8_t* target);
+
+private:
+    inline void emit8(uint8_t b)
+    {
+        *_cursor++ = b;
+    }
+
+    inline void emit32(uint32_t d)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            emit8((uint8_t)(d >> (i * 8)));
+        }
+    }
+
+    inline void emit64(uint64_t q)
+    {
+        emit32((uint32_t)q);
+        emit32((uint32_t)(q >> 32));
+    }
+
+    void emitRex(bool w64, uint8_t reg, uint8_t rm, bool force = false);
+    void emitModRMReg(uint8_t reg, uint8_t rm);
+    void emitModRMMem(uint8_t reg, uint8_t base, int32_t disp);
+    void emitRexIndexed(bool w64, uint8_t reg, uint8_t base, uint8_t index, bool force = false);
+    void emitModRMIndexed(uint8_t reg, uint8_t base, uint8_t index);
+
+private:
+    uint8_t* _base = nullptr;
+    uint8_t* _cursor = nullptr;
+    size_t _size = 0;
+};
@@ -8,7 +8,14 @@ namespace GlobalStrings
 
     // core settings
     const char* CFG_DELAY_SI = "DelaySI";
+    const char* CFG_DMA_TIMING = "DMATiming";
+    const char* CFG_RSP_THREAD = "RSPThread";
+    const char* CFG_HLE_AUDIO = "HLEAudio";
     const char* CFG_SAVE_PATH = "SavePath";
+    const char* CFG_CPU_CORE = "CPUCore";
+    const char* CFG_FASTMEM = "Fastmem";
+    const char* CFG_REWIND_INTERVAL = "RewindInterval";
+    const char* CFG_REWIND_BUFFER = "RewindBufferMB";
 
     const char* CFG_GFX_PLUGIN = "GFXPlugin";
     const char* CFG_AUDIO_PLUGIN = "AudioPlugin";
@@ -8,7 +8,14 @@ namespace GlobalStrings
 
     // some core settings
     extern const char* CFG_DELAY_SI;
+    extern const char* CFG_DMA_TIMING;
+    extern const char* CFG_RSP_THREAD;
+    extern const char* CFG_HLE_AUDIO;
     extern const char* CFG_SAVE_PATH;
+    extern const char* CFG_CPU_CORE;
+    extern const char* CFG_FASTMEM;
+    extern const char* CFG_REWIND_INTERVAL;
+    extern const char* CFG_REWIND_BUFFER;
 
     extern const char* CFG_GFX_PLUGIN;
     extern const char* CFG_AUDIO_PLUGIN;
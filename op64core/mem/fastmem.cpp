@@ -0,0 +1,366 @@
+#ifdef _MSC_VER
+#include <windows.h>
+#else
+#include <csignal>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <ucontext.h>
+#include <sys/mman.h>
+#endif
+
+#include <algorithm>
+
+#include <oplog.h>
+#include <oppreproc.h>
+
+#include "fastmem.h"
+
+
+#define FASTMEM_SIZE 0x100000000ULL
+
+// RDRAM views inside the reservation
+static const uint32_t VIEW_OFFSETS[2] = { 0x80000000, 0xA0000000 };
+
+
+#ifdef _MSC_VER
+static LONG CALLBACK exceptionHandler(PEXCEPTION_POINTERS info)
+{
+    if (info->ExceptionRecord->ExceptionCode != EXCEPTION_ACCESS_VIOLATION)
+    {
+        return EXCEPTION_CONTINUE_SEARCH;
+    }
+
+    uintptr_t rip = (uintptr_t)info->ContextRecord->Rip;
+
+    if (!FastMem::getInstance().handleFault((uintptr_t)info->ExceptionRecord->ExceptionInformation[1], &rip))
+    {
+        return EXCEPTION_CONTINUE_SEARCH;
+    }
+
+    info->ContextRecord->Rip = rip;
+
+    return EXCEPTION_CONTINUE_EXECUTION;
+}
+#else
+static struct sigaction old_action;
+
+static void signalHandler(int sig, siginfo_t* info, void* raw)
+{
+    ucontext_t* context = (ucontext_t*)raw;
+    uintptr_t rip = (uintptr_t)context->uc_mcontext.gregs[REG_RIP];
+
+    if (FastMem::getInstance().handleFault((uintptr_t)info->si_addr, &rip))
+    {
+        context->uc_mcontext.gregs[REG_RIP] = rip;
+        return;
+    }
+
+    // not a fastmem access, pass it on
+    if (old_action.sa_flags & SA_SIGINFO)
+    {
+        old_action.sa_sigaction(sig, info, raw);
+    }
+    else if (old_action.sa_handler != SIG_DFL && old_action.sa_handler != SIG_IGN)
+    {
+        old_action.sa_handler(sig);
+    }
+    else
+    {
+        // the fault is raised again with the default action
+        sigaction(SIGSEGV, &old_action, nullptr);
+    }
+}
+#endif
+
+
+FastMem& FastMem::getInstance(void)
+{
+    static FastMem instance;
+    return instance;
+}
+
+FastMem::FastMem(void)
+{
+    fill_array(_code, 0, PAGE_COUNT, false);
+    fill_array(_framebuffer, 0, PAGE_COUNT, false);
+
+    // this runs during static initialization, so nothing is logged here
+    if (!createBacking())
+    {
+        _rdram = new uint32_t[RDRAM_SIZE / 4];
+    }
+}
+
+FastMem::~FastMem(void)
+{
+    unmap();
+
+#ifdef _MSC_VER
+    if (nullptr != _mapping)
+    {
+        UnmapViewOfFile(_rdram);
+        CloseHandle(_mapping);
+        return;
+    }
+#else
+    if (_fd >= 0)
+    {
+        munmap(_rdram, RDRAM_SIZE);
+        close(_fd);
+        return;
+    }
+#endif
+
+    delete[] _rdram;
+}
+
+bool FastMem::createBacking(void)
+{
+#ifdef _MSC_VER
+    _mapping = CreateFileMapping(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, RDRAM_SIZE, nullptr);
+
+    if (nullptr == _mapping)
+    {
+        return false;
+    }
+
+    _rdram = (uint32_t*)MapViewOfFile(_mapping, FILE_MAP_ALL_ACCESS, 0, 0, RDRAM_SIZE);
+
+    if (nullptr == _rdram)
+    {
+        CloseHandle(_mapping);
+        _mapping = nullptr;
+        return false;
+    }
+#else
+    char name[64];
+    _s_snprintf(name, sizeof(name), "/op64-rdram-%d", (int)getpid());
+
+    _fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+
+    if (_fd < 0)
+    {
+        return false;
+    }
+
+    shm_unlink(name);
+
+    void* mem = MAP_FAILED;
+
+    if (ftruncate(_fd, RDRAM_SIZE) == 0)
+    {
+        mem = mmap(nullptr, RDRAM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+    }
+
+    if (MAP_FAILED == mem)
+    {
+        close(_fd);
+        _fd = -1;
+        return false;
+    }
+
+    _rdram = (uint32_t*)mem;
+#endif
+
+    return true;
+}
+
+bool FastMem::map(FaultHandler handler, void* context)
+{
+    if (isMapped())
+    {
+        unmap();
+    }
+
+#ifdef _MSC_VER
+    if (nullptr == _mapping)
+    {
+        LOG_WARNING(FastMem) << "RDRAM is not backed by shared memory";
+        return false;
+    }
+
+    // find a free range, then map the views and reserve the gaps around them
+    uint8_t* base = (uint8_t*)VirtualAlloc(nullptr, FASTMEM_SIZE, MEM_RESERVE, PAGE_NOACCESS);
+
+    if (nullptr == base)
+    {
+        LOG_WARNING(FastMem) << "Could not reserve address space";
+        return false;
+    }
+
+    VirtualFree(base, 0, MEM_RELEASE);
+
+    uint64_t gap = 0;
+    bool ok = true;
+
+    for (uint32_t offset : VIEW_OFFSETS)
+    {
+        ok = ok && (nullptr != VirtualAlloc(base + gap, offset - gap, MEM_RESERVE, PAGE_NOACCESS));
+        ok = ok && (nullptr != MapViewOfFileEx(_mapping, FILE_MAP_ALL_ACCESS, 0, 0, RDRAM_SIZE, base + offset));
+        gap = offset + RDRAM_SIZE;
+    }
+
+    ok = ok && (nullptr != VirtualAlloc(base + gap, FASTMEM_SIZE - gap, MEM_RESERVE, PAGE_NOACCESS));
+
+    _base = base;
+
+    if (!ok)
+    {
+        LOG_WARNING(FastMem) << "Could not map RDRAM views";
+        unmap();
+        return false;
+    }
+
+    _handler = handler;
+    _context = context;
+    _handler_handle = AddVectoredExceptionHandler(1, exceptionHandler);
+#else
+    if (_fd < 0)
+    {
+        LOG_WARNING(FastMem) << "RDRAM is not backed by shared memory";
+        return false;
+    }
+
+    void* mem = mmap(nullptr, FASTMEM_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+    if (MAP_FAILED == mem)
+    {
+        LOG_WARNING(FastMem) << "Could not reserve address space";
+        return false;
+    }
+
+    uint8_t* base = (uint8_t*)mem;
+
+    for (uint32_t offset : VIEW_OFFSETS)
+    {
+        if (MAP_FAILED == mmap(base + offset, RDRAM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, _fd, 0))
+        {
+            LOG_WARNING(FastMem) << "Could not map RDRAM views";
+            munmap(base, FASTMEM_SIZE);
+            return false;
+        }
+    }
+
+    _base = base;
+    _handler = handler;
+    _context = context;
+
+    struct sigaction action = {};
+    action.sa_sigaction = signalHandler;
+    action.sa_flags = SA_SIGINFO;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGSEGV, &action, &old_action);
+#endif
+
+    fill_array(_code, 0, PAGE_COUNT, false);
+    fill_array(_framebuffer, 0, PAGE_COUNT, false);
+
+    LOG_INFO(FastMem) << "Mapped at 0x" << std::hex << (uintptr_t)_base;
+
+    return true;
+}
+
+void FastMem::unmap(void)
+{
+    if (!isMapped())
+    {
+        return;
+    }
+
+#ifdef _MSC_VER
+    if (nullptr != _handler_handle)
+    {
+        RemoveVectoredExceptionHandler(_handler_handle);
+        _handler_handle = nullptr;
+    }
+
+    uint64_t gap = 0;
+
+    for (uint32_t offset : VIEW_OFFSETS)
+    {
+        VirtualFree(_base + gap, 0, MEM_RELEASE);
+        UnmapViewOfFile(_base + offset);
+        gap = offset + RDRAM_SIZE;
+    }
+
+    VirtualFree(_base + gap, 0, MEM_RELEASE);
+#else
+    sigaction(SIGSEGV, &old_action, nullptr);
+    munmap(_base, FASTMEM_SIZE);
+#endif
+
+    _base = nullptr;
+    _handler = nullptr;
+    _context = nullptr;
+}
+
+void FastMem::protectCode(uint32_t page, bool protect)
+{
+    if (!isMapped() || page >= PAGE_COUNT || _code[page] == protect)
+    {
+        return;
+    }
+
+    _code[page] = protect;
+    updatePage(page);
+}
+
+void FastMem::protectFramebuffer(uint32_t address, uint32_t length, bool protect)
+{
+    if (!isMapped() || 0 == length)
+    {
+        return;
+    }
+
+    uint32_t first = (address & (RDRAM_SIZE - 1)) >> PAGE_SHIFT;
+    uint32_t last = std::min(((address & (RDRAM_SIZE - 1)) + length - 1) >> PAGE_SHIFT, (uint32_t)PAGE_COUNT - 1);
+
+    for (uint32_t page = first; page <= last; page++)
+    {
+        if (_framebuffer[page] != protect)
+        {
+            _framebuffer[page] = protect;
+            updatePage(page);
+        }
+    }
+}
+
+void FastMem::updatePage(uint32_t page)
+{
+    for (uint32_t offset : VIEW_OFFSETS)
+    {
+        uint8_t* addr = _base + offset + (page << PAGE_SHIFT);
+
+#ifdef _MSC_VER
+        DWORD access = _framebuffer[page] ? PAGE_NOACCESS : (_code[page] ? PAGE_READONLY : PAGE_READWRITE);
+        DWORD old;
+        VirtualProtect(addr, 1 << PAGE_SHIFT, access, &old);
+#else
+        int access = _framebuffer[page] ? PROT_NONE : (_code[page] ? PROT_READ : (PROT_READ | PROT_WRITE));
+        mprotect(addr, 1 << PAGE_SHIFT, access);
+#endif
+    }
+}
+
+bool FastMem::handleFault(uintptr_t address, uintptr_t* rip)
+{
+    if (!isMapped() || address < (uintptr_t)_base || address >= (uintptr_t)_base + FASTMEM_SIZE)
+    {
+        return false;
+    }
+
+    bool transient = false;
+    uint64_t offset = address - (uintptr_t)_base;
+
+    for (uint32_t view : VIEW_OFFSETS)
+    {
+        if (offset >= view && offset < view + RDRAM_SIZE)
+        {
+            uint32_t page = (uint32_t)(offset - view) >> PAGE_SHIFT;
+            transient = _code[page] && !_framebuffer[page];
+        }
+    }
+
+    return _handler(_context, rip, transient);
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include <rcp/rdramcontroller.h>
+
+/************************************************************************/
+/* Host mapping of the N64 address space for native memory access.     */
+/* RDRAM is backed by shared memory so it can be mapped at its KSEG0   */
+/* and KSEG1 offsets inside a 4GB reservation, everything else faults. */
+/************************************************************************/
+
+class FastMem
+{
+public:
+    // returns true if execution may resume at the (possibly updated) rip.
+    // transient faults are stores to pages that are only protected while
+    // they hold cached code, anything else will keep faulting
+    typedef bool(*FaultHandler)(void* context, uintptr_t* rip, bool transient);
+
+    static FastMem& getInstance(void);
+
+    // canonical RDRAM view, valid for the life of the process
+    inline uint32_t* getRDRAM(void)
+    {
+        return _rdram;
+    }
+
+    inline uint8_t* getBase(void)
+    {
+        return _base;
+    }
+
+    inline bool isMapped(void)
+    {
+        return nullptr != _base;
+    }
+
+    bool map(FaultHandler handler, void* context);
+    void unmap(void);
+
+    // pages holding cached code are made read-only so stores fault
+    void protectCode(uint32_t page, bool protect);
+
+    // framebuffer pages emulated by the gfx plugin are made inaccessible
+    void protectFramebuffer(uint32_t address, uint32_t length, bool protect);
+
+    // called from the platform fault handler
+    bool handleFault(uintptr_t address, uintptr_t* rip);
+
+private:
+    FastMem(void);
+    ~FastMem(void);
+
+    FastMem(const FastMem&) = delete;
+    FastMem& operator=(const FastMem&) = delete;
+
+    bool createBacking(void);
+    void updatePage(uint32_t page);
+
+private:
+    enum : uint32_t
+    {
+        PAGE_SHIFT = 12,
+        PAGE_COUNT = RDRAM_SIZE >> PAGE_SHIFT
+    };
+
+    uint32_t* _rdram = nullptr;
+    uint8_t* _base = nullptr;
+
+#ifdef _MSC_VER
+    void* _mapping = nullptr;
+    void* _handler_handle = nullptr;
+#else
+    int _fd = -1;
+#endif
+
+    FaultHandler _handler = nullptr;
+    void* _context = nullptr;
+
+    bool _code[PAGE_COUNT];
+    bool _framebuffer[PAGE_COUNT];
+};
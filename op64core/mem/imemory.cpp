@@ -3,6 +3,7 @@
 #include <oplog.h>
 #include <oputil.h>
 
+#include <cpu/icpu.h>
 #include <pif/pif.h>
 #include <rom/sram.h>
 #include <rom/flashram.h>
@@ -40,6 +41,7 @@ bool IMemory::initialize(Bus* bus)
     Bus::rcp.sp.reg[SP_STATUS_REG] = 1;
 
     fill_array(Bus::rcp.sp.stat, 0, SP2_NUM_REGS, 0);
+    Bus::rcp.sp.dma_done = 0;
 
     fill_array(Bus::rcp.dpc.reg, 0, DPC_NUM_REGS, 0);
 
@@ -59,6 +61,7 @@ bool IMemory::initialize(Bus* bus)
     fill_array(Bus::rcp.si.reg, 0, SI_NUM_REGS, 0);
 
     fbInfo[0].addr = 0;
+    fill_array(_rdram_direct, 0, (RDRAM_SIZE >> 16), true);
 
     Bus::rcp.ai.fifo[0].delay = 0;
     Bus::rcp.ai.fifo[1].delay = 0;
@@ -197,6 +200,10 @@ void IMemory::read_rdramFB(uint32_t& address, uint64_t* dest, DataSize size)
                 framebufferRead[(address & 0x7FFFFF) >> 12])
             {
                 _bus->plugins->gfx()->fbRead(address);
+                _bus->cpu->invalidateHostRounding();
+
+                // the plugin filled in the page being read
+                _bus->cpu->invalidateCode(address & 0x7FF000, 0x1000);
                 framebufferRead[(address & 0x7FFFFF) >> 12] = 0;
             }
         }
@@ -210,6 +217,7 @@ void IMemory::write_rdram(uint32_t address, uint64_t src, DataSize size)
 {
     Bus::rdram.setIOMode(RCP_IO_MEM);
     (this->*writesize[size])(Bus::rdram, address, src);
+    _bus->cpu->invalidateCode(address);
 }
 
 void IMemory::write_rdramFB(uint32_t address, uint64_t src, DataSize size)
@@ -223,12 +231,14 @@ void IMemory::write_rdramFB(uint32_t address, uint64_t src, DataSize size)
             if ((address & 0x7FFFFF) >= start && (address & 0x7FFFFF) <= end)
             {
                 _bus->plugins->gfx()->fbWrite(address, 4);
+                _bus->cpu->invalidateHostRounding();
             }
         }
     }
 
     Bus::rdram.setIOMode(RCP_IO_MEM);
     (this->*writesize[size])(Bus::rdram, address, src);
+    _bus->cpu->invalidateCode(address);
 }
 
 //////////////////////////////////////////////////////////////////////////
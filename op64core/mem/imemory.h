@@ -43,6 +43,15 @@ public:
 
     virtual uint32_t* fetch(uint32_t address) = 0;
 
+    // true for unmapped KSEG0/KSEG1 RDRAM addresses that can be accessed
+    // directly, bypassing the memory tables
+    inline bool isDirectRDRAM(uint32_t address)
+    {
+        return (address & 0xc0000000) == 0x80000000 &&
+            (address & 0x1fffffff) < RDRAM_SIZE &&
+            _rdram_direct[(address & 0x1fffffff) >> 16];
+    }
+
 protected:
     // Data read
     void read_size_byte(RCPInterface& device, uint32_t& address, uint64_t* dest);
@@ -117,5 +126,8 @@ protected:
     FrameBufferInfo fbInfo[6];
     uint8_t framebufferRead[0x800];
 
+    // cleared for 64K segments emulated by the gfx plugin
+    bool _rdram_direct[RDRAM_SIZE >> 16];
+
 	uint32_t nops[2] = { 0 };
 };
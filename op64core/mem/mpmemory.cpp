@@ -4,6 +4,7 @@
 #include <oputil.h>
 
 #include "mpmemory.h"
+#include "fastmem.h"
 
 #include <plugin/plugincontainer.h>
 #include <plugin/gfxplugin.h>
@@ -225,6 +226,9 @@ void MPMemory::unprotectFramebuffer(void)
                 fill_array(readmem_table, 0xa000 + start, end - start + 1, &MPMemory::read_rdram);
                 fill_array(writemem_table, 0x8000 + start, end - start + 1, &MPMemory::write_rdram);
                 fill_array(writemem_table, 0xa000 + start, end - start + 1, &MPMemory::write_rdram);
+                fill_array(_rdram_direct, start, end - start + 1, true);
+
+                FastMem::getInstance().protectFramebuffer(start << 16, (end - start + 1) << 16, false);
             }
         }
     }
@@ -257,6 +261,9 @@ void MPMemory::protectFramebuffer(void)
                 fill_array(readmem_table, 0xa000 + start, end - start + 1, &MPMemory::read_rdramFB);
                 fill_array(writemem_table, 0x8000 + start, end - start + 1, &MPMemory::write_rdramFB);
                 fill_array(writemem_table, 0xa000 + start, end - start + 1, &MPMemory::write_rdramFB);
+                fill_array(_rdram_direct, start, end - start + 1, false);
+
+                FastMem::getInstance().protectFramebuffer(start << 16, (end - start + 1) << 16, true);
 
                 start <<= 4;
                 end <<= 4;
@@ -5,6 +5,7 @@
 
 #include <globalstrings.h>
 #include <core/bus.h>
+#include <core/savestate.h>
 #include <rom/rom.h>
 #include <ui/configstore.h>
 
@@ -172,3 +173,33 @@ EEPROM::~EEPROM()
         _eepfile.close();
     }
 }
+
+void EEPROM::saveState(StateWriter& writer)
+{
+    bool loaded = _eepfile.is_open();
+
+    writer.put(loaded);
+
+    if (loaded)
+    {
+        writer.putBytes(_eeprom, sizeof(_eeprom));
+    }
+}
+
+void EEPROM::loadState(Rom* rom, StateReader& reader)
+{
+    if (!reader.get<bool>())
+        return;
+
+    if (!_eepfile.is_open())
+    {
+        loadEEPROM(rom);
+    }
+
+    reader.getBytes(_eeprom, sizeof(_eeprom));
+
+    _eepfile.clear();
+    _eepfile.seekp(0, std::ios::beg);
+    _eepfile.write((char*)_eeprom, sizeof(_eeprom));
+    _eepfile.flush();
+}
@@ -4,6 +4,8 @@
 #include <boost/filesystem/fstream.hpp>
 
 class Rom;
+class StateReader;
+class StateWriter;
 
 class EEPROM
 {
@@ -14,6 +16,10 @@ public:
 public:
     void eepromCommand(Rom* rom, uint8_t* command);
 
+    // a loaded state also rewrites the .eep file
+    void saveState(StateWriter& writer);
+    void loadState(Rom* rom, StateReader& reader);
+
 private:
     void loadEEPROM(Rom* rom);
     void read(Rom* rom, uint8_t* buf, int line);
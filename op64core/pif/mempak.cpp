@@ -2,6 +2,7 @@
 
 #include <globalstrings.h>
 #include <core/bus.h>
+#include <core/savestate.h>
 #include <rom/rom.h>
 #include <ui/configstore.h>
 
@@ -113,6 +114,36 @@ void MemPak::loadMempak(Rom* rom)
     _mempakfile.seekp(0, std::ios::beg);
 }
 
+void MemPak::saveState(StateWriter& writer)
+{
+    bool loaded = _mempakfile.is_open();
+
+    writer.put(loaded);
+
+    if (loaded)
+    {
+        writer.putBytes(_mempaks, sizeof(_mempaks));
+    }
+}
+
+void MemPak::loadState(Rom* rom, StateReader& reader)
+{
+    if (!reader.get<bool>())
+        return;
+
+    if (!_mempakfile.is_open())
+    {
+        loadMempak(rom);
+    }
+
+    reader.getBytes(_mempaks, sizeof(_mempaks));
+
+    _mempakfile.clear();
+    _mempakfile.seekp(0, std::ios::beg);
+    _mempakfile.write((char*)_mempaks, sizeof(_mempaks));
+    _mempakfile.flush();
+}
+
 uint8_t MemPak::calculateCRC(uint8_t* src)
 {
     uint8_t CRC = 0;
@@ -4,6 +4,8 @@
 #include <boost/filesystem/fstream.hpp>
 
 class Rom;
+class StateReader;
+class StateWriter;
 
 class MemPak
 {
@@ -16,6 +18,10 @@ public:
     void read(Rom* rom, int control, int address, uint8_t* buf);
     void write(Rom* rom, int control, int address, uint8_t* buf);
 
+    // a loaded state also rewrites the .mpk file
+    void saveState(StateWriter& writer);
+    void loadState(Rom* rom, StateReader& reader);
+
 private:
     void loadMempak(Rom* rom);
 
@@ -7,6 +7,7 @@
 #include "n64_cic_nus_6105.h"
 
 #include <core/bus.h>
+#include <core/savestate.h>
 #include <rom/rom.h>
 #include <plugin/plugincontainer.h>
 #include <plugin/inputplugin.h>
@@ -45,6 +46,22 @@ void PIF::uninitialize(void)
     _mempak.reset();
 }
 
+void PIF::saveState(StateWriter& writer)
+{
+    writer.putBytes(ram, sizeof(ram));
+
+    _eeprom->saveState(writer);
+    _mempak->saveState(writer);
+}
+
+void PIF::loadState(Bus* bus, StateReader& reader)
+{
+    reader.getBytes(ram, sizeof(ram));
+
+    _eeprom->loadState(bus->rom.get(), reader);
+    _mempak->loadState(bus->rom.get(), reader);
+}
+
 void PIF::pifRead(Bus* bus)
 {
     int32_t i = 0, channel = 0;
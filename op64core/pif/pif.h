@@ -9,6 +9,8 @@
 #define PIF_RAM_SIZE 0x40
 
 class Bus;
+class StateReader;
+class StateWriter;
 
 class PIF : public RCPInterface
 {
@@ -21,6 +23,9 @@ public:
     void pifRead(Bus* bus);
     void pifWrite(Bus* bus);
 
+    void saveState(StateWriter& writer);
+    void loadState(Bus* bus, StateReader& reader);
+
     // Interface
     virtual OPStatus read(Bus* bus, uint32_t address, uint32_t* data) override;
     virtual OPStatus write(Bus* bus, uint32_t address, uint32_t data, uint32_t mask) override;
@@ -0,0 +1,271 @@
+#include <cstring>
+
+#include "nullplugins.h"
+
+#include <oplib.h>
+#include <core/inputtypes.h>
+#include <plugin/plugintypes.h>
+#include <ui/corecontrol.h>
+
+
+// layouts of the info structures the core passes by value
+struct GFX_INFO
+{
+    void* hWnd;
+    void* hStatusBar;
+    int MemoryBswaped;
+    uint8_t* mem[4];
+    uint32_t* reg[23];
+    void(*CheckInterrupts)(void);
+};
+
+struct AUDIO_INFO
+{
+    void* hwnd;
+    void* hinst;
+    int MemoryBswaped;
+    uint8_t* mem[4];
+    uint32_t* reg[7];
+    void(*CheckInterrupts)(void);
+};
+
+struct RSP_INFO
+{
+    void* hInst;
+    int MemoryBswaped;
+    uint8_t* RDRAM;
+    uint8_t* DMEM;
+    uint8_t* IMEM;
+    uint32_t* MI_INTR_REG;
+    uint32_t* sp_reg[9];
+    uint32_t* dpc_reg[8];
+    void(*callbacks[5])(void);
+};
+
+struct CONTROL_INFO
+{
+    void* hMainWindow;
+    void* hinst;
+    int MemoryBswaped;
+    uint8_t* HEADER;
+    CONTROL* Controls;
+};
+
+
+static uint32_t frame_limit = 0;
+static uint32_t frame_count = 0;
+static void(*frame_callback)(uint32_t frame) = nullptr;
+static void(*audio_callback)(uint32_t address, uint32_t length) = nullptr;
+
+static AUDIO_INFO audio_info;
+static RSP_INFO rsp_info;
+
+static void pluginInfo(PLUGIN_INFO* info, uint16_t version, uint16_t type, const char* name)
+{
+    memset(info, 0, sizeof(PLUGIN_INFO));
+    info->Version = version;
+    info->Type = type;
+    strncpy(info->Name, name, sizeof(info->Name) - 1);
+    info->NormalMemory = 1;
+    info->MemoryBswaped = 1;
+}
+
+static void nullFunction(void)
+{
+}
+
+// graphics
+static void gfxGetDllInfo(PLUGIN_INFO* info)
+{
+    pluginInfo(info, 0x0103, PLUGIN_TYPE_GFX, "Null Graphics");
+}
+
+static int gfxInitiate(GFX_INFO /*info*/)
+{
+    return 1;
+}
+
+static void gfxCaptureScreen(const char* /*directory*/)
+{
+}
+
+static void gfxUpdateScreen(void)
+{
+    frame_count++;
+
+    if (frame_callback != nullptr)
+    {
+        frame_callback(frame_count);
+    }
+
+    if (frame_limit != 0 && frame_count >= frame_limit)
+    {
+        CoreControl::stop = true;
+    }
+}
+
+// audio
+static void audioGetDllInfo(PLUGIN_INFO* info)
+{
+    pluginInfo(info, 0x0101, PLUGIN_TYPE_AUDIO, "Null Audio");
+}
+
+static int audioInitiate(AUDIO_INFO info)
+{
+    audio_info = info;
+    return 1;
+}
+
+static void audioLenChanged(void)
+{
+    if (audio_callback != nullptr)
+    {
+        audio_callback(*audio_info.reg[1] & 0xFFFFF8, *audio_info.reg[2] & 0x3FFF8);
+    }
+}
+
+static void audioDacrateChanged(int /*type*/)
+{
+}
+
+static uint32_t audioReadLength(void)
+{
+    return 0;
+}
+
+// rsp
+static void rspGetDllInfo(PLUGIN_INFO* info)
+{
+    pluginInfo(info, 0x0101, PLUGIN_TYPE_RSP, "Null RSP");
+}
+
+static void rspInitiate(RSP_INFO info, unsigned int* /*cycles*/)
+{
+    rsp_info = info;
+}
+
+// every task finishes at once so the game does not wait on the RSP
+static unsigned int rspDoCycles(unsigned int cycles)
+{
+    uint32_t* sp_status = rsp_info.sp_reg[4];
+
+    *sp_status |= 0x203;
+
+    if (*sp_status & 0x40)
+    {
+        *rsp_info.MI_INTR_REG |= 0x01;
+    }
+
+    // graphics task, the display list is done as well
+    if (((uint32_t*)rsp_info.DMEM)[0xFC0 / 4] == 1)
+    {
+        *rsp_info.MI_INTR_REG |= 0x20;
+    }
+
+    return cycles;
+}
+
+// input
+static void inputGetDllInfo(PLUGIN_INFO* info)
+{
+    pluginInfo(info, 0x0101, PLUGIN_TYPE_CONTROLLER, "Null Input");
+}
+
+static void inputInitiate(CONTROL_INFO info)
+{
+    info.Controls[0].Present = 1;
+}
+
+static void inputGetKeys(int /*control*/, BUTTONS* keys)
+{
+    keys->Value = 0;
+}
+
+static void inputCommand(int /*control*/, uint8_t* /*command*/)
+{
+}
+
+
+#define SYMBOL(name, func) { name, (void*)&func }
+
+static const OPLibSymbol gfx_symbols[] = {
+    SYMBOL("GetDllInfo", gfxGetDllInfo),
+    SYMBOL("InitiateGFX", gfxInitiate),
+    SYMBOL("ChangeWindow", nullFunction),
+    SYMBOL("ProcessDList", nullFunction),
+    SYMBOL("ProcessRDPList", nullFunction),
+    SYMBOL("CaptureScreen", gfxCaptureScreen),
+    SYMBOL("ShowCFB", nullFunction),
+    SYMBOL("UpdateScreen", gfxUpdateScreen),
+    SYMBOL("RomOpen", nullFunction),
+    SYMBOL("RomClosed", nullFunction),
+    SYMBOL("CloseDLL", nullFunction),
+    { nullptr, nullptr }
+};
+
+static const OPLibSymbol audio_symbols[] = {
+    SYMBOL("GetDllInfo", audioGetDllInfo),
+    SYMBOL("InitiateAudio", audioInitiate),
+    SYMBOL("AiDacrateChanged", audioDacrateChanged),
+    SYMBOL("AiLenChanged", audioLenChanged),
+    SYMBOL("AiReadLength", audioReadLength),
+    SYMBOL("ProcessAList", nullFunction),
+    SYMBOL("RomOpen", nullFunction),
+    SYMBOL("RomClosed", nullFunction),
+    SYMBOL("CloseDLL", nullFunction),
+    { nullptr, nullptr }
+};
+
+static const OPLibSymbol rsp_symbols[] = {
+    SYMBOL("GetDllInfo", rspGetDllInfo),
+    SYMBOL("InitiateRSP", rspInitiate),
+    SYMBOL("DoRspCycles", rspDoCycles),
+    SYMBOL("RomOpen", nullFunction),
+    SYMBOL("RomClosed", nullFunction),
+    SYMBOL("CloseDLL", nullFunction),
+    { nullptr, nullptr }
+};
+
+static const OPLibSymbol input_symbols[] = {
+    SYMBOL("GetDllInfo", inputGetDllInfo),
+    SYMBOL("InitiateControllers", inputInitiate),
+    SYMBOL("GetKeys", inputGetKeys),
+    SYMBOL("ControllerCommand", inputCommand),
+    SYMBOL("ReadController", inputCommand),
+    SYMBOL("RomOpen", nullFunction),
+    SYMBOL("RomClosed", nullFunction),
+    SYMBOL("CloseDLL", nullFunction),
+    { nullptr, nullptr }
+};
+
+#undef SYMBOL
+
+
+void registerNullPlugins(void)
+{
+    opRegisterLib(NULL_GFX_PLUGIN, gfx_symbols);
+    opRegisterLib(NULL_AUDIO_PLUGIN, audio_symbols);
+    opRegisterLib(NULL_RSP_PLUGIN, rsp_symbols);
+    opRegisterLib(NULL_INPUT_PLUGIN, input_symbols);
+}
+
+void setNullFrameLimit(uint32_t frames)
+{
+    frame_limit = frames;
+    frame_count = 0;
+}
+
+uint32_t getNullFrameCount(void)
+{
+    return frame_count;
+}
+
+void setNullFrameCallback(void(*callback)(uint32_t frame))
+{
+    frame_callback = callback;
+}
+
+void setNullAudioCallback(void(*callback)(uint32_t address, uint32_t length))
+{
+    audio_callback = callback;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+
+/************************************************************************/
+/* Plugins that do nothing, linked into the executable and loaded       */
+/* through the usual plugin path by their registered names.             */
+/************************************************************************/
+
+#define NULL_GFX_PLUGIN     "null-gfx"
+#define NULL_AUDIO_PLUGIN   "null-audio"
+#define NULL_RSP_PLUGIN     "null-rsp"
+#define NULL_INPUT_PLUGIN   "null-input"
+
+void registerNullPlugins(void);
+
+// the graphics plugin stops the core after this many VIs, 0 runs forever
+void setNullFrameLimit(uint32_t frames);
+
+// VIs seen by the graphics plugin since the last setNullFrameLimit
+uint32_t getNullFrameCount(void);
+
+// called by the graphics plugin on every VI with the frame count
+void setNullFrameCallback(void(*callback)(uint32_t frame));
+
+// called by the audio plugin with the RDRAM address and length of every
+// buffer given to the AI
+void setNullAudioCallback(void(*callback)(uint32_t address, uint32_t length));
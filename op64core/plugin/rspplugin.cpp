@@ -1,3 +1,5 @@
+#include <atomic>
+
 #include "rspplugin.h"
 #include "gfxplugin.h"
 #include "audioplugin.h"
@@ -5,9 +7,20 @@
 #include <plugin/plugincontainer.h>
 
 #include <oplog.h>
+#include <globalstrings.h>
 #include <rcp/rcpcommon.h>
 #include <rcp/rcp.h>
 #include <core/bus.h>
+#include <ui/configstore.h>
+
+// set from the RSP thread by a plugin that hands audio lists on, the
+// audio plugin is only called from the emulation thread
+static std::atomic<bool> alist_pending(false);
+
+static void deferAList(void)
+{
+    alist_pending = true;
+}
 
 RSPPlugin::RSPPlugin() :
     IPlugin(),
@@ -18,6 +31,7 @@ RSPPlugin::RSPPlugin() :
 
 RSPPlugin::~RSPPlugin()
 {
+    stopTaskThread();
     closePlugin();
     unloadPlugin();
 }
@@ -95,7 +109,6 @@ OPStatus RSPPlugin::initialize(Bus* bus, PluginContainer* plugins, void* renderW
     Info.ProcessDlist = plugins->gfx()->ProcessDList;
     Info.ProcessRdpList = plugins->gfx()->ProcessRDPList;
     Info.ShowCFB = plugins->gfx()->ShowCFB;
-    Info.ProcessAlist = plugins->audio()->ProcessAList;
 
     Info.hInst = opLibGetMainHandle();
     Info.RDRAM = (uint8_t*)Bus::rdram.mem;
@@ -103,7 +116,13 @@ OPStatus RSPPlugin::initialize(Bus* bus, PluginContainer* plugins, void* renderW
     Info.IMEM = (uint8_t*)Bus::rcp.sp.imem;
     Info.MemoryBswaped = 0;
 
-    Info.MI__INTR_REG = &Bus::rcp.mi.reg[MI_INTR_REG];
+    _threaded = ConfigStore::getInstance().getBool(GlobalStrings::CFG_SECTION_CORE, GlobalStrings::CFG_RSP_THREAD);
+    Info.MI__INTR_REG = _threaded ? &_miIntr : &Bus::rcp.mi.reg[MI_INTR_REG];
+
+    // the audio plugin is busy with AI writes on the emulation thread,
+    // when threaded the list is processed there once the task is finished
+    _processAList = plugins->audio()->ProcessAList;
+    Info.ProcessAlist = _threaded ? deferAList : _processAList;
 
     Info.SP__MEM_ADDR_REG = &Bus::rcp.sp.reg[SP_MEM_ADDR_REG];
     Info.SP__DRAM_ADDR_REG = &Bus::rcp.sp.reg[SP_DRAM_ADDR_REG];
@@ -127,6 +146,12 @@ OPStatus RSPPlugin::initialize(Bus* bus, PluginContainer* plugins, void* renderW
     InitiateRSP(Info, &_cycleCount);
     _initialized = true;
 
+    if (_threaded && !_taskThreadRun)
+    {
+        _taskThreadRun = true;
+        _taskThread = std::thread(RSPPlugin::taskThread, this);
+    }
+
     return OP_OK;
 }
 
@@ -208,3 +233,105 @@ OPStatus RSPPlugin::unloadPlugin()
     return OP_OK;
 }
 
+
+void RSPPlugin::runTask(void)
+{
+    if (!_threaded)
+    {
+        DoRspCycles(0xFFFFFFFF);
+        return;
+    }
+
+    _miIntrBefore = _miIntr = Bus::rcp.mi.reg[MI_INTR_REG];
+    DoRspCycles(0xFFFFFFFF);
+    processDeferredAList();
+    mergeInterrupts();
+}
+
+void RSPPlugin::startTask(void)
+{
+    _miIntrBefore = _miIntr = Bus::rcp.mi.reg[MI_INTR_REG];
+
+    {
+        std::lock_guard<std::mutex> lock(_taskLock);
+        _taskQueued = true;
+    }
+
+    _taskRunning = true;
+    _taskWake.notify_one();
+}
+
+bool RSPPlugin::finishTask(void)
+{
+    if (!_taskRunning)
+    {
+        return false;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(_taskLock);
+        _taskDone.wait(lock, [this] { return !_taskQueued; });
+    }
+
+    _taskRunning = false;
+    processDeferredAList();
+    mergeInterrupts();
+
+    return true;
+}
+
+void RSPPlugin::taskThread(RSPPlugin* plug)
+{
+    std::unique_lock<std::mutex> lock(plug->_taskLock);
+
+    while (true)
+    {
+        plug->_taskWake.wait(lock, [plug] { return plug->_taskQueued || !plug->_taskThreadRun; });
+
+        if (!plug->_taskThreadRun)
+        {
+            break;
+        }
+
+        lock.unlock();
+        plug->DoRspCycles(0xFFFFFFFF);
+        lock.lock();
+
+        plug->_taskQueued = false;
+        plug->_taskDone.notify_all();
+    }
+}
+
+void RSPPlugin::stopTaskThread(void)
+{
+    if (!_taskThreadRun)
+    {
+        return;
+    }
+
+    finishTask();
+
+    {
+        std::lock_guard<std::mutex> lock(_taskLock);
+        _taskThreadRun = false;
+    }
+
+    _taskWake.notify_one();
+    _taskThread.join();
+}
+
+void RSPPlugin::processDeferredAList(void)
+{
+    if (alist_pending.exchange(false) && _processAList != nullptr)
+    {
+        _processAList();
+    }
+}
+
+void RSPPlugin::mergeInterrupts(void)
+{
+    uint32_t set = _miIntr & ~_miIntrBefore;
+    uint32_t cleared = _miIntrBefore & ~_miIntr;
+
+    Bus::rcp.mi.reg[MI_INTR_REG] = (Bus::rcp.mi.reg[MI_INTR_REG] | set) & ~cleared;
+}
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 #include "iplugin.h"
 
 
@@ -13,6 +17,24 @@ public:
 
     unsigned int(*DoRspCycles)(unsigned int);
 
+    // runs the task in DMEM to the end on the calling thread
+    void runTask(void);
+
+    // runs the task on the RSP thread instead, finishTask has to be called
+    // before the CPU touches anything the task could be using
+    void startTask(void);
+    bool finishTask(void);
+
+    inline bool threaded(void) const
+    {
+        return _threaded;
+    }
+
+    inline bool taskRunning(void) const
+    {
+        return _taskRunning;
+    }
+
 protected:
     virtual OPStatus unloadPlugin();
 
@@ -26,6 +48,33 @@ private:
     RSPPlugin(const RSPPlugin&);
     RSPPlugin& operator=(const RSPPlugin&);
 
+    static void taskThread(RSPPlugin* plug);
+
+    void stopTaskThread(void);
+    void processDeferredAList(void);
+    void mergeInterrupts(void);
+
 private:
     uint32_t _cycleCount;
+
+    // set from CFG_RSP_THREAD when the plugin is initialized
+    bool _threaded = false;
+
+    // emulation thread only
+    bool _taskRunning = false;
+
+    std::thread _taskThread;
+    std::mutex _taskLock;
+    std::condition_variable _taskWake;
+    std::condition_variable _taskDone;
+    bool _taskQueued = false;
+    bool _taskThreadRun = false;
+
+    // MI_INTR as the plugin sees it when threaded, the bits a task
+    // changes are applied to the real one when it is finished
+    uint32_t _miIntr = 0;
+    uint32_t _miIntrBefore = 0;
+
+    // audio plugin entry point, called by processDeferredAList when threaded
+    void(*_processAList)(void) = nullptr;
 };
@@ -0,0 +1,842 @@
+#include <emmintrin.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <oplog.h>
+#include <oputil.h>
+
+#include "audiohle.h"
+
+#include <globalstrings.h>
+#include <core/bus.h>
+#include <cpu/icpu.h>
+#include <rcp/rcp.h>
+#include <ui/configstore.h>
+
+using namespace GlobalStrings;
+
+// OSTask fields
+#define TASK_UCODE_DATA 0xFD8
+#define TASK_DATA_PTR   0xFF0
+#define TASK_DATA_SIZE  0xFF4
+
+// buffer offsets in the commands are relative to this
+#define DMEM_BASE 0x5C0
+
+// command flags
+#define A_INIT  0x01
+#define A_LOOP  0x02
+#define A_LEFT  0x02
+#define A_VOL   0x04
+#define A_AUX   0x08
+
+// samples are held in host order words like the rest of SP memory, the
+// vector paths work on them as they are and only the lanes of values
+// computed one sample at a time have to be swapped to match
+#define SWIZZLE ((ENDIAN) & 1)
+
+
+// the microcode's 4 tap filter for every 1/64 between two samples,
+// the taps of a phase sum to about 0x8000
+static const int16_t RESAMPLE_LUT[64 * 4] =
+{
+    (int16_t)0x0c39, (int16_t)0x66ad, (int16_t)0x0d46, (int16_t)0xffdf,
+    (int16_t)0x0b39, (int16_t)0x6696, (int16_t)0x0e5f, (int16_t)0xffd8,
+    (int16_t)0x0a44, (int16_t)0x6669, (int16_t)0x0f83, (int16_t)0xffd0,
+    (int16_t)0x095a, (int16_t)0x6626, (int16_t)0x10b4, (int16_t)0xffc8,
+    (int16_t)0x087d, (int16_t)0x65cd, (int16_t)0x11f0, (int16_t)0xffbf,
+    (int16_t)0x07ab, (int16_t)0x655e, (int16_t)0x1338, (int16_t)0xffb6,
+    (int16_t)0x06e4, (int16_t)0x64d9, (int16_t)0x148c, (int16_t)0xffac,
+    (int16_t)0x0628, (int16_t)0x643f, (int16_t)0x15eb, (int16_t)0xffa1,
+    (int16_t)0x0577, (int16_t)0x638f, (int16_t)0x1756, (int16_t)0xff96,
+    (int16_t)0x04d1, (int16_t)0x62cb, (int16_t)0x18cb, (int16_t)0xff8a,
+    (int16_t)0x0435, (int16_t)0x61f3, (int16_t)0x1a4c, (int16_t)0xff7e,
+    (int16_t)0x03a4, (int16_t)0x6106, (int16_t)0x1bd7, (int16_t)0xff71,
+    (int16_t)0x031c, (int16_t)0x6007, (int16_t)0x1d6c, (int16_t)0xff64,
+    (int16_t)0x029f, (int16_t)0x5ef5, (int16_t)0x1f0b, (int16_t)0xff56,
+    (int16_t)0x022a, (int16_t)0x5dd0, (int16_t)0x20b3, (int16_t)0xff48,
+    (int16_t)0x01be, (int16_t)0x5c9a, (int16_t)0x2264, (int16_t)0xff3a,
+    (int16_t)0x015b, (int16_t)0x5b53, (int16_t)0x241e, (int16_t)0xff2c,
+    (int16_t)0x0101, (int16_t)0x59fc, (int16_t)0x25e0, (int16_t)0xff1e,
+    (int16_t)0x00ae, (int16_t)0x5896, (int16_t)0x27a9, (int16_t)0xff10,
+    (int16_t)0x0063, (int16_t)0x5720, (int16_t)0x297a, (int16_t)0xff02,
+    (int16_t)0x001f, (int16_t)0x559d, (int16_t)0x2b50, (int16_t)0xfef4,
+    (int16_t)0xffe2, (int16_t)0x540d, (int16_t)0x2d2c, (int16_t)0xfee8,
+    (int16_t)0xffac, (int16_t)0x5270, (int16_t)0x2f0d, (int16_t)0xfedb,
+    (int16_t)0xff7c, (int16_t)0x50c7, (int16_t)0x30f3, (int16_t)0xfed0,
+    (int16_t)0xff53, (int16_t)0x4f14, (int16_t)0x32dc, (int16_t)0xfec6,
+    (int16_t)0xff2e, (int16_t)0x4d57, (int16_t)0x34c8, (int16_t)0xfebd,
+    (int16_t)0xff0f, (int16_t)0x4b91, (int16_t)0x36b6, (int16_t)0xfeb6,
+    (int16_t)0xfef5, (int16_t)0x49c2, (int16_t)0x38a5, (int16_t)0xfeb0,
+    (int16_t)0xfedf, (int16_t)0x47ed, (int16_t)0x3a95, (int16_t)0xfeac,
+    (int16_t)0xfece, (int16_t)0x4611, (int16_t)0x3c85, (int16_t)0xfeab,
+    (int16_t)0xfec0, (int16_t)0x4430, (int16_t)0x3e74, (int16_t)0xfeac,
+    (int16_t)0xfeb6, (int16_t)0x424a, (int16_t)0x4060, (int16_t)0xfeaf,
+    (int16_t)0xfeaf, (int16_t)0x4060, (int16_t)0x424a, (int16_t)0xfeb6,
+    (int16_t)0xfeac, (int16_t)0x3e74, (int16_t)0x4430, (int16_t)0xfec0,
+    (int16_t)0xfeab, (int16_t)0x3c85, (int16_t)0x4611, (int16_t)0xfece,
+    (int16_t)0xfeac, (int16_t)0x3a95, (int16_t)0x47ed, (int16_t)0xfedf,
+    (int16_t)0xfeb0, (int16_t)0x38a5, (int16_t)0x49c2, (int16_t)0xfef5,
+    (int16_t)0xfeb6, (int16_t)0x36b6, (int16_t)0x4b91, (int16_t)0xff0f,
+    (int16_t)0xfebd, (int16_t)0x34c8, (int16_t)0x4d57, (int16_t)0xff2e,
+    (int16_t)0xfec6, (int16_t)0x32dc, (int16_t)0x4f14, (int16_t)0xff53,
+    (int16_t)0xfed0, (int16_t)0x30f3, (int16_t)0x50c7, (int16_t)0xff7c,
+    (int16_t)0xfedb, (int16_t)0x2f0d, (int16_t)0x5270, (int16_t)0xffac,
+    (int16_t)0xfee8, (int16_t)0x2d2c, (int16_t)0x540d, (int16_t)0xffe2,
+    (int16_t)0xfef4, (int16_t)0x2b50, (int16_t)0x559d, (int16_t)0x001f,
+    (int16_t)0xff02, (int16_t)0x297a, (int16_t)0x5720, (int16_t)0x0063,
+    (int16_t)0xff10, (int16_t)0x27a9, (int16_t)0x5896, (int16_t)0x00ae,
+    (int16_t)0xff1e, (int16_t)0x25e0, (int16_t)0x59fc, (int16_t)0x0101,
+    (int16_t)0xff2c, (int16_t)0x241e, (int16_t)0x5b53, (int16_t)0x015b,
+    (int16_t)0xff3a, (int16_t)0x2264, (int16_t)0x5c9a, (int16_t)0x01be,
+    (int16_t)0xff48, (int16_t)0x20b3, (int16_t)0x5dd0, (int16_t)0x022a,
+    (int16_t)0xff56, (int16_t)0x1f0b, (int16_t)0x5ef5, (int16_t)0x029f,
+    (int16_t)0xff64, (int16_t)0x1d6c, (int16_t)0x6007, (int16_t)0x031c,
+    (int16_t)0xff71, (int16_t)0x1bd7, (int16_t)0x6106, (int16_t)0x03a4,
+    (int16_t)0xff7e, (int16_t)0x1a4c, (int16_t)0x61f3, (int16_t)0x0435,
+    (int16_t)0xff8a, (int16_t)0x18cb, (int16_t)0x62cb, (int16_t)0x04d1,
+    (int16_t)0xff96, (int16_t)0x1756, (int16_t)0x638f, (int16_t)0x0577,
+    (int16_t)0xffa1, (int16_t)0x15eb, (int16_t)0x643f, (int16_t)0x0628,
+    (int16_t)0xffac, (int16_t)0x148c, (int16_t)0x64d9, (int16_t)0x06e4,
+    (int16_t)0xffb6, (int16_t)0x1338, (int16_t)0x655e, (int16_t)0x07ab,
+    (int16_t)0xffbf, (int16_t)0x11f0, (int16_t)0x65cd, (int16_t)0x087d,
+    (int16_t)0xffc8, (int16_t)0x10b4, (int16_t)0x6626, (int16_t)0x095a,
+    (int16_t)0xffd0, (int16_t)0x0f83, (int16_t)0x6669, (int16_t)0x0a44,
+    (int16_t)0xffd8, (int16_t)0x0e5f, (int16_t)0x6696, (int16_t)0x0b39,
+    (int16_t)0xffdf, (int16_t)0x0d46, (int16_t)0x66ad, (int16_t)0x0c39,
+};
+
+
+static inline uint32_t align(uint32_t x, uint32_t n)
+{
+    return (x + n - 1) & ~(n - 1);
+}
+
+static inline int16_t clamp16(int32_t x)
+{
+    return (int16_t)std::min(std::max(x, -32768), 32767);
+}
+
+static inline uint8_t* dmemU8(uint32_t address)
+{
+    return (uint8_t*)Bus::rcp.sp.dmem + BES(address & 0xFFF);
+}
+
+static inline int16_t* dmemS16(uint32_t address)
+{
+    return (int16_t*)((uint8_t*)Bus::rcp.sp.dmem + HES(address & 0xFFE));
+}
+
+// a word aligned buffer handled a vector at a time
+static inline int16_t* dmemBuffer(uint32_t address)
+{
+    return (int16_t*)((uint8_t*)Bus::rcp.sp.dmem + (address & 0xFFC));
+}
+
+// bytes of a buffer that fit before the end of DMEM
+static inline uint32_t dmemRoom(uint32_t address, uint32_t count)
+{
+    return std::min(count, 0x1000 - (address & 0xFFC));
+}
+
+static inline int16_t* rdramS16(uint32_t address)
+{
+    return (int16_t*)((uint8_t*)Bus::rdram.mem + HES(address & (RDRAM_SIZE - 2)));
+}
+
+static inline uint32_t rdramRoom(uint32_t address, uint32_t count)
+{
+    return std::min(count, RDRAM_SIZE - (address & (RDRAM_SIZE - 1)));
+}
+
+// (a * b + 0x4000) >> 15 in every lane, saturated like VMULF
+static inline __m128i vmulf(__m128i a, __m128i b)
+{
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i round = _mm_set1_epi16(0x4000);
+
+    __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(a, one), _mm_unpacklo_epi16(b, round));
+    __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(a, one), _mm_unpackhi_epi16(b, round));
+
+    return _mm_packs_epi32(_mm_srai_epi32(lo, 15), _mm_srai_epi32(hi, 15));
+}
+
+// 4 dot products of 4 taps, a and b hold the taps of each result in turn
+static inline __m128i dot4(const int16_t* a, const int16_t* b)
+{
+    __m128i p0 = _mm_madd_epi16(_mm_loadu_si128((const __m128i*)a), _mm_loadu_si128((const __m128i*)b));
+    __m128i p1 = _mm_madd_epi16(_mm_loadu_si128((const __m128i*)(a + 8)), _mm_loadu_si128((const __m128i*)(b + 8)));
+
+    __m128 even = _mm_shuffle_ps(_mm_castsi128_ps(p0), _mm_castsi128_ps(p1), _MM_SHUFFLE(2, 0, 2, 0));
+    __m128 odd = _mm_shuffle_ps(_mm_castsi128_ps(p0), _mm_castsi128_ps(p1), _MM_SHUFFLE(3, 1, 3, 1));
+
+    return _mm_add_epi32(_mm_castps_si128(even), _mm_castps_si128(odd));
+}
+
+static inline int32_t rdot(uint32_t n, const int16_t* x, const int16_t* y)
+{
+    int32_t accu = 0;
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        accu += x[i] * y[n - 1 - i];
+    }
+
+    return accu;
+}
+
+// half an ADPCM frame, the 8 residuals and the 2 samples before them
+// through the predictor matrix
+static inline void adpcmPredict(int16_t* dst, const int16_t* residuals, int16_t l1, int16_t l2, const int16_t* matrix)
+{
+    int16_t x[10] = { l1, l2 };
+    memcpy(x + 2, residuals, 8 * sizeof(int16_t));
+
+    __m128i lo = _mm_setzero_si128();
+    __m128i hi = _mm_setzero_si128();
+
+    for (uint32_t p = 0; p < 5; p++)
+    {
+        __m128i pair = _mm_set1_epi32((uint16_t)x[p * 2] | ((uint32_t)(uint16_t)x[p * 2 + 1] << 16));
+
+        lo = _mm_add_epi32(lo, _mm_madd_epi16(pair, _mm_loadu_si128((const __m128i*)(matrix + p * 16))));
+        hi = _mm_add_epi32(hi, _mm_madd_epi16(pair, _mm_loadu_si128((const __m128i*)(matrix + p * 16 + 8))));
+    }
+
+    _mm_storeu_si128((__m128i*)dst, _mm_packs_epi32(_mm_srai_epi32(lo, 11), _mm_srai_epi32(hi, 11)));
+}
+
+struct Ramp
+{
+    int64_t value;
+    int64_t step;
+    int64_t target;
+};
+
+static inline int16_t rampStep(Ramp& ramp)
+{
+    ramp.value += ramp.step;
+
+    bool reached = (ramp.step <= 0) ? (ramp.value <= ramp.target) : (ramp.value >= ramp.target);
+
+    if (reached)
+    {
+        ramp.value = ramp.target;
+        ramp.step = 0;
+    }
+
+    return (int16_t)(ramp.value >> 16);
+}
+
+static inline int32_t loadS32(uint32_t address)
+{
+    return (int32_t)(((uint32_t)(uint16_t)*rdramS16(address) << 16) | (uint16_t)*rdramS16(address + 2));
+}
+
+static inline void storeS32(uint32_t address, int32_t value)
+{
+    *rdramS16(address) = (int16_t)(value >> 16);
+    *rdramS16(address + 2) = (int16_t)value;
+}
+
+
+bool AudioHLE::enabled(void)
+{
+    return ConfigStore::getInstance().getBool(CFG_SECTION_CORE, CFG_HLE_AUDIO);
+}
+
+bool AudioHLE::processTask(Bus* bus)
+{
+    uint32_t ucode_data = Bus::rcp.sp.dmem[TASK_UCODE_DATA / 4];
+
+    // ABI 2 and 3 lists (Nead, MusyX and the like) are refused and left
+    // to the RSP plugin, said once per microcode so it does not flood the log
+    if (!knownMicrocode(ucode_data))
+    {
+        static uint32_t refused = ~0u;
+
+        if (ucode_data != refused)
+        {
+            refused = ucode_data;
+            LOG_INFO(AudioHLE) << "Audio microcode at 0x" << std::hex << ucode_data << " is not ABI 1, the RSP plugin runs it";
+        }
+
+        return false;
+    }
+
+    AudioHLE hle(bus);
+    hle.processList(Bus::rcp.sp.dmem[TASK_DATA_PTR / 4], Bus::rcp.sp.dmem[TASK_DATA_SIZE / 4]);
+
+    return true;
+}
+
+AudioHLE::AudioHLE(Bus* bus)
+    : _bus(bus)
+{
+    memset(_segments, 0, sizeof(_segments));
+    memset(_vol, 0, sizeof(_vol));
+    memset(_target, 0, sizeof(_target));
+    memset(_rate, 0, sizeof(_rate));
+    memset(_table, 0, sizeof(_table));
+}
+
+// the audio microcodes are told apart by their data section
+bool AudioHLE::knownMicrocode(uint32_t ucode_data)
+{
+    ucode_data &= 0xFFFFFC;
+
+    if (ucode_data + 0x34 > RDRAM_SIZE)
+    {
+        return false;
+    }
+
+    const uint32_t* data = Bus::rdram.mem + ucode_data / 4;
+
+    if (data[0] != 0x00000001 || data[0x30 / 4] != 0xF0000F00)
+    {
+        return false;
+    }
+
+    switch (data[0x28 / 4])
+    {
+    case 0x1E24138C: // most games
+    case 0x1DC8138C: // GoldenEye
+    case 0x1E3C1390: // Blast Corps, Diddy Kong Racing
+        return true;
+    }
+
+    return false;
+}
+
+void AudioHLE::processList(uint32_t address, uint32_t size)
+{
+    address &= RDRAM_SIZE - 8;
+    size = rdramRoom(address, size) & ~7;
+
+    const uint32_t* list = Bus::rdram.mem + address / 4;
+
+    for (uint32_t i = 0; i < size / 4; i += 2)
+    {
+        uint32_t w1 = list[i];
+        uint32_t w2 = list[i + 1];
+
+        switch ((w1 >> 24) & 0x7F)
+        {
+        case 0x00: break;
+        case 0x01: adpcm(w1, w2); break;
+        case 0x02: clearBuffer(w1, w2); break;
+        case 0x03: envMixer(w1, w2); break;
+        case 0x04: loadBuffer(w1, w2); break;
+        case 0x05: resample(w1, w2); break;
+        case 0x06: saveBuffer(w1, w2); break;
+        case 0x07: _segments[(w2 >> 24) & 0xF] = w2 & 0xFFFFFF; break;
+        case 0x08: setBuffer(w1, w2); break;
+        case 0x09: setVolume(w1, w2); break;
+        case 0x0A: dmemMove(w1, w2); break;
+        case 0x0B: loadADPCM(w1, w2); break;
+        case 0x0C: mixer(w1, w2); break;
+        case 0x0D: interleave(w1, w2); break;
+        case 0x0E: polef(w1, w2); break;
+        case 0x0F: _loop = segmentAddress(w2); break;
+
+        default:
+            LOG_WARNING(AudioHLE) << "Unknown audio command 0x" << std::hex << ((w1 >> 24) & 0x7F);
+            break;
+        }
+    }
+}
+
+uint32_t AudioHLE::segmentAddress(uint32_t so) const
+{
+    return (_segments[(so >> 24) & 0xF] + (so & 0xFFFFFF)) & 0xFFFFFF;
+}
+
+// rows of the 8x10 matrix taking l1, l2 and the residuals to the 8
+// samples, stored as the pairs of columns madd works on
+const int16_t* AudioHLE::predictor(uint32_t index)
+{
+    int16_t* matrix = _predictors[index];
+
+    if (_predictorsBuilt & (1 << index))
+    {
+        return matrix;
+    }
+
+    const int16_t* book1 = _table + index * 16;
+    const int16_t* book2 = book1 + 8;
+
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        int16_t row[10];
+        row[0] = book1[i];
+        row[1] = book2[i];
+
+        for (uint32_t k = 0; k < 8; k++)
+        {
+            row[k + 2] = (k < i) ? book2[i - 1 - k] : (k == i) ? 2048 : 0;
+        }
+
+        for (uint32_t p = 0; p < 5; p++)
+        {
+            int16_t* pair = matrix + p * 16 + (i >> 2) * 8 + (i & 3) * 2;
+            pair[0] = row[p * 2];
+            pair[1] = row[p * 2 + 1];
+        }
+    }
+
+    _predictorsBuilt |= 1 << index;
+
+    return matrix;
+}
+
+void AudioHLE::adpcm(uint32_t w1, uint32_t w2)
+{
+    uint8_t flags = (uint8_t)(w1 >> 16);
+    uint32_t address = segmentAddress(w2);
+    uint32_t state = (flags & A_LOOP) ? _loop : address;
+
+    int16_t last[16];
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        last[i] = (flags & A_INIT) ? 0 : *rdramS16(state + i * 2);
+    }
+
+    uint32_t in = _in;
+    uint32_t out = _out;
+
+    for (uint32_t i = 0; i < 16; i++, out += 2)
+    {
+        *dmemS16(out) = last[i];
+    }
+
+    for (uint32_t count = align(_count, 32); count != 0; count -= 32)
+    {
+        uint8_t code = *dmemU8(in++);
+        uint32_t scale = code >> 4;
+        uint32_t rshift = (scale < 12) ? 12 - scale : 0;
+
+        int16_t residuals[16];
+
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            uint8_t byte = *dmemU8(in++);
+            residuals[i * 2] = (int16_t)((byte & 0xF0) << 8) >> rshift;
+            residuals[i * 2 + 1] = (int16_t)((byte & 0x0F) << 12) >> rshift;
+        }
+
+        const int16_t* matrix = predictor(code & 0xF);
+        adpcmPredict(last, residuals, last[14], last[15], matrix);
+        adpcmPredict(last + 8, residuals + 8, last[6], last[7], matrix);
+
+        for (uint32_t i = 0; i < 16; i++, out += 2)
+        {
+            *dmemS16(out) = last[i];
+        }
+    }
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        *rdramS16(address + i * 2) = last[i];
+    }
+
+    _bus->cpu->invalidateCode(address & (RDRAM_SIZE - 1), 32);
+}
+
+void AudioHLE::clearBuffer(uint32_t w1, uint32_t w2)
+{
+    uint32_t dmem = (w1 + DMEM_BASE) & 0xFFFF;
+    uint32_t count = align(w2 & 0xFFF, 16);
+
+    if ((dmem & 3) == 0)
+    {
+        memset(dmemBuffer(dmem), 0, dmemRoom(dmem, count));
+        return;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        *dmemU8(dmem + i) = 0;
+    }
+}
+
+void AudioHLE::envMixer(uint32_t w1, uint32_t w2)
+{
+    uint8_t flags = (uint8_t)(w1 >> 16);
+    uint32_t address = segmentAddress(w2);
+    bool aux = (flags & A_AUX) != 0;
+
+    int16_t dry = _dry;
+    int16_t wet = _wet;
+    Ramp ramps[2];
+    int32_t exp_seq[2];
+    int32_t exp_rates[2];
+
+    for (uint32_t lr = 0; lr < 2; lr++)
+    {
+        if (flags & A_INIT)
+        {
+            ramps[lr].value = (int64_t)_vol[lr] * 65536;
+            ramps[lr].target = (int64_t)_target[lr] * 65536;
+            exp_rates[lr] = _rate[lr];
+            exp_seq[lr] = (int32_t)((int64_t)_vol[lr] * _rate[lr]);
+        }
+        else
+        {
+            ramps[lr].target = loadS32(address + 4 + lr * 4);
+            exp_rates[lr] = loadS32(address + 12 + lr * 4);
+            exp_seq[lr] = loadS32(address + 20 + lr * 4);
+            ramps[lr].value = loadS32(address + 28 + lr * 4);
+        }
+
+        ramps[lr].step = ramps[lr].target - ramps[lr].value;
+    }
+
+    if (!(flags & A_INIT))
+    {
+        wet = *rdramS16(address);
+        dry = *rdramS16(address + 2);
+    }
+
+    uint32_t count = dmemRoom(_in, dmemRoom(_out, dmemRoom(_dryRight, align(_count, 16))));
+
+    if (aux)
+    {
+        count = dmemRoom(_wetLeft, dmemRoom(_wetRight, count));
+    }
+
+    count &= ~15;
+
+    const int16_t* in = dmemBuffer(_in);
+    int16_t* dl = dmemBuffer(_out);
+    int16_t* dr = dmemBuffer(_dryRight);
+    int16_t* wl = dmemBuffer(_wetLeft);
+    int16_t* wr = dmemBuffer(_wetRight);
+
+    const __m128i dry_gain = _mm_set1_epi16(dry);
+    const __m128i wet_gain = _mm_set1_epi16(wet);
+
+    // the volumes step one sample at a time, the mixing is 8 at once
+    for (uint32_t y = 0; y < count / 2; y += 8)
+    {
+        for (uint32_t lr = 0; lr < 2; lr++)
+        {
+            if (ramps[lr].step != 0)
+            {
+                exp_seq[lr] = (int32_t)(((int64_t)exp_seq[lr] * exp_rates[lr]) >> 16);
+                ramps[lr].step = (exp_seq[lr] - ramps[lr].value) >> 3;
+            }
+        }
+
+        int16_t vol[2][8];
+
+        for (uint32_t x = 0; x < 8; x++)
+        {
+            vol[0][x ^ SWIZZLE] = rampStep(ramps[0]);
+            vol[1][x ^ SWIZZLE] = rampStep(ramps[1]);
+        }
+
+        __m128i left = _mm_loadu_si128((const __m128i*)vol[0]);
+        __m128i right = _mm_loadu_si128((const __m128i*)vol[1]);
+        __m128i src = _mm_loadu_si128((const __m128i*)(in + y));
+
+        __m128i v = _mm_loadu_si128((const __m128i*)(dl + y));
+        _mm_storeu_si128((__m128i*)(dl + y), _mm_adds_epi16(v, vmulf(src, vmulf(left, dry_gain))));
+
+        v = _mm_loadu_si128((const __m128i*)(dr + y));
+        _mm_storeu_si128((__m128i*)(dr + y), _mm_adds_epi16(v, vmulf(src, vmulf(right, dry_gain))));
+
+        if (aux)
+        {
+            v = _mm_loadu_si128((const __m128i*)(wl + y));
+            _mm_storeu_si128((__m128i*)(wl + y), _mm_adds_epi16(v, vmulf(src, vmulf(left, wet_gain))));
+
+            v = _mm_loadu_si128((const __m128i*)(wr + y));
+            _mm_storeu_si128((__m128i*)(wr + y), _mm_adds_epi16(v, vmulf(src, vmulf(right, wet_gain))));
+        }
+    }
+
+    *rdramS16(address) = wet;
+    *rdramS16(address + 2) = dry;
+
+    for (uint32_t lr = 0; lr < 2; lr++)
+    {
+        storeS32(address + 4 + lr * 4, (int32_t)ramps[lr].target);
+        storeS32(address + 12 + lr * 4, exp_rates[lr]);
+        storeS32(address + 20 + lr * 4, exp_seq[lr]);
+        storeS32(address + 28 + lr * 4, (int32_t)ramps[lr].value);
+    }
+
+    _bus->cpu->invalidateCode(address & (RDRAM_SIZE - 1), 36);
+}
+
+void AudioHLE::loadBuffer(uint32_t /*w1*/, uint32_t w2)
+{
+    if (_count == 0)
+    {
+        return;
+    }
+
+    uint32_t dmem = _in & ~3;
+    uint32_t address = segmentAddress(w2) & (RDRAM_SIZE - 8);
+    uint32_t count = rdramRoom(address, dmemRoom(dmem, align(_count, 8)));
+
+    memcpy(dmemBuffer(dmem), (uint8_t*)Bus::rdram.mem + address, count);
+}
+
+void AudioHLE::resample(uint32_t w1, uint32_t w2)
+{
+    uint8_t flags = (uint8_t)(w1 >> 16);
+    uint32_t pitch = (w1 & 0xFFFF) << 1;
+    uint32_t address = segmentAddress(w2);
+
+    // the 4 samples before the input are the end of the last call
+    uint32_t ipos = (_in >> 1) - 4;
+    uint32_t opos = _out >> 1;
+    uint32_t pitch_accu = (flags & A_INIT) ? 0 : (uint16_t)*rdramS16(address + 8);
+
+    for (uint32_t k = 0; k < 4; k++)
+    {
+        *dmemS16((ipos + k) << 1) = (flags & A_INIT) ? 0 : *rdramS16(address + k * 2);
+    }
+
+    // positions move one sample at a time, the filter runs on 8 at once
+    for (uint32_t count = align(_count, 16) >> 1; count != 0; count -= 8)
+    {
+        int16_t taps[32];
+        int16_t coefs[32];
+
+        for (uint32_t j = 0; j < 8; j++)
+        {
+            const int16_t* lut = RESAMPLE_LUT + ((pitch_accu & 0xFC00) >> 8);
+
+            for (uint32_t k = 0; k < 4; k++)
+            {
+                taps[j * 4 + k] = *dmemS16((ipos + k) << 1);
+                coefs[j * 4 + k] = lut[k];
+            }
+
+            pitch_accu += pitch;
+            ipos += pitch_accu >> 16;
+            pitch_accu &= 0xFFFF;
+        }
+
+        __m128i lo = _mm_srai_epi32(dot4(taps, coefs), 15);
+        __m128i hi = _mm_srai_epi32(dot4(taps + 16, coefs + 16), 15);
+
+        int16_t samples[8];
+        _mm_storeu_si128((__m128i*)samples, _mm_packs_epi32(lo, hi));
+
+        for (uint32_t j = 0; j < 8; j++, opos++)
+        {
+            *dmemS16(opos << 1) = samples[j];
+        }
+    }
+
+    for (uint32_t k = 0; k < 4; k++)
+    {
+        *rdramS16(address + k * 2) = *dmemS16((ipos + k) << 1);
+    }
+
+    *rdramS16(address + 8) = (int16_t)pitch_accu;
+
+    _bus->cpu->invalidateCode(address & (RDRAM_SIZE - 1), 10);
+}
+
+void AudioHLE::saveBuffer(uint32_t /*w1*/, uint32_t w2)
+{
+    if (_count == 0)
+    {
+        return;
+    }
+
+    uint32_t dmem = _out & ~3;
+    uint32_t address = segmentAddress(w2) & (RDRAM_SIZE - 8);
+    uint32_t count = rdramRoom(address, dmemRoom(dmem, align(_count, 8)));
+
+    memcpy((uint8_t*)Bus::rdram.mem + address, dmemBuffer(dmem), count);
+
+    _bus->cpu->invalidateCode(address, count);
+}
+
+void AudioHLE::setBuffer(uint32_t w1, uint32_t w2)
+{
+    uint8_t flags = (uint8_t)(w1 >> 16);
+
+    if (flags & A_AUX)
+    {
+        _dryRight = (uint16_t)(w1 + DMEM_BASE);
+        _wetLeft = (uint16_t)((w2 >> 16) + DMEM_BASE);
+        _wetRight = (uint16_t)(w2 + DMEM_BASE);
+    }
+    else
+    {
+        _in = (uint16_t)(w1 + DMEM_BASE);
+        _out = (uint16_t)((w2 >> 16) + DMEM_BASE);
+        _count = (uint16_t)w2;
+    }
+}
+
+void AudioHLE::setVolume(uint32_t w1, uint32_t w2)
+{
+    uint8_t flags = (uint8_t)(w1 >> 16);
+
+    if (flags & A_AUX)
+    {
+        _dry = (int16_t)w1;
+        _wet = (int16_t)w2;
+        return;
+    }
+
+    uint32_t lr = (flags & A_LEFT) ? 0 : 1;
+
+    if (flags & A_VOL)
+    {
+        _vol[lr] = (int16_t)w1;
+    }
+    else
+    {
+        _target[lr] = (int16_t)w1;
+        _rate[lr] = (int32_t)w2;
+    }
+}
+
+void AudioHLE::dmemMove(uint32_t w1, uint32_t w2)
+{
+    uint32_t in = (w1 + DMEM_BASE) & 0xFFFF;
+    uint32_t out = ((w2 >> 16) + DMEM_BASE) & 0xFFFF;
+    uint32_t count = align(w2 & 0xFFFF, 16);
+
+    if (((in | out) & 3) == 0)
+    {
+        memmove(dmemBuffer(out), dmemBuffer(in), dmemRoom(in, dmemRoom(out, count)));
+        return;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        *dmemU8(out + i) = *dmemU8(in + i);
+    }
+}
+
+void AudioHLE::loadADPCM(uint32_t w1, uint32_t w2)
+{
+    uint32_t count = std::min(align(w1 & 0xFFFF, 8) >> 1, (uint32_t)(sizeof(_table) / sizeof(_table[0])));
+    uint32_t address = segmentAddress(w2);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        _table[i] = *rdramS16(address + i * 2);
+    }
+
+    _predictorsBuilt = 0;
+}
+
+void AudioHLE::mixer(uint32_t w1, uint32_t w2)
+{
+    if (_count == 0)
+    {
+        return;
+    }
+
+    uint32_t in = (w2 >> 16) + DMEM_BASE;
+    uint32_t out = (w2 & 0xFFFF) + DMEM_BASE;
+    uint32_t count = dmemRoom(in, dmemRoom(out, align(_count, 32))) & ~15;
+
+    const int16_t* src = dmemBuffer(in);
+    int16_t* dst = dmemBuffer(out);
+    const __m128i gain = _mm_set1_epi16((int16_t)w1);
+
+    for (uint32_t i = 0; i < count / 2; i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_adds_epi16(v, vmulf(s, gain)));
+    }
+}
+
+void AudioHLE::interleave(uint32_t /*w1*/, uint32_t w2)
+{
+    if (_count == 0)
+    {
+        return;
+    }
+
+    uint32_t left = (w2 >> 16) + DMEM_BASE;
+    uint32_t right = (w2 & 0xFFFF) + DMEM_BASE;
+    uint32_t count = dmemRoom(left, dmemRoom(right, std::min(align(_count, 16), dmemRoom(_out, 0x2000) / 2))) & ~15;
+
+    const int16_t* l = dmemBuffer(left);
+    const int16_t* r = dmemBuffer(right);
+    int16_t* dst = dmemBuffer(_out);
+
+    // every word of the output is a left and a right sample, the first
+    // sample of a word being in its upper half
+    for (uint32_t i = 0; i < count / 2; i += 8)
+    {
+        __m128i vl = _mm_loadu_si128((const __m128i*)(l + i));
+        __m128i vr = _mm_loadu_si128((const __m128i*)(r + i));
+
+        __m128i lo = _mm_shuffle_epi32(_mm_unpacklo_epi16(vr, vl), _MM_SHUFFLE(2, 3, 0, 1));
+        __m128i hi = _mm_shuffle_epi32(_mm_unpackhi_epi16(vr, vl), _MM_SHUFFLE(2, 3, 0, 1));
+
+        _mm_storeu_si128((__m128i*)(dst + i * 2), lo);
+        _mm_storeu_si128((__m128i*)(dst + i * 2 + 8), hi);
+    }
+}
+
+void AudioHLE::polef(uint32_t w1, uint32_t w2)
+{
+    if (_count == 0)
+    {
+        return;
+    }
+
+    uint8_t flags = (uint8_t)(w1 >> 16);
+    int16_t gain = (int16_t)w1;
+    uint32_t address = segmentAddress(w2);
+
+    const int16_t* h1 = _table;
+    const int16_t* h2 = _table + 8;
+
+    int16_t h2_gain[8];
+
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        h2_gain[i] = (int16_t)(((int32_t)h2[i] * gain) >> 14);
+    }
+
+    int16_t l1 = (flags & A_INIT) ? 0 : *rdramS16(address + 4);
+    int16_t l2 = (flags & A_INIT) ? 0 : *rdramS16(address + 6);
+
+    uint32_t in = _in;
+    uint32_t out = _out;
+    int16_t frame[8];
+    int16_t filtered[8];
+
+    for (uint32_t count = align(_count, 16); count != 0; count -= 16)
+    {
+        for (uint32_t i = 0; i < 8; i++, in += 2)
+        {
+            frame[i] = *dmemS16(in);
+        }
+
+        for (uint32_t i = 0; i < 8; i++, out += 2)
+        {
+            int32_t accu = frame[i] * gain + h1[i] * l1 + h2[i] * l2 + rdot(i, h2_gain, frame);
+            filtered[i] = clamp16(accu >> 14);
+            *dmemS16(out) = filtered[i];
+        }
+
+        l1 = filtered[6];
+        l2 = filtered[7];
+    }
+
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        *rdramS16(address + i * 2) = filtered[i + 4];
+    }
+
+    _bus->cpu->invalidateCode(address & (RDRAM_SIZE - 1), 8);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+
+class Bus;
+
+
+/************************************************************************/
+/* Runs the audio lists of the ABI 1 microcodes in the core, used       */
+/* instead of the RSP plugin when CFG_HLE_AUDIO is set. Other audio     */
+/* microcodes (ABI 2 and 3) still go to the plugin. Buffers live in     */
+/* DMEM where the microcode keeps them, samples go straight to RDRAM    */
+/************************************************************************/
+class AudioHLE
+{
+public:
+    static bool enabled(void);
+
+    // runs the audio task in DMEM to the end, false if its microcode is
+    // not ABI 1 and the plugin has to run it
+    static bool processTask(Bus* bus);
+
+private:
+    AudioHLE(Bus* bus);
+
+    static bool knownMicrocode(uint32_t ucode_data);
+
+    void processList(uint32_t address, uint32_t size);
+
+    uint32_t segmentAddress(uint32_t so) const;
+    const int16_t* predictor(uint32_t index);
+
+    void adpcm(uint32_t w1, uint32_t w2);
+    void clearBuffer(uint32_t w1, uint32_t w2);
+    void envMixer(uint32_t w1, uint32_t w2);
+    void loadBuffer(uint32_t w1, uint32_t w2);
+    void resample(uint32_t w1, uint32_t w2);
+    void saveBuffer(uint32_t w1, uint32_t w2);
+    void setBuffer(uint32_t w1, uint32_t w2);
+    void setVolume(uint32_t w1, uint32_t w2);
+    void dmemMove(uint32_t w1, uint32_t w2);
+    void loadADPCM(uint32_t w1, uint32_t w2);
+    void mixer(uint32_t w1, uint32_t w2);
+    void interleave(uint32_t w1, uint32_t w2);
+    void polef(uint32_t w1, uint32_t w2);
+
+private:
+    Bus* _bus;
+
+    uint32_t _segments[16];
+
+    // main buffers
+    uint16_t _in = 0;
+    uint16_t _out = 0;
+    uint16_t _count = 0;
+
+    // auxiliary buffers
+    uint16_t _dryRight = 0;
+    uint16_t _wetLeft = 0;
+    uint16_t _wetRight = 0;
+
+    // envelopes, 0 is left and 1 right
+    int16_t _dry = 0;
+    int16_t _wet = 0;
+    int16_t _vol[2];
+    int16_t _target[2];
+    int32_t _rate[2];
+
+    uint32_t _loop = 0;
+
+    // ADPCM codebook, 16 predictors of two 8 coefficient rows
+    int16_t _table[16 * 16];
+
+    // each predictor as the matrix one half frame is decoded with,
+    // built on first use after the codebook is loaded
+    int16_t _predictors[16][80];
+    uint32_t _predictorsBuilt = 0;
+};
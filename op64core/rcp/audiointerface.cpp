@@ -19,9 +19,11 @@ OPStatus AudioInterface::read(Bus* bus, uint32_t address, uint32_t* data)
     if (regnum == AI_LEN_REG)
     {
         bus->cpu->getCP0().updateCount(Bus::state.PC, bus->rom->getCountPerOp());
-        if (fifo[0].delay != 0 && bus->interrupt->findEvent(AI_INT) != 0 && (bus->interrupt->findEvent(AI_INT) - Bus::state.cp0_reg[CP0_COUNT_REG]) < 0x80000000)
+        uint64_t ai_event = bus->interrupt->findEvent(AI_INT);
+
+        if (fifo[0].delay != 0 && ai_event > Bus::state.cycles)
         {
-            *data = ((bus->interrupt->findEvent(AI_INT) - Bus::state.cp0_reg[CP0_COUNT_REG])*(int64_t)fifo[0].length) / fifo[0].delay;
+            *data = (uint32_t)(((ai_event - Bus::state.cycles) * fifo[0].length) / fifo[0].delay);
         }
         else
         {
@@ -48,6 +50,7 @@ OPStatus AudioInterface::write(Bus* bus, uint32_t address, uint32_t data, uint32
         if (bus->plugins->audio()->LenChanged != nullptr)
         {
             bus->plugins->audio()->LenChanged();
+            bus->cpu->invalidateHostRounding();
         }
 
         freq = bus->rom->getAiDACRate() / (reg[AI_DACRATE_REG] + 1);
@@ -80,6 +83,7 @@ OPStatus AudioInterface::write(Bus* bus, uint32_t address, uint32_t data, uint32
         {
             masked_write(&reg[AI_DACRATE_REG], data, mask);
             bus->plugins->audio()->DacrateChanged(bus->rom->getSystemType());
+            bus->cpu->invalidateHostRounding();
         }
         return OP_OK;
     }
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include <oputil.h>
+
+
+// Copies length bytes between two memories held as host order words,
+// given their big endian byte addresses. When both sides have the same
+// alignment within a word the words are copied as they are, only the
+// head and tail bytes need swizzling
+inline void dmaCopy(uint8_t* dst, uint32_t dst_addr, const uint8_t* src, uint32_t src_addr, uint32_t length)
+{
+    if (((dst_addr ^ src_addr) & 3) == 0)
+    {
+        for (; length != 0 && (dst_addr & 3) != 0; length--)
+        {
+            dst[BES(dst_addr++)] = src[BES(src_addr++)];
+        }
+
+        uint32_t words = length & ~3;
+        memcpy(dst + dst_addr, src + src_addr, words);
+
+        dst_addr += words;
+        src_addr += words;
+        length -= words;
+    }
+
+    for (; length != 0; length--)
+    {
+        dst[BES(dst_addr++)] = src[BES(src_addr++)];
+    }
+}
+
+// Copies count rows of length bytes, each side moves on by its skip
+// after a row. Rows without a gap on either side are one transfer
+inline void dmaCopyRows(uint8_t* dst, uint32_t dst_addr, uint32_t dst_skip, const uint8_t* src, uint32_t src_addr, uint32_t src_skip, uint32_t length, uint32_t count)
+{
+    if (dst_skip == 0 && src_skip == 0)
+    {
+        length *= count;
+        count = 1;
+    }
+
+    for (uint32_t j = 0; j < count; j++)
+    {
+        dmaCopy(dst, dst_addr, src, src_addr, length);
+        dst_addr += length + dst_skip;
+        src_addr += length + src_skip;
+    }
+}
@@ -0,0 +1,59 @@
+#include "dmatiming.h"
+
+#include <globalstrings.h>
+#include <core/bus.h>
+#include <rcp/rcp.h>
+#include <ui/configstore.h>
+
+using namespace GlobalStrings;
+
+// PI cycles spent on every page besides its latency
+#define PI_PAGE_OVERHEAD 19
+
+// RDRAM moves 8 bytes per RCP cycle, every row is a new request
+#define SP_ROW_OVERHEAD 8
+
+// 64 bytes through the PIF, measured on hardware
+#define SI_TRANSFER_CYCLES 0x900
+
+
+// the RCP runs at 62.5MHz, cycles count at half the 93.75MHz CPU clock
+static inline uint64_t rcpToCycles(uint64_t rcp_cycles)
+{
+    return rcp_cycles * 3 / 4;
+}
+
+bool DMATiming::enabled(void)
+{
+    return ConfigStore::getInstance().getBool(CFG_SECTION_CORE, CFG_DMA_TIMING);
+}
+
+uint64_t DMATiming::piTransfer(uint32_t cart_addr, uint32_t length)
+{
+    // 64DD registers and SRAM/FlashRAM are on domain 2, everything else on domain 1
+    bool dom2 = (cart_addr >= 0x05000000 && cart_addr < 0x06000000)
+        || (cart_addr >= 0x08000000 && cart_addr < 0x10000000);
+
+    const uint32_t* bsd = &Bus::rcp.pi.reg[dom2 ? PI_BSD_DOM2_LAT_REG : PI_BSD_DOM1_LAT_REG];
+
+    uint64_t latency = (bsd[0] & 0xff) + 1;
+    uint64_t pulse = (bsd[1] & 0xff) + 1;
+    uint64_t page = 1ULL << ((bsd[2] & 0xf) + 2);
+    uint64_t release = (bsd[3] & 0x3) + 1;
+
+    // every page waits out the latency, every halfword is one pulse and release
+    uint64_t pages = (length + page - 1) / page;
+    uint64_t halfwords = ((uint64_t)length + 1) / 2;
+
+    return rcpToCycles(pages * (latency + PI_PAGE_OVERHEAD) + halfwords * (pulse + release));
+}
+
+uint64_t DMATiming::spTransfer(uint32_t length, uint32_t count)
+{
+    return rcpToCycles((uint64_t)count * (length / 8 + SP_ROW_OVERHEAD));
+}
+
+uint64_t DMATiming::siTransfer(void)
+{
+    return SI_TRANSFER_CYCLES;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+
+/************************************************************************/
+/* How long PI, SP and SI transfers take on hardware, used instead of   */
+/* the fixed delays when CFG_DMA_TIMING is set. All results are in      */
+/* cycles, see ProgramState::cycles                                     */
+/************************************************************************/
+class DMATiming
+{
+public:
+    static bool enabled(void);
+
+    // from the PI_BSD_DOM* settings of the domain cart_addr is on
+    static uint64_t piTransfer(uint32_t cart_addr, uint32_t length);
+
+    static uint64_t spTransfer(uint32_t length, uint32_t count);
+
+    static uint64_t siTransfer(void);
+};
@@ -6,16 +6,21 @@
 #include <rcp/rcp.h>
 #include <plugin/plugincontainer.h>
 #include <plugin/gfxplugin.h>
+#include <cpu/icpu.h>
 #include <cpu/interrupthandler.h>
 
 OPStatus DPCInterface::read(Bus* bus, uint32_t address, uint32_t* data)
 {
+    Bus::rcp.sp.syncTask(bus);
+
     *data = reg[DPC_REG(address)];
     return OP_OK;
 }
 
 OPStatus DPCInterface::write(Bus* bus, uint32_t address, uint32_t data, uint32_t mask)
 {
+    Bus::rcp.sp.syncTask(bus);
+
     uint32_t regnum = DPC_REG(address);
 
     switch (regnum)
@@ -40,6 +45,7 @@ OPStatus DPCInterface::write(Bus* bus, uint32_t address, uint32_t data, uint32_t
         break;
     case DPC_END_REG:
         bus->plugins->gfx()->ProcessRDPList();
+        bus->cpu->invalidateHostRounding();
         Bus::rcp.mi.reg[MI_INTR_REG] |= 0x20;
         bus->interrupt->checkInterrupt();
         break;
@@ -32,9 +32,11 @@ OPStatus MIPSInterface::write(Bus* bus, uint32_t address, uint32_t data, uint32_
         bus->interrupt->checkInterrupt();
         bus->cpu->getCP0().updateCount(Bus::state.PC, bus->rom->getCountPerOp());
 
-        if (Bus::state.next_interrupt <= Bus::state.cp0_reg[CP0_COUNT_REG])
+        Bus::state.interrupt_unsafe_state = true;
+        if (Bus::state.next_interrupt <= Bus::state.cycles)
             bus->interrupt->generateInterrupt();
 
+        Bus::state.interrupt_unsafe_state = false;
         break;
     }
 
@@ -5,6 +5,8 @@
 
 #include <core/bus.h>
 #include <rcp/rcp.h>
+#include <rcp/dma.h>
+#include <rcp/dmatiming.h>
 #include <cpu/icpu.h>
 #include <cpu/cp0.h>
 #include <cpu/interrupthandler.h>
@@ -46,9 +48,12 @@ void PeripheralInterface::DMARead(Bus* bus)
         LOG_WARNING(PeripheralInterface) << "Unknown dma read";
     }
 
+    uint64_t delay = DMATiming::enabled() ?
+        DMATiming::piTransfer(Bus::rcp.pi.reg[PI_CART_ADDR_REG], (Bus::rcp.pi.reg[PI_RD_LEN_REG] & 0xFFFFFF) + 1) : 0x1000;
+
     Bus::rcp.pi.reg[PI_STATUS_REG] |= 1;
     bus->cpu->getCP0().updateCount(Bus::state.PC, bus->rom->getCountPerOp());
-    bus->interrupt->addInterruptEvent(PI_INT, 0x1000/*Bus::rcp.pi.register.pi_rd_len_reg*/);
+    bus->interrupt->addInterruptEvent(PI_INT, delay/*Bus::rcp.pi.register.pi_rd_len_reg*/);
 }
 
 void PeripheralInterface::DMAWrite(Bus* bus)
@@ -78,6 +83,8 @@ void PeripheralInterface::DMAWrite(Bus* bus)
                     (Bus::rcp.pi.reg[PI_CART_ADDR_REG] - 0x08000000) & 0xFFFF,
                     (Bus::rcp.pi.reg[PI_WR_LEN_REG] & 0xFFFFFF) + 1);
             }
+
+            bus->cpu->invalidateCode(Bus::rcp.pi.reg[PI_DRAM_ADDR_REG], (Bus::rcp.pi.reg[PI_WR_LEN_REG] & 0xFFFFFF) + 1);
         }
         else if (Bus::rcp.pi.reg[PI_CART_ADDR_REG] >= 0x06000000
             && Bus::rcp.pi.reg[PI_CART_ADDR_REG] < 0x08000000)
@@ -88,9 +95,12 @@ void PeripheralInterface::DMAWrite(Bus* bus)
             LOG_WARNING(PeripheralInterface) << "Unknown dma write 0x" << std::hex << (int32_t) Bus::rcp.pi.reg[PI_CART_ADDR_REG];
         }
 
+        uint64_t delay = DMATiming::enabled() ?
+            DMATiming::piTransfer(Bus::rcp.pi.reg[PI_CART_ADDR_REG], (Bus::rcp.pi.reg[PI_WR_LEN_REG] & 0xFFFFFF) + 1) : 0x1000;
+
         Bus::rcp.pi.reg[PI_STATUS_REG] |= 1;
         bus->cpu->getCP0().updateCount(Bus::state.PC, bus->rom->getCountPerOp());
-        bus->interrupt->addInterruptEvent(PI_INT, /*Bus::rcp.pi.register.pi_wr_len_reg*/0x1000);
+        bus->interrupt->addInterruptEvent(PI_INT, delay/*Bus::rcp.pi.register.pi_wr_len_reg*/);
 
         return;
     }
@@ -121,11 +131,9 @@ void PeripheralInterface::DMAWrite(Bus* bus)
         return;
     }
 
-    for(i = 0; i < longueur; i++)
-    {
-        ((uint8_t*)Bus::rdram.mem)[BES(Bus::rcp.pi.reg[PI_DRAM_ADDR_REG] + i)] =
-            bus->rom->getImage()[BES(((Bus::rcp.pi.reg[PI_CART_ADDR_REG] - 0x10000000) & 0x3FFFFFF) + i)];
-    }
+    dmaCopy((uint8_t*)Bus::rdram.mem, Bus::rcp.pi.reg[PI_DRAM_ADDR_REG], bus->rom->getImage(), i, longueur);
+
+    bus->cpu->invalidateCode(Bus::rcp.pi.reg[PI_DRAM_ADDR_REG], longueur);
 
     // Set the RDRAM memory size when copying main ROM code
     // (This is just a convenient way to run this code once at the beginning)
@@ -145,9 +153,12 @@ void PeripheralInterface::DMAWrite(Bus* bus)
         }
     }
 
+    uint64_t delay = DMATiming::enabled() ?
+        DMATiming::piTransfer(Bus::rcp.pi.reg[PI_CART_ADDR_REG], longueur) : longueur / 8;
+
     Bus::rcp.pi.reg[PI_STATUS_REG] |= 3;
     bus->cpu->getCP0().updateCount(Bus::state.PC, bus->rom->getCountPerOp());
-    bus->interrupt->addInterruptEvent(PI_INT, longueur / 8);
+    bus->interrupt->addInterruptEvent(PI_INT, delay);
 }
 
 OPStatus PeripheralInterface::read(Bus* bus, uint32_t address, uint32_t* data)
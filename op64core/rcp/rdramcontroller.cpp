@@ -1,8 +1,14 @@
 #include "rdramcontroller.h"
 #include "oputil.h"
 
+#include <mem/fastmem.h>
 
 
+RDRAMController::RDRAMController(void) :
+    mem(FastMem::getInstance().getRDRAM())
+{
+}
+
 OPStatus RDRAMController::read(Bus* bus, uint32_t address, uint32_t* data)
 {
     switch (_iomode)
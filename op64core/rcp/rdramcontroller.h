@@ -11,6 +11,8 @@
 class RDRAMController : public RCPInterface, public RegisterInterface
 {
 public:
+    RDRAMController(void);
+
     virtual OPStatus read(Bus* bus, uint32_t address, uint32_t* data) override;
     virtual OPStatus write(Bus* bus, uint32_t address, uint32_t data, uint32_t mask) override;
 
@@ -22,5 +24,6 @@ private:
     OPStatus writeReg(uint32_t address, uint32_t data, uint32_t mask);
 
 public:
-    alignas(16) uint32_t mem[RDRAM_SIZE / 4];
+    // owned by FastMem so it can also be mapped into the guest address space
+    uint32_t* const mem;
 };
@@ -1,8 +1,13 @@
+#include <algorithm>
+
 #include <oputil.h>
 
 #include "rspinterface.h"
 
 #include <rcp/rcp.h>
+#include <rcp/audiohle.h>
+#include <rcp/dma.h>
+#include <rcp/dmatiming.h>
 #include <core/bus.h>
 #include <plugin/plugincontainer.h>
 #include <plugin/gfxplugin.h>
@@ -13,7 +18,7 @@
 #include <mem/mpmemory.h>
 
 
-void RSPInterface::DMARead(void)
+void RSPInterface::DMARead(Bus* bus)
 {
     uint32_t len_reg = Bus::rcp.sp.reg[SP_WR_LEN_REG];
 
@@ -27,17 +32,14 @@ void RSPInterface::DMARead(void)
     uint8_t* spmem = ((Bus::rcp.sp.reg[SP_MEM_ADDR_REG] & 0x1000) != 0) ? (uint8_t*) Bus::rcp.sp.imem : (uint8_t*) Bus::rcp.sp.dmem;
     uint8_t* dram = (uint8_t*)Bus::rdram.mem;
 
-    for (uint32_t j = 0; j < count; j++) {
-        for (uint32_t i = 0; i < length; i++) {
-            dram[BES(dramaddr)] = spmem[BES(memaddr)];
-            memaddr++;
-            dramaddr++;
-        }
-        dramaddr += skip;
-    }
+    delayDMA(bus, length, count);
+
+    dmaCopyRows(dram, dramaddr, skip, spmem, memaddr, 0, length, count);
+
+    bus->cpu->invalidateCode(dramaddr, count * (length + skip));
 }
 
-void RSPInterface::DMAWrite(void)
+void RSPInterface::DMAWrite(Bus* bus)
 {
     uint32_t len_reg = Bus::rcp.sp.reg[SP_RD_LEN_REG];
 
@@ -51,18 +53,28 @@ void RSPInterface::DMAWrite(void)
     uint8_t* spmem = ((Bus::rcp.sp.reg[SP_MEM_ADDR_REG] & 0x1000) != 0) ? (uint8_t*) Bus::rcp.sp.imem : (uint8_t*) Bus::rcp.sp.dmem;
     uint8_t* dram = (uint8_t*) Bus::rdram.mem;
 
-    for (uint32_t j = 0; j < count; j++) {
-        for (uint32_t i = 0; i < length; i++) {
-            spmem[BES(memaddr)] = dram[BES(dramaddr)];
-            memaddr++;
-            dramaddr++;
-        }
-        dramaddr += skip;
+    delayDMA(bus, length, count);
+
+    dmaCopyRows(spmem, memaddr, 0, dram, dramaddr, skip, length, count);
+}
+
+void RSPInterface::delayDMA(Bus* bus, uint32_t length, uint32_t count)
+{
+    if (!DMATiming::enabled())
+    {
+        return;
     }
+
+    bus->cpu->getCP0().updateCount(Bus::state.PC, bus->rom->getCountPerOp());
+
+    // a DMA started while another is running waits for it
+    dma_done = std::max(dma_done, Bus::state.cycles) + DMATiming::spTransfer(length, count);
 }
 
 OPStatus RSPInterface::read(Bus* bus, uint32_t address, uint32_t* data)
 {
+    syncTask(bus);
+
     switch (_iomode)
     {
     case RCP_IO_REG:
@@ -81,6 +93,8 @@ OPStatus RSPInterface::read(Bus* bus, uint32_t address, uint32_t* data)
 
 OPStatus RSPInterface::write(Bus* bus, uint32_t address, uint32_t data, uint32_t mask)
 {
+    syncTask(bus);
+
     switch (_iomode)
     {
     case RCP_IO_REG:
@@ -109,6 +123,20 @@ OPStatus RSPInterface::readReg(Bus* bus, uint32_t address, uint32_t* data)
 
     *data = reg[regnum];
 
+    if (dma_done != 0 && (regnum == SP_STATUS_REG || regnum == SP_DMA_BUSY_REG))
+    {
+        bus->cpu->getCP0().updateCount(Bus::state.PC, bus->rom->getCountPerOp());
+
+        if (Bus::state.cycles < dma_done)
+        {
+            *data |= (regnum == SP_STATUS_REG) ? 0x4 : 0x1;
+        }
+        else
+        {
+            dma_done = 0;
+        }
+    }
+
     if (regnum == SP_SEMAPHORE_REG)
     {
         reg[SP_SEMAPHORE_REG] = 1;
@@ -151,10 +179,10 @@ OPStatus RSPInterface::writeReg(Bus* bus, uint32_t address, uint32_t data, uint3
     switch (regnum)
     {
     case SP_RD_LEN_REG:
-        DMAWrite();
+        DMAWrite(bus);
         break;
     case SP_WR_LEN_REG:
-        DMARead();
+        DMARead(bus);
         break;
     case SP_SEMAPHORE_REG:
         reg[SP_SEMAPHORE_REG] = 0;
@@ -190,7 +218,7 @@ void RSPInterface::prepareRSP(Bus* bus)
         bus->mem->unprotectFramebuffer();
 
         stat[SP_PC_REG] &= 0xFFF;
-        bus->plugins->rsp()->DoRspCycles(0xffffffff);
+        bus->plugins->rsp()->runTask();
         stat[SP_PC_REG] |= save_pc;
 
         bus->cpu->getCP0().updateCount(Bus::state.PC, bus->rom->getCountPerOp());
@@ -215,7 +243,32 @@ void RSPInterface::prepareRSP(Bus* bus)
     else if (dmem[0xFC0 / 4] == 2)
     {
         stat[SP_PC_REG] &= 0xFFF;
-        bus->plugins->rsp()->DoRspCycles(0xFFFFFFFF);
+
+        if (AudioHLE::enabled() && AudioHLE::processTask(bus))
+        {
+            // the break the microcode ends with
+            reg[SP_STATUS_REG] |= 0x203;
+
+            if (reg[SP_STATUS_REG] & 0x40)
+            {
+                Bus::rcp.mi.reg[MI_INTR_REG] |= 0x1;
+            }
+        }
+        // the CPU carries on until it touches the RSP or SP_INT is due
+        else if (bus->plugins->rsp()->threaded())
+        {
+            _task_pc = save_pc;
+            bus->plugins->rsp()->startTask();
+
+            bus->cpu->getCP0().updateCount(Bus::state.PC, bus->rom->getCountPerOp());
+            bus->interrupt->addInterruptEvent(SP_INT, 4000/*500*/);
+            return;
+        }
+        else
+        {
+            bus->plugins->rsp()->runTask();
+        }
+
         stat[SP_PC_REG] |= save_pc;
 
         bus->cpu->getCP0().updateCount(Bus::state.PC, bus->rom->getCountPerOp());
@@ -233,7 +286,7 @@ void RSPInterface::prepareRSP(Bus* bus)
     else
     {
         stat[SP_PC_REG] &= 0xFFF;
-        bus->plugins->rsp()->DoRspCycles(0xFFFFFFFF);
+        bus->plugins->rsp()->runTask();
         stat[SP_PC_REG] |= save_pc;
 
         bus->cpu->getCP0().updateCount(Bus::state.PC, bus->rom->getCountPerOp());
@@ -246,6 +299,33 @@ void RSPInterface::prepareRSP(Bus* bus)
         Bus::rcp.mi.reg[MI_INTR_REG] &= ~0x1;
         reg[SP_STATUS_REG] &= ~0x203;
     }
+
+    // the plugins ran on this thread
+    bus->cpu->invalidateHostRounding();
+}
+
+bool RSPInterface::syncTask(Bus* bus)
+{
+    if (!bus->plugins->rsp()->taskRunning())
+    {
+        return false;
+    }
+
+    // a deferred audio list runs on this thread
+    bus->plugins->rsp()->finishTask();
+    bus->cpu->invalidateHostRounding();
+    stat[SP_PC_REG] |= _task_pc;
+
+    // SP_INT was scheduled when the task started in case it raises it
+    if (!(Bus::rcp.mi.reg[MI_INTR_REG] & 0x1))
+    {
+        bus->interrupt->deleteEvent(SP_INT);
+    }
+
+    Bus::rcp.mi.reg[MI_INTR_REG] &= ~0x1;
+    reg[SP_STATUS_REG] &= ~0x303;
+
+    return true;
 }
 
 void RSPInterface::updateReg(Bus* bus, uint32_t w)
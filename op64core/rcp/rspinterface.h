@@ -13,6 +13,10 @@ public:
 
     void prepareRSP(Bus* bus);
 
+    // waits for a task on the RSP thread and finishes it like prepareRSP
+    // would have, true if one was running
+    bool syncTask(Bus* bus);
+
 private:
     OPStatus readMem(Bus* bus, uint32_t address, uint32_t* data);
     OPStatus readReg(Bus* bus, uint32_t address, uint32_t* data);
@@ -24,8 +28,11 @@ private:
 
     void updateReg(Bus* bus, uint32_t w);
 
-    void DMARead();
-    void DMAWrite();
+    void DMARead(Bus* bus);
+    void DMAWrite(Bus* bus);
+
+    // keeps the DMA busy bits set for as long as the transfer would take
+    void delayDMA(Bus* bus, uint32_t length, uint32_t count);
 
 public:
     uint32_t mem[SP_MEM_SIZE / 4];    // allocate exactly 2048 * (4 byte uint32) = 8192 bytes (8KB) of SP MEM
@@ -33,4 +40,11 @@ public:
     uint32_t* const imem = dmem + ((SP_MEM_SIZE / 2) / 4);     // IMEM is 4KB (0x400 = 1024 4 byte ints) into the memory
     
     uint32_t stat[SP2_NUM_REGS];
+
+    // cycle the last timed DMA finishes at, 0 when none is in flight
+    uint64_t dma_done = 0;
+
+private:
+    // upper bits of SP_PC while a task is on the RSP thread
+    int32_t _task_pc = 0;
 };
@@ -5,6 +5,7 @@
 
 #include <globalstrings.h>
 #include <rcp/rcp.h>
+#include <rcp/dmatiming.h>
 #include <core/bus.h>
 #include <cpu/icpu.h>
 #include <cpu/cp0.h>
@@ -24,15 +25,21 @@ void SerialInterface::DMARead(Bus* bus)
     }
 
     bus->pif->pifRead(bus);
+    bus->cpu->invalidateHostRounding();
 
     for (uint32_t i = 0; i < PIF_RAM_SIZE; i += 4)
     {
         Bus::rdram.mem[(Bus::rcp.si.reg[SI_DRAM_ADDR_REG] + i) / 4] = byteswap_u32(*(uint32_t*)&bus->pif->ram[i]);
     }
 
+    bus->cpu->invalidateCode(Bus::rcp.si.reg[SI_DRAM_ADDR_REG], PIF_RAM_SIZE);
+
     bus->cpu->getCP0().updateCount(Bus::state.PC, bus->rom->getCountPerOp());
 
-    if (ConfigStore::getInstance().getBool(CFG_SECTION_CORE, CFG_DELAY_SI)) {
+    if (DMATiming::enabled()) {
+        bus->interrupt->addInterruptEvent(SI_INT, DMATiming::siTransfer());
+    }
+    else if (ConfigStore::getInstance().getBool(CFG_SECTION_CORE, CFG_DELAY_SI)) {
         bus->interrupt->addInterruptEvent(SI_INT, /*0x100*/0x900);
     }
     else {
@@ -56,9 +63,13 @@ void SerialInterface::DMAWrite(Bus* bus)
     }
 
     bus->pif->pifWrite(bus);
+    bus->cpu->invalidateHostRounding();
     bus->cpu->getCP0().updateCount(Bus::state.PC, bus->rom->getCountPerOp());
 
-    if (ConfigStore::getInstance().getBool(CFG_SECTION_CORE, CFG_DELAY_SI)) {
+    if (DMATiming::enabled()) {
+        bus->interrupt->addInterruptEvent(SI_INT, DMATiming::siTransfer());
+    }
+    else if (ConfigStore::getInstance().getBool(CFG_SECTION_CORE, CFG_DELAY_SI)) {
         bus->interrupt->addInterruptEvent(SI_INT, /*0x100*/0x900);
     }
     else {
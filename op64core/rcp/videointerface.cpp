@@ -18,7 +18,7 @@ OPStatus VideoInterface::read(Bus* bus, uint32_t address, uint32_t* data)
     if (regnum == VI_CURRENT_REG)
     {
         bus->cpu->getCP0().updateCount(Bus::state.PC, bus->rom->getCountPerOp());
-        reg[VI_CURRENT_REG] = (Bus::state.vi_delay - (Bus::state.next_vi - Bus::state.cp0_reg[CP0_COUNT_REG])) / CoreControl::VIRefreshRate;
+        reg[VI_CURRENT_REG] = (Bus::state.vi_delay - (uint32_t)(Bus::state.next_vi - Bus::state.cycles)) / CoreControl::VIRefreshRate;
         reg[VI_CURRENT_REG] = (reg[VI_CURRENT_REG] & (~1)) | Bus::state.vi_field;
 
     }
@@ -41,6 +41,7 @@ OPStatus VideoInterface::write(Bus* bus, uint32_t address, uint32_t data, uint32
             if (bus->plugins->gfx()->ViStatusChanged != nullptr)
             {
                 bus->plugins->gfx()->ViStatusChanged();
+                bus->cpu->invalidateHostRounding();
             }
         }
         return OP_OK;
@@ -52,6 +53,7 @@ OPStatus VideoInterface::write(Bus* bus, uint32_t address, uint32_t data, uint32
             if (bus->plugins->gfx()->ViWidthChanged != nullptr)
             {
                 bus->plugins->gfx()->ViWidthChanged();
+                bus->cpu->invalidateHostRounding();
             }
         }
         return OP_OK;
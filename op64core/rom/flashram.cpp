@@ -4,6 +4,7 @@
 
 #include <globalstrings.h>
 #include <core/bus.h>
+#include <core/savestate.h>
 #include <ui/configstore.h>
 #include <ui/corecontrol.h>
 #include <rom/rom.h>
@@ -34,7 +35,7 @@ void FlashRam::loadFlashRam(Bus* bus)
     if (!exists(flashpath))
     {
         _flashramfile.open(flashpath, std::ios::out);
-        _flashramfile.seekp(0x1ffff);
+        _flashramfile.seekp(FLASHRAM_SIZE - 1);
         _flashramfile.put(0xffu);
         _flashramfile.close();
     }
@@ -193,3 +194,57 @@ OPStatus FlashRam::read(Bus* bus, uint32_t address, uint32_t* data)
 
     return OP_OK;
 }
+
+void FlashRam::saveState(StateWriter& writer)
+{
+    // the write pointer always points into RDRAM, store it as an offset
+    uint8_t* rdram = (uint8_t*)Bus::rdram.mem;
+    uint32_t writeoffset = (_writepointer >= rdram && _writepointer < rdram + RDRAM_SIZE) ?
+        (uint32_t)(_writepointer - rdram) : UINT32_MAX;
+
+    writer.put((uint32_t)_mode);
+    writer.put(_status);
+    writer.put(_offset);
+    writer.put(writeoffset);
+
+    bool loaded = _flashramfile.is_open();
+
+    writer.put(loaded);
+
+    if (loaded)
+    {
+        std::vector<uint8_t> data(FLASHRAM_SIZE, 0);
+
+        _flashramfile.clear();
+        _flashramfile.seekg(0, std::ios::beg);
+        _flashramfile.read((char*)data.data(), FLASHRAM_SIZE);
+        writer.putBytes(data.data(), FLASHRAM_SIZE);
+    }
+}
+
+void FlashRam::loadState(Bus* bus, StateReader& reader)
+{
+    uint32_t mode = reader.get<uint32_t>();
+    _mode = (mode <= STATUS_MODE) ? (FlashRamMode)mode : NOPES_MODE;
+    reader.get(_status);
+    reader.get(_offset);
+
+    uint32_t writeoffset = reader.get<uint32_t>();
+    _writepointer = (writeoffset < RDRAM_SIZE) ? (uint8_t*)Bus::rdram.mem + writeoffset : nullptr;
+
+    if (!reader.get<bool>())
+        return;
+
+    std::vector<uint8_t> data(FLASHRAM_SIZE);
+    reader.getBytes(data.data(), FLASHRAM_SIZE);
+
+    if (!_flashramfile.is_open())
+    {
+        loadFlashRam(bus);
+    }
+
+    _flashramfile.clear();
+    _flashramfile.seekp(0, std::ios::beg);
+    _flashramfile.write((char*)data.data(), FLASHRAM_SIZE);
+    _flashramfile.flush();
+}
@@ -6,6 +6,11 @@
 
 #include <rcp/rcpinterface.h>
 
+#define FLASHRAM_SIZE 0x20000
+
+class StateReader;
+class StateWriter;
+
 class FlashRam : public RCPInterface
 {
     enum FlashRamMode
@@ -24,6 +29,10 @@ public:
     void dmaToFlash(Bus* bus, uint8_t* src, int32_t offset, int32_t len);
     void dmaFromFlash(Bus* bus, uint8_t* dest, int32_t offset, int32_t len);
 
+    // contents come from the .fla file, a loaded state rewrites it
+    void saveState(StateWriter& writer);
+    void loadState(Bus* bus, StateReader& reader);
+
     // Interface
     virtual OPStatus read(Bus* bus, uint32_t address, uint32_t* data) override;
     virtual OPStatus write(Bus* bus, uint32_t address, uint32_t data, uint32_t mask) override;
@@ -1,13 +1,22 @@
+#include <algorithm>
+#include <chrono>
 #include <cstdlib>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include <immintrin.h>
 
-#include <boost/filesystem/fstream.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/interprocess/file_mapping.hpp>
 
 #include <oplog.h>
 #include <oputil.h>
 #include <md5.h>
 
 #include "rom.h"
+#include "romarchive.h"
 
 #include <ui/romdb.h>
 #include <core/bus.h>
@@ -15,6 +24,10 @@
 
 using namespace boost::filesystem;
 
+// pieces archives are decompressed in, and the window the hash is swapped through
+#define ROM_EXTRACT_CHUNK 0x40000
+#define ROM_HASH_CHUNK 0x10000
+
 static const char* systemTypeString[SYSTEM_NUM_TYPES] =
 {
     "NTSC",
@@ -72,13 +85,178 @@ static uint32_t rom_system_type_to_ai_dac_rate(SystemType system_type)
     }
 }
 
+#ifdef _MSC_VER
+#define TARGET_SSSE3
+#define TARGET_AVX2
+#else
+#define TARGET_SSSE3 __attribute__((target("ssse3")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+enum SwapOrder
+{
+    SWAP_WORDS,     // reverse the bytes of each word
+    SWAP_HALVES     // exchange the halfwords of each word
+};
+
+static const uint8_t swapMask[2][32] =
+{
+    { 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 },
+    { 2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13, 2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13 }
+};
+
+// the vector kernels return how many bytes they converted
+static size_t swapSSE2(const uint8_t* src, uint8_t* dst, size_t size, SwapOrder order)
+{
+    size_t i = 0;
+
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        v = _mm_shufflelo_epi16(_mm_shufflehi_epi16(v, 0xB1), 0xB1);
+
+        if (order == SWAP_WORDS)
+        {
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        }
+
+        _mm_storeu_si128((__m128i*)(dst + i), v);
+    }
+
+    return i;
+}
+
+TARGET_SSSE3 static size_t swapSSSE3(const uint8_t* src, uint8_t* dst, size_t size, SwapOrder order)
+{
+    const __m128i mask = _mm_loadu_si128((const __m128i*)swapMask[order]);
+    size_t i = 0;
+
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_shuffle_epi8(v, mask));
+    }
+
+    return i;
+}
+
+TARGET_AVX2 static size_t swapAVX2(const uint8_t* src, uint8_t* dst, size_t size, SwapOrder order)
+{
+    const __m256i mask = _mm256_loadu_si256((const __m256i*)swapMask[order]);
+    size_t i = 0;
+
+    for (; i + 32 <= size; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(src + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_shuffle_epi8(v, mask));
+    }
+
+    return i;
+}
+
+typedef size_t(*SwapKernel)(const uint8_t* src, uint8_t* dst, size_t size, SwapOrder order);
+
+static SwapKernel selectSwapKernel(void)
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    int ids = info[0];
+
+    __cpuid(info, 1);
+    bool ssse3 = (info[2] & (1 << 9)) != 0;
+    bool avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 6) == 6);
+
+    bool avx2 = false;
+
+    if (avx && ids >= 7)
+    {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    bool ssse3 = __builtin_cpu_supports("ssse3");
+    bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+
+    if (avx2)
+    {
+        return swapAVX2;
+    }
+    else if (ssse3)
+    {
+        return swapSSSE3;
+    }
+
+    return swapSSE2;
+}
+
+static const SwapKernel swapKernel = selectSwapKernel();
+
+static void swapImage(const uint8_t* src, uint8_t* dst, size_t size, SwapOrder order)
+{
+    size_t i = swapKernel(src, dst, size, order);
+
+    for (; i + 4 <= size; i += 4)
+    {
+        uint32_t word;
+        memcpy(&word, src + i, 4);
+        word = (order == SWAP_WORDS) ? byteswap_u32(word) : ((word << 16) | (word >> 16));
+        memcpy(dst + i, &word, 4);
+    }
+
+    // in place the tail is already where it belongs
+    if (src != dst)
+    {
+        memcpy(dst + i, src + i, size - i);
+    }
+}
+
+// the database is keyed on the big endian image, swapped back in pieces
+static void md5Update(MD5& md, const uint8_t* image, size_t size, std::vector<uint8_t>& chunk)
+{
+    for (size_t offset = 0; offset < size; offset += chunk.size())
+    {
+        size_t length = std::min(chunk.size(), size - offset);
+        swapImage(image + offset, chunk.data(), length, SWAP_WORDS);
+        md.update(chunk.data(), (MD5::size_type)length);
+    }
+}
+
+static std::string md5Image(const uint8_t* image, size_t size)
+{
+    std::vector<uint8_t> chunk(ROM_HASH_CHUNK);
+    MD5 md = MD5();
+
+    md5Update(md, image, size, chunk);
+
+    md.finalize();
+    return boost::to_upper_copy(md.hexdigest());
+}
+
+static ImageType imageType(const uint8_t* image)
+{
+    switch (image[0])
+    {
+    case 0x37:
+        return V64IMAGE;
+    case 0x40:
+        return N64IMAGE;
+    default:
+        return Z64IMAGE;
+    }
+}
+
 Rom::~Rom(void)
 {
-    if (nullptr != _image)
+    if (nullptr != _buffer)
     {
-        delete[] _image;
-        _image = nullptr;
+        delete[] _buffer;
+        _buffer = nullptr;
     }
+
+    _image = nullptr;
 }
 
 bool Rom::isValidRom(const uint8_t* image)
@@ -108,151 +286,239 @@ bool Rom::isValidRom(const uint8_t* image)
     return false;
 }
 
-void Rom::swapRom(uint8_t* rom, uint_fast32_t size)
+// The core reads the ROM as host order words. On a little endian host
+// that is the .n64 layout, those files are used straight from the page
+// cache and shared by every process running them. The other layouts
+// are converted once into a private buffer.
+bool Rom::mapImage(void)
 {
-    switch (rom[0])
+    using namespace boost::interprocess;
+
+    try
     {
-        // .v64
-    case 0x37:
-        _imagetype = V64IMAGE;
-        for(uint32_t i = 0; i < size; i += 2)
-        {
-            std::swap(rom[i], rom[i + 1]);
-        }
+        file_mapping file(_filename.string().c_str(), read_only);
+        mapped_region(file, read_only).swap(_region);
+    }
+    catch (const interprocess_exception& e)
+    {
+        LOG_ERROR(ROM) << "Could not map " << _filename.string() << ": " << e.what();
+        return false;
+    }
+
+    const uint8_t* file = (const uint8_t*)_region.get_address();
+    size_t size = _region.get_size();
+
+    if (RomArchive::detect(file, size) != ARCHIVE_NONE)
+    {
+        bool extracted = extractImage(file, size);
+        mapped_region().swap(_region);
+        return extracted;
+    }
+
+    if (size < 4096 || size > UINT32_MAX)
+    {
+        LOG_ERROR(ROM) << "Bad ROM size: " << size;
+        return false;
+    }
+
+    _imagesize = static_cast<uint32_t>(size);
+
+    if (!isValidRom(file))
+    {
+        LOG_ERROR(ROM) << "Invalid N64 ROM";
+        return false;
+    }
+
+    _imagetype = imageType(file);
+
+    switch (_imagetype)
+    {
+    case V64IMAGE:
+        _buffer = new uint8_t[_imagesize];
+        swapImage(file, _buffer, _imagesize, SWAP_HALVES);
+        _image = _buffer;
+        _md5 = md5Image(_image, _imagesize);
+        mapped_region().swap(_region);
         break;
-        // .n64
-    case 0x40:
-        _imagetype = N64IMAGE;
-        for(uint32_t i = 0; i < size; i += 4)
-        {
-            std::swap(rom[i], rom[i + 3]);
-            std::swap(rom[i + 1], rom[i + 2]);
-        }
+    case N64IMAGE:
+        _image = (uint8_t*)file;
+        _md5 = md5Image(_image, _imagesize);
         break;
     default:
-        _imagetype = Z64IMAGE;
+    {
+        _buffer = new uint8_t[_imagesize];
+        swapImage(file, _buffer, _imagesize, SWAP_WORDS);
+        _image = _buffer;
+
+        MD5 md = MD5();
+        md.update(file, _imagesize);
+        md.finalize();
+        _md5 = boost::to_upper_copy(md.hexdigest());
+
+        mapped_region().swap(_region);
         break;
     }
-}
+    }
 
+    return true;
+}
 
-bool Rom::loadRom(const char* name, Rom*& outRom)
+// Archives are decompressed straight into the image buffer, each piece
+// is hashed and put in host order while it is still in cache
+bool Rom::extractImage(const uint8_t* data, size_t size)
 {
-    Rom* rom = new Rom();
+    RomArchive archive;
 
-    if (nullptr != rom->_image)
+    if (!archive.open(data, size))
     {
-        // Sanity
-        LOG_ERROR(ROM) << "Unrecoverable error";
-        delete rom;
         return false;
     }
 
-    rom->_filename = boost::filesystem::path(name);
-    if (!exists(rom->_filename) || !is_regular_file(rom->_filename))
+    if (archive.size() < 4096 || archive.size() > UINT32_MAX)
     {
-        // file doesn't exist or is bad
-        LOG_ERROR(ROM) << "File " << name << " not found or is an invalid file";
-        delete rom;
+        LOG_ERROR(ROM) << "Bad ROM size: " << archive.size();
         return false;
     }
 
-    ifstream file(rom->_filename, std::ios::in | std::ios::binary | std::ios::ate);
-    if (file.is_open() && file.good())
-    {
-        LOG_INFO(ROM) << "Loading " << name;
+    _imagesize = static_cast<uint32_t>(archive.size());
+    _buffer = new uint8_t[_imagesize];
+    _image = _buffer;
+
+    std::vector<uint8_t> chunk(ROM_HASH_CHUNK);
+    MD5 md = MD5();
+    size_t extracted = 0;
+    size_t converted = 0;
 
-        std::streampos size = file.tellg();
+    while (extracted < _imagesize)
+    {
+        size_t length = archive.read(_buffer + extracted, std::min<size_t>(ROM_EXTRACT_CHUNK, _imagesize - extracted));
 
-        if (size < 4096)
+        if (length == 0)
         {
-            LOG_ERROR(ROM) << "Bad ROM size: " << size;
-            delete rom;
             return false;
         }
 
-        uint8_t* image = new uint8_t[static_cast<unsigned int>(size)];
-        if (nullptr == image)
+        if (extracted < 4 && extracted + length >= 4)
         {
-            LOG_ERROR(ROM) << "Error allocating " << size << " bytes for ROM!";
-            delete rom;
-            return false;
+            if (!isValidRom(_buffer))
+            {
+                LOG_ERROR(ROM) << "Invalid N64 ROM";
+                return false;
+            }
+
+            _imagetype = imageType(_buffer);
         }
 
-        file.seekg(0, std::ios::beg);
-        file.read((char*)image, size);
-        file.close();
+        extracted += length;
 
-        if (!isValidRom(image))
+        // whole words only, the rest waits for the next piece
+        size_t end = (extracted == _imagesize) ? extracted : (extracted & ~(size_t)3);
+        uint8_t* piece = _buffer + converted;
+        size_t count = end - converted;
+
+        switch (_imagetype)
         {
-            LOG_ERROR(ROM) << "Invalid N64 ROM";
-            delete[] image;
-            delete rom;
-            return false;
+        case V64IMAGE:
+            swapImage(piece, piece, count, SWAP_HALVES);
+            md5Update(md, piece, count, chunk);
+            break;
+        case N64IMAGE:
+            md5Update(md, piece, count, chunk);
+            break;
+        default:
+            md.update(piece, (MD5::size_type)count);
+            swapImage(piece, piece, count, SWAP_WORDS);
+            break;
         }
 
-        rom->_image = image; image = nullptr;
-        rom->_imagesize = static_cast<unsigned int>(size);
+        converted = end;
+    }
 
-        rom->swapRom(rom->_image, rom->_imagesize);
+    if (!archive.done())
+    {
+        return false;
+    }
 
-        memcpy(&rom->_header, rom->_image, sizeof(rom_header));
+    md.finalize();
+    _md5 = boost::to_upper_copy(md.hexdigest());
 
-        // Calculate md5 for rom db search
-        MD5 md = MD5();
-        md.update(rom->_image, rom->_imagesize);
-        md.finalize();
-        rom->_md5 = boost::to_upper_copy(md.hexdigest());
+    return true;
+}
 
-        rom->_systemtype = rom_country_code_to_system_type(rom->_header.Country_code);
-        rom->_vilimit = (rom->_systemtype == SYSTEM_NTSC) ? 60 : 50;
-        rom->_aidacrate = rom_system_type_to_ai_dac_rate(rom->_systemtype);
+bool Rom::loadRom(const char* name, Rom*& outRom)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    Rom* rom = new Rom();
 
-        RomSettings settings;
-        if (RomDB::getInstance().get(rom->_md5, settings))
-        {
-            rom->_count_per_op = settings.countperop;
-            rom->_savetype = settings.savetype;
-            rom->_goodname = settings.goodname;
-            rom->_romhacks = settings.romhacks;
-        }
+    if (nullptr != rom->_image)
+    {
+        // Sanity
+        LOG_ERROR(ROM) << "Unrecoverable error";
+        delete rom;
+        return false;
+    }
 
-        LOG_TRACE(ROM) << "GoodName: " << rom->_goodname;
-        LOG_TRACE(ROM) << "Name: " << rom->_header.Name;
-        LOG_TRACE(ROM) << "CRC: " << std::hex << rom->_header.CRC1 << " " << std::hex << rom->_header.CRC2;
-        LOG_TRACE(ROM) << "System Type: " << systemTypeString[rom->_systemtype];
-        LOG_TRACE(ROM) << "Save Type: " << saveTypeString[rom->_savetype];
-        LOG_TRACE(ROM) << "Rom Size: " << rom->_imagesize / 1024 / 1024 * 8 << " Megabits";
-        LOG_TRACE(ROM) << "ClockRate: " << std::hex << byteswap_u32(rom->_header.ClockRate);
-        LOG_TRACE(ROM) << "Release Code: " << std::hex << byteswap_u32(rom->_header.Release);
-        LOG_TRACE(ROM) << "Manufacturer ID: " << std::hex << byteswap_u32(rom->_header.Manufacturer_ID);
-        LOG_TRACE(ROM) << "Cartridge ID: " << std::hex << rom->_header.Cartridge_ID;
-        LOG_TRACE(ROM) << "Country Code: " << std::hex << rom->_header.Country_code;
-        LOG_TRACE(ROM) << "PC: 0x" << std::hex << byteswap_u32(rom->_header.PC);
-
-        LOG_DEBUG(ROM) << rom->_romhacks.size() << " ROM hacks enabled";
-
-        rom->setGameHacks(rom->_header.Cartridge_ID);
-
-        // Swap it again because little endian cpu
-        uint32_t* roml = (uint32_t*)rom->_image;
-        for(uint32_t i = 0; i < (rom->_imagesize / 4); i++)
-        {
-            roml[i] = byteswap_u32(roml[i]);
-        }
+    boost::system::error_code ec;
 
-        rom->calculateCIC();
+    rom->_filename = boost::filesystem::path(name);
+    if (!exists(rom->_filename, ec) || !is_regular_file(rom->_filename, ec))
+    {
+        // file doesn't exist or is bad
+        LOG_ERROR(ROM) << "File " << name << " not found or is an invalid file";
+        delete rom;
+        return false;
+    }
 
-        outRom = rom; rom = nullptr;
-        LOG_INFO(ROM) << "ROM loaded";
+    LOG_INFO(ROM) << "Loading " << name;
 
-        return true;
+    if (!rom->mapImage())
+    {
+        delete rom;
+        return false;
     }
 
-    delete rom;
-    LOG_ERROR(ROM) << "ROM: bad ROM file";
+    // the header is read in big endian order
+    swapImage(rom->_image, (uint8_t*)&rom->_header, sizeof(rom_header), SWAP_WORDS);
 
-    return false;
+    rom->_systemtype = rom_country_code_to_system_type(rom->_header.Country_code);
+    rom->_vilimit = (rom->_systemtype == SYSTEM_NTSC) ? 60 : 50;
+    rom->_aidacrate = rom_system_type_to_ai_dac_rate(rom->_systemtype);
+
+    RomSettings settings;
+    if (RomDB::getInstance().get(rom->_md5, settings))
+    {
+        rom->_count_per_op = settings.countperop;
+        rom->_idle_skip = settings.idleskip;
+        rom->_savetype = settings.savetype;
+        rom->_goodname = settings.goodname;
+        rom->_romhacks = settings.romhacks;
+    }
+
+    LOG_TRACE(ROM) << "GoodName: " << rom->_goodname;
+    LOG_TRACE(ROM) << "Name: " << rom->_header.Name;
+    LOG_TRACE(ROM) << "CRC: " << std::hex << rom->_header.CRC1 << " " << std::hex << rom->_header.CRC2;
+    LOG_TRACE(ROM) << "System Type: " << systemTypeString[rom->_systemtype];
+    LOG_TRACE(ROM) << "Save Type: " << saveTypeString[rom->_savetype];
+    LOG_TRACE(ROM) << "Rom Size: " << rom->_imagesize / 1024 / 1024 * 8 << " Megabits";
+    LOG_TRACE(ROM) << "ClockRate: " << std::hex << byteswap_u32(rom->_header.ClockRate);
+    LOG_TRACE(ROM) << "Release Code: " << std::hex << byteswap_u32(rom->_header.Release);
+    LOG_TRACE(ROM) << "Manufacturer ID: " << std::hex << byteswap_u32(rom->_header.Manufacturer_ID);
+    LOG_TRACE(ROM) << "Cartridge ID: " << std::hex << rom->_header.Cartridge_ID;
+    LOG_TRACE(ROM) << "Country Code: " << std::hex << rom->_header.Country_code;
+    LOG_TRACE(ROM) << "PC: 0x" << std::hex << byteswap_u32(rom->_header.PC);
+
+    LOG_DEBUG(ROM) << rom->_romhacks.size() << " ROM hacks enabled";
+
+    rom->setGameHacks(rom->_header.Cartridge_ID);
+
+    rom->calculateCIC();
+
+    outRom = rom; rom = nullptr;
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    LOG_INFO(ROM) << "ROM loaded in " << elapsed.count() << " ms";
+
+    return true;
 }
 
 void Rom::calculateCIC(void)
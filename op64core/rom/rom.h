@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <boost/filesystem.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 
 #include <cheat/cheat.h>
 #include <rcp/rcpinterface.h>
@@ -132,6 +133,11 @@ public:
         return _count_per_op;
     }
 
+    inline bool getIdleSkip(void)
+    {
+        return _idle_skip;
+    }
+
     inline uint32_t getCICChip(void)
     {
         return _cicchip;
@@ -165,12 +171,16 @@ public:
 private:
     Rom(void) = default;
     static bool isValidRom(const uint8_t* image);
-    void swapRom(uint8_t* rom, uint_fast32_t size);
+    bool mapImage(void);
+    bool extractImage(const uint8_t* data, size_t size);
     void calculateCIC(void);
     void setGameHacks(uint16_t cartid);
 
 private:
+    // points into _region when the file is already in host order, _buffer otherwise
     uint8_t* _image = nullptr;
+    uint8_t* _buffer = nullptr;
+    boost::interprocess::mapped_region _region;
     uint_fast32_t _imagesize = 0;
     uint_fast8_t _imagetype = 0;
     uint_fast8_t _savetype = SAVETYPE_AUTO;
@@ -179,6 +189,7 @@ private:
     uint32_t _vilimit = 0;
     uint32_t _aidacrate = 0;
     uint8_t _count_per_op = COUNT_PER_OP_DEFAULT;
+    bool _idle_skip = true;
     uint32_t _gamehacks = GAME_HACK_NONE;
 
     std::string _md5;
@@ -0,0 +1,380 @@
+#include <algorithm>
+#include <cstring>
+
+#ifdef OP64_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef OP64_ZSTD
+#include <zstd.h>
+#endif
+
+#include <oplog.h>
+
+#include "romarchive.h"
+
+#define ZIP_LOCAL_SIGNATURE 0x04034b50
+#define ZIP_CENTRAL_SIGNATURE 0x02014b50
+#define ZIP_END_SIGNATURE 0x06054b50
+#define ZIP_END_SIZE 22
+#define ZIP_STORED 0
+#define ZIP_DEFLATED 8
+
+#define ZSTD_FRAME_MAGIC 0xFD2FB528
+
+// smaller members of an archive are taken to be readmes and the like
+#define ARCHIVE_MIN_ROM_SIZE 4096
+
+
+struct RomArchive::Stream
+{
+#ifdef OP64_ZLIB
+    z_stream zip;
+    bool zip_open = false;
+#endif
+#ifdef OP64_ZSTD
+    ZSTD_DStream* zstd = nullptr;
+    ZSTD_inBuffer zstd_in;
+#endif
+};
+
+// archives are little endian
+static inline uint32_t read32(const uint8_t* p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint16_t read16(const uint8_t* p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+RomArchive::RomArchive(void) :
+    _stream(new Stream())
+{
+}
+
+RomArchive::~RomArchive(void)
+{
+#ifdef OP64_ZLIB
+    if (_stream->zip_open)
+    {
+        inflateEnd(&_stream->zip);
+    }
+#endif
+#ifdef OP64_ZSTD
+    if (_stream->zstd != nullptr)
+    {
+        ZSTD_freeDStream(_stream->zstd);
+    }
+#endif
+}
+
+ArchiveType RomArchive::detect(const uint8_t* data, size_t size)
+{
+    if (size < 4)
+    {
+        return ARCHIVE_NONE;
+    }
+
+    switch (read32(data))
+    {
+    case ZIP_LOCAL_SIGNATURE:
+        return ARCHIVE_ZIP;
+    case ZSTD_FRAME_MAGIC:
+        return ARCHIVE_ZSTD;
+    default:
+        return ARCHIVE_NONE;
+    }
+}
+
+bool RomArchive::open(const uint8_t* data, size_t size)
+{
+    _type = detect(data, size);
+    _input = data;
+
+    switch (_type)
+    {
+    case ARCHIVE_ZIP:
+        return openZip(data, size);
+    case ARCHIVE_ZSTD:
+        return openZstd(data, size);
+    default:
+        LOG_ERROR(ROM) << "Unknown archive type";
+        return false;
+    }
+}
+
+bool RomArchive::openZip(const uint8_t* data, size_t size)
+{
+#ifdef OP64_ZLIB
+    // the central directory has the sizes even when the local headers do not
+    const uint8_t* end = nullptr;
+
+    if (size >= ZIP_END_SIZE)
+    {
+        size_t limit = (size > ZIP_END_SIZE + 0xFFFF) ? size - ZIP_END_SIZE - 0xFFFF : 0;
+
+        for (size_t pos = size - ZIP_END_SIZE + 1; pos-- > limit;)
+        {
+            if (read32(data + pos) == ZIP_END_SIGNATURE)
+            {
+                end = data + pos;
+                break;
+            }
+        }
+    }
+
+    if (nullptr == end)
+    {
+        LOG_ERROR(ROM) << "Zip archive has no central directory";
+        return false;
+    }
+
+    uint16_t entries = read16(end + 10);
+    uint32_t directory_size = read32(end + 12);
+    uint32_t directory_offset = read32(end + 16);
+
+    if ((uint64_t)directory_offset + directory_size > size)
+    {
+        LOG_ERROR(ROM) << "Zip archive is truncated";
+        return false;
+    }
+
+    const uint8_t* entry = data + directory_offset;
+    const uint8_t* directory_end = entry + directory_size;
+
+    for (uint16_t i = 0; i < entries && entry + 46 <= directory_end; i++)
+    {
+        if (read32(entry) != ZIP_CENTRAL_SIGNATURE)
+        {
+            break;
+        }
+
+        uint16_t flags = read16(entry + 8);
+        uint16_t method = read16(entry + 10);
+        uint32_t crc = read32(entry + 16);
+        uint32_t compressed = read32(entry + 20);
+        uint32_t uncompressed = read32(entry + 24);
+        uint16_t name_length = read16(entry + 28);
+        uint32_t local_offset = read32(entry + 42);
+
+        entry += 46 + name_length + read16(entry + 30) + read16(entry + 32);
+
+        if (uncompressed < ARCHIVE_MIN_ROM_SIZE)
+        {
+            continue;
+        }
+
+        if (flags & 1)
+        {
+            LOG_ERROR(ROM) << "Encrypted zip archives are not supported";
+            return false;
+        }
+
+        if (method != ZIP_STORED && method != ZIP_DEFLATED)
+        {
+            LOG_ERROR(ROM) << "Zip compression method " << method << " is not supported";
+            return false;
+        }
+
+        if ((uint64_t)local_offset + 30 > size || read32(data + local_offset) != ZIP_LOCAL_SIGNATURE)
+        {
+            LOG_ERROR(ROM) << "Zip archive is corrupted";
+            return false;
+        }
+
+        uint64_t start = (uint64_t)local_offset + 30 + read16(data + local_offset + 26) + read16(data + local_offset + 28);
+
+        if (start + compressed > size)
+        {
+            LOG_ERROR(ROM) << "Zip archive is truncated";
+            return false;
+        }
+
+        if (method == ZIP_STORED && compressed != uncompressed)
+        {
+            LOG_ERROR(ROM) << "Zip archive is corrupted";
+            return false;
+        }
+
+        _input = data + start;
+        _size = uncompressed;
+        _expected_crc = crc;
+        _method = method;
+        _crc = (uint32_t)crc32(0L, Z_NULL, 0);
+
+        if (method == ZIP_DEFLATED)
+        {
+            z_stream& zip = _stream->zip;
+            memset(&zip, 0, sizeof(zip));
+
+            // raw deflate, zip has its own headers
+            if (inflateInit2(&zip, -MAX_WBITS) != Z_OK)
+            {
+                LOG_ERROR(ROM) << "Could not initialize zlib";
+                return false;
+            }
+
+            _stream->zip_open = true;
+            zip.next_in = (Bytef*)_input;
+            zip.avail_in = compressed;
+        }
+
+        return true;
+    }
+
+    LOG_ERROR(ROM) << "Zip archive contains no ROM";
+    return false;
+#else
+    (void)data;
+    (void)size;
+
+    LOG_ERROR(ROM) << "This build does not support zip archives";
+    return false;
+#endif
+}
+
+bool RomArchive::openZstd(const uint8_t* data, size_t size)
+{
+#ifdef OP64_ZSTD
+    unsigned long long content = ZSTD_getFrameContentSize(data, size);
+
+    if (content == ZSTD_CONTENTSIZE_ERROR)
+    {
+        LOG_ERROR(ROM) << "zstd frame is corrupted";
+        return false;
+    }
+
+    // the image is decompressed in place, its size has to be known up front
+    if (content == ZSTD_CONTENTSIZE_UNKNOWN)
+    {
+        LOG_ERROR(ROM) << "zstd frame does not record its size, recompress without streaming";
+        return false;
+    }
+
+    _stream->zstd = ZSTD_createDStream();
+
+    if (nullptr == _stream->zstd || ZSTD_isError(ZSTD_initDStream(_stream->zstd)))
+    {
+        LOG_ERROR(ROM) << "Could not initialize zstd";
+        return false;
+    }
+
+    _stream->zstd_in.src = data;
+    _stream->zstd_in.size = size;
+    _stream->zstd_in.pos = 0;
+    _size = content;
+
+    return true;
+#else
+    (void)data;
+    (void)size;
+
+    LOG_ERROR(ROM) << "This build does not support zstd archives";
+    return false;
+#endif
+}
+
+size_t RomArchive::read(uint8_t* dest, size_t length)
+{
+    if (_error || _finished)
+    {
+        return 0;
+    }
+
+    length = (size_t)std::min<uint64_t>(length, _size - _produced);
+    size_t produced = 0;
+
+#if !defined(OP64_ZLIB) && !defined(OP64_ZSTD)
+    (void)dest;
+#endif
+
+    switch (_type)
+    {
+#ifdef OP64_ZLIB
+    case ARCHIVE_ZIP:
+        if (_method == ZIP_STORED)
+        {
+            memcpy(dest, _input + _produced, length);
+            produced = length;
+        }
+        else
+        {
+            z_stream& zip = _stream->zip;
+            zip.next_out = dest;
+            zip.avail_out = (uInt)length;
+
+            int status = inflate(&zip, Z_NO_FLUSH);
+            produced = length - zip.avail_out;
+
+            if (status != Z_OK && status != Z_STREAM_END)
+            {
+                LOG_ERROR(ROM) << "Zip archive is corrupted: " << ((zip.msg != nullptr) ? zip.msg : "inflate failed");
+                _error = true;
+                return 0;
+            }
+        }
+
+        _crc = (uint32_t)crc32(_crc, dest, (uInt)produced);
+        break;
+#endif
+#ifdef OP64_ZSTD
+    case ARCHIVE_ZSTD:
+    {
+        ZSTD_outBuffer out = { dest, length, 0 };
+
+        while (out.pos < out.size)
+        {
+            size_t before = out.pos;
+            size_t status = ZSTD_decompressStream(_stream->zstd, &out, &_stream->zstd_in);
+
+            if (ZSTD_isError(status))
+            {
+                LOG_ERROR(ROM) << "zstd archive is corrupted: " << ZSTD_getErrorName(status);
+                _error = true;
+                return 0;
+            }
+
+            if (out.pos == before && _stream->zstd_in.pos == _stream->zstd_in.size)
+            {
+                break;
+            }
+        }
+
+        produced = out.pos;
+        break;
+    }
+#endif
+    default:
+        _error = true;
+        return 0;
+    }
+
+    if (produced == 0)
+    {
+        LOG_ERROR(ROM) << "Archive ended " << (_size - _produced) << " bytes early";
+        _error = true;
+        return 0;
+    }
+
+    _produced += produced;
+
+    if (_produced == _size)
+    {
+        _finished = true;
+
+        if (_type == ARCHIVE_ZIP && _crc != _expected_crc)
+        {
+            LOG_ERROR(ROM) << "Zip archive failed its CRC check";
+            _error = true;
+        }
+    }
+
+    return produced;
+}
+
+bool RomArchive::done(void) const
+{
+    return _finished && !_error;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+enum ArchiveType
+{
+    ARCHIVE_NONE,
+    ARCHIVE_ZIP,
+    ARCHIVE_ZSTD
+};
+
+
+/************************************************************************/
+/* Compressed ROM images, decompressed a piece at a time so the caller  */
+/* can work on each piece while it is still in cache                    */
+/************************************************************************/
+class RomArchive
+{
+public:
+    RomArchive(void);
+    ~RomArchive(void);
+
+    static ArchiveType detect(const uint8_t* data, size_t size);
+
+    // finds the ROM in the archive, data has to stay valid until done
+    bool open(const uint8_t* data, size_t size);
+
+    inline uint64_t size(void) const
+    {
+        return _size;
+    }
+
+    // decompresses up to length bytes, returns how many were written
+    // and 0 once the image is complete or on errors
+    size_t read(uint8_t* dest, size_t length);
+
+    // true once the whole image was read and checked
+    bool done(void) const;
+
+private:
+    bool openZip(const uint8_t* data, size_t size);
+    bool openZstd(const uint8_t* data, size_t size);
+
+private:
+    struct Stream;
+
+    ArchiveType _type = ARCHIVE_NONE;
+    const uint8_t* _input = nullptr;
+    uint64_t _size = 0;
+    uint64_t _produced = 0;
+    uint32_t _crc = 0;
+    uint32_t _expected_crc = 0;
+    uint16_t _method = 0;
+    bool _error = false;
+    bool _finished = false;
+
+    std::unique_ptr<Stream> _stream;
+};
@@ -5,6 +5,7 @@
 #include <globalstrings.h>
 #include <ui/configstore.h>
 #include <core/bus.h>
+#include <core/savestate.h>
 #include <rom/rom.h>
 
 void SRAM::loadSRAM(Bus* bus)
@@ -21,7 +22,7 @@ void SRAM::loadSRAM(Bus* bus)
     if (!exists(srampath))
     {
         _sramfile.open(srampath, std::ios::out);
-        _sramfile.seekp(0x7fff);
+        _sramfile.seekp(SRAM_SIZE - 1);
         _sramfile.put('\0');
         _sramfile.close();
     }
@@ -54,6 +55,42 @@ void SRAM::dmaFromSRAM(Bus* bus, uint8_t* dest, int32_t offset, int32_t len)
     _sramfile.read((char*)dest, len);
 }
 
+void SRAM::saveState(StateWriter& writer)
+{
+    bool loaded = _sramfile.is_open();
+
+    writer.put(loaded);
+
+    if (loaded)
+    {
+        uint8_t data[SRAM_SIZE] = { 0 };
+
+        _sramfile.clear();
+        _sramfile.seekg(0, std::ios::beg);
+        _sramfile.read((char*)data, SRAM_SIZE);
+        writer.putBytes(data, SRAM_SIZE);
+    }
+}
+
+void SRAM::loadState(Bus* bus, StateReader& reader)
+{
+    if (!reader.get<bool>())
+        return;
+
+    uint8_t data[SRAM_SIZE];
+    reader.getBytes(data, SRAM_SIZE);
+
+    if (!_sramfile.is_open())
+    {
+        loadSRAM(bus);
+    }
+
+    _sramfile.clear();
+    _sramfile.seekp(0, std::ios::beg);
+    _sramfile.write((char*)data, SRAM_SIZE);
+    _sramfile.flush();
+}
+
 SRAM::~SRAM(void)
 {
     if (_sramfile.is_open())
@@ -3,7 +3,11 @@
 #include <cstdint>
 #include <boost/filesystem/fstream.hpp>
 
+#define SRAM_SIZE 0x8000
+
 class Bus;
+class StateReader;
+class StateWriter;
 
 class SRAM
 {
@@ -14,6 +18,10 @@ public:
     void dmaToSRAM(Bus* bus, uint8_t* src, int32_t offset, int32_t len);
     void dmaFromSRAM(Bus* bus, uint8_t* dest, int32_t offset, int32_t len);
 
+    // contents come from the .sra file, a loaded state rewrites it
+    void saveState(StateWriter& writer);
+    void loadState(Bus* bus, StateReader& reader);
+
 private:
     void loadSRAM(Bus* bus);
 
@@ -34,6 +34,13 @@ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <cpu/icpu.h>
 #include <cpu/cp0.h>
 
+
+#define TLB_LUT_SHIFT 12
+#define TLB_LUT_SIZE (1U << (32 - TLB_LUT_SHIFT))
+
+// beyond this many cached pages the next fill starts over
+#define TLB_LUT_MAX_PAGES 0x4000
+
 alignas(CACHE_LINE_SIZE) static const int8_t one_hot_lut[256] = {
     -1,
 
@@ -74,6 +81,26 @@ alignas(CACHE_LINE_SIZE) static const int8_t one_hot_lut[256] = {
 };
 
 uint32_t TLB::virtual_to_physical_address(Bus* bus, uint32_t address, TLBProbeMode mode)
+{
+    tlb_o& tlb = bus->cpu->getCP0().tlb;
+    uint32_t page = tlb.lut[address >> TLB_LUT_SHIFT];
+
+    if (page)
+    {
+        return page + (address & 0xFFF);
+    }
+
+    uint32_t translated = translate(bus, address, mode);
+
+    if (translated)
+    {
+        cache_page(tlb, address, translated - (address & 0xFFF));
+    }
+
+    return translated;
+}
+
+uint32_t TLB::translate(Bus* bus, uint32_t address, TLBProbeMode mode)
 {
     if (address >= 0x7f000000 && address < 0x80000000 && (bus->rom->getGameHacks() & GAME_HACK_GOLDENEYE))
     {
@@ -116,6 +143,58 @@ uint32_t TLB::virtual_to_physical_address(Bus* bus, uint32_t address, TLBProbeMo
     return (0x80000000 + ((cp0.pfn[index][select]) | (address & page_mask)));
 }
 
+void TLB::cache_page(tlb_o& tlb, uint32_t address, uint32_t translated)
+{
+    if (tlb.lut_pages.size() >= TLB_LUT_MAX_PAGES)
+    {
+        tlb_flush(tlb);
+    }
+
+    tlb.lut[address >> TLB_LUT_SHIFT] = translated;
+    tlb.lut_pages.push_back(address >> TLB_LUT_SHIFT);
+}
+
+void TLB::tlb_flush(tlb_o& tlb)
+{
+    for (uint32_t page : tlb.lut_pages)
+    {
+        tlb.lut[page] = 0;
+    }
+
+    tlb.lut_pages.clear();
+}
+
+void TLB::flush_entry(tlb_o& tlb, unsigned index)
+{
+    if (tlb.vpn2.data[index] == ~0U)
+    {
+        return;
+    }
+
+    // each entry maps an even/odd pair of pages
+    uint32_t mask = ~tlb.page_mask.data[index] & 0x7FFFF;
+    uint32_t first = (tlb.vpn2.data[index] & 0x7FFFF & ~mask) << (13 - TLB_LUT_SHIFT);
+    uint32_t count = (mask + 1) << (13 - TLB_LUT_SHIFT);
+
+    if (count > tlb.lut_pages.size())
+    {
+        for (uint32_t page : tlb.lut_pages)
+        {
+            if (page - first < count)
+            {
+                tlb.lut[page] = 0;
+            }
+        }
+    }
+    else
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            tlb.lut[first + i] = 0;
+        }
+    }
+}
+
 /* Ported cen64 tlb implementation */
 void TLB::tlb_init(tlb_o& tlb)
 {
@@ -123,10 +202,20 @@ void TLB::tlb_init(tlb_o& tlb)
     {
         tlb.vpn2.data[i] = ~0;
     }
+
+    if (!tlb.lut)
+    {
+        tlb.lut.reset(new uint32_t[TLB_LUT_SIZE]);
+    }
+
+    fill_array(tlb.lut.get(), 0, TLB_LUT_SIZE, 0);
+    tlb.lut_pages.clear();
 }
 
 void TLB::tlb_write(tlb_o& tlb, unsigned index, uint64_t entry_hi, uint64_t entry_lo_0, uint64_t entry_lo_1, uint32_t page_mask)
 {
+    flush_entry(tlb, index);
+
     tlb.page_mask.data[index] = ~(page_mask >> 13);
 
     tlb.vpn2.data[index] =
@@ -135,6 +224,8 @@ void TLB::tlb_write(tlb_o& tlb, unsigned index, uint64_t entry_hi, uint64_t entr
 
     tlb.global[index] = (entry_lo_0 & 0x1) && (entry_lo_1 & 0x1) ? 0xFF : 0x00;
     tlb.asid[index] = entry_hi & 0xFF;
+
+    flush_entry(tlb, index);
 }
 
 void TLB::tlb_read(const tlb_o& tlb, unsigned index, uint64_t *entry_hi)
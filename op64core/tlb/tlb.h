@@ -28,6 +28,8 @@ EVEN IF AD
 #pragma once
 
 #include <cstdint>
+#include <memory>
+#include <vector>
 #include <emmintrin.h>
 
 union aligned_tlb_data {
@@ -40,6 +42,11 @@ struct tlb_o {
     union aligned_tlb_data vpn2;
     uint8_t global[32];
     uint8_t asid[32];
+
+    // op64: 4KB page translation cache, maps a virtual page to the
+    // translated address of its first byte or 0 if not cached
+    std::unique_ptr<uint32_t[]> lut;
+    std::vector<uint32_t> lut_pages;
 };
 
 enum TLBProbeMode : uint8_t
@@ -62,4 +69,12 @@ public:
     static bool tlb_probe(const tlb_o& tlb, uint64_t vaddr, uint8_t vasid, unsigned* index);
     static void tlb_read(const tlb_o& tlb, unsigned index, uint64_t *entry_hi);
     static void tlb_write(tlb_o& tlb, unsigned index, uint64_t entry_hi, uint64_t entry_lo_0, uint64_t entry_lo_1, uint32_t page_mask);
+
+    // drop all cached translations, needed when the ASID changes
+    static void tlb_flush(tlb_o& tlb);
+
+private:
+    static uint32_t translate(Bus* bus, uint32_t address, TLBProbeMode mode);
+    static void cache_page(tlb_o& tlb, uint32_t address, uint32_t translated);
+    static void flush_entry(tlb_o& tlb, unsigned index);
 };
@@ -1,6 +1,7 @@
 #include "configstore.h"
 
 #include <globalstrings.h>
+#include <cpu/cputypes.h>
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
 
@@ -40,14 +41,24 @@ ConfigStore::ConfigStore(void)
 
 ConfigStore::~ConfigStore(void)
 {
-    saveConfig();
+    if (_persistent)
+    {
+        saveConfig();
+    }
 }
 
 void ConfigStore::setupDefaults(void)
 {
     using namespace GlobalStrings;
     set(CFG_SECTION_CORE, CFG_DELAY_SI, false);
+    set(CFG_SECTION_CORE, CFG_DMA_TIMING, false);
+    set(CFG_SECTION_CORE, CFG_RSP_THREAD, false);
+    set(CFG_SECTION_CORE, CFG_HLE_AUDIO, false);
     set(CFG_SECTION_CORE, CFG_SAVE_PATH, CFG_SAVE_PATH_DEFAULT);
+    set(CFG_SECTION_CORE, CFG_CPU_CORE, (uint32_t)CPU_INTERPRETER);
+    set(CFG_SECTION_CORE, CFG_FASTMEM, true);
+    set(CFG_SECTION_CORE, CFG_REWIND_INTERVAL, (uint32_t)30);
+    set(CFG_SECTION_CORE, CFG_REWIND_BUFFER, (uint32_t)64);
     set(CFG_SECTION_CORE, CFG_GFX_PATH, CFG_GFX_PATH_DEFAULT);
     set(CFG_SECTION_CORE, CFG_AUDIO_PATH, CFG_AUDIO_PATH_DEFAULT);
     set(CFG_SECTION_CORE, CFG_RSP_PATH, CFG_RSP_PATH_DEFAULT);
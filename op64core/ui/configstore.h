@@ -131,6 +131,12 @@ public:
     void loadConfig(void);
     void saveConfig(void);
 
+    // when off, changes are not written back to the config file on exit
+    void setPersistent(bool persistent)
+    {
+        _persistent = persistent;
+    }
+
 private:
     ConfigStore(void);
     ~ConfigStore(void);
@@ -151,4 +157,5 @@ private:
     std::shared_timed_mutex ptsem;
 
     std::string _configFile = "op64.cfg";
+    bool _persistent = true;
 };
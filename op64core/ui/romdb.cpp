@@ -1,9 +1,14 @@
 #include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/interprocess/file_mapping.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/ini_parser.hpp>
 #include <boost/format.hpp>
 
+#include <algorithm>
+#include <cstring>
 #include <sstream>
+#include <vector>
 
 #include <oplog.h>
 #include <oppreproc.h>
@@ -14,141 +19,454 @@
 
 #define ROMDB_FILE "romdb.ini"
 
+// bump when the index layout changes, older indexes are ignored
+#define ROMDB_INDEX_VERSION 2
+
+static const char ROMDB_INDEX_MAGIC[8] = { 'O', 'P', '6', '4', 'R', 'D', 'B', 0 };
+
+
+// Host byte order, the tables follow the header back to back in this order
+struct RomDB::IndexHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t hack_count;
+    uint32_t code_count;
+    uint32_t string_size;
+    uint32_t reserved;
+};
+
+struct RomDB::IndexEntry
+{
+    uint8_t md5[16];
+    uint32_t crc1;
+    uint32_t crc2;
+    uint32_t status;
+    uint32_t goodname;      // offset into the string table
+    uint32_t first_hack;
+    uint32_t hack_count;
+    uint8_t savetype;
+    uint8_t countperop;
+    uint8_t idleskip;
+    uint8_t reserved;
+};
+
+struct RomDB::IndexHack
+{
+    uint32_t name;          // offset into the string table
+    uint32_t first_code;
+    uint32_t code_count;
+};
+
+struct RomDB::IndexCode
+{
+    uint32_t address;
+    int32_t value;
+    int32_t old_value;
+};
+
+static bool parseMD5(const char* text, size_t length, uint8_t* md5)
+{
+    if (length != 32)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < 32; i++)
+    {
+        char c = text[i];
+        uint8_t nibble;
+
+        if (c >= '0' && c <= '9')
+            nibble = c - '0';
+        else if (c >= 'A' && c <= 'F')
+            nibble = c - 'A' + 10;
+        else if (c >= 'a' && c <= 'f')
+            nibble = c - 'a' + 10;
+        else
+            return false;
+
+        md5[i / 2] = (i & 1) ? (md5[i / 2] | nibble) : (nibble << 4);
+    }
+
+    return true;
+}
+
 RomDB::RomDB(void)
 {
+    boost::system::error_code ec;
     boost::filesystem::path dbpath(ROMDB_FILE);
+    boost::filesystem::path indexpath(ROMDB_INDEX_FILE);
+
+    bool ini = exists(dbpath, ec);
+
+    if (exists(indexpath, ec))
+    {
+        if (ini && last_write_time(dbpath, ec) > last_write_time(indexpath, ec))
+        {
+            LOG_WARNING(RomDB) << ROMDB_INDEX_FILE << " is older than " << ROMDB_FILE << ", run op64-romdb to update it";
+        }
+        else if (openIndex(ROMDB_INDEX_FILE))
+        {
+            LOG_INFO(RomDB) << _header->entry_count << " entries mapped";
+            return;
+        }
+    }
+
+    if (ini)
+    {
+        if (parseIni(ROMDB_FILE, _db))
+        {
+            LOG_INFO(RomDB) << _db.size() << " entries loaded";
+        }
+    }
+    else
+    {
+        LOG_WARNING(RomDB) << "ROM database file not found";
+    }
+}
 
-    if (exists(dbpath))
+bool RomDB::parseIni(const char* path, RomDatabase& db)
+{
+    boost::property_tree::ptree pt;
+    try
     {
-        boost::property_tree::ptree pt;
-        boost::property_tree::ini_parser::read_ini(ROMDB_FILE, pt);
-        uint32_t entries = 0;
-        std::string save;
-        std::string crc;
-        std::string refmd5;
-        std::string cheats;
+        boost::property_tree::ini_parser::read_ini(path, pt);
+    }
+    catch (const boost::property_tree::ini_parser_error& e)
+    {
+        LOG_ERROR(RomDB) << "Could not parse " << path << ": " << e.what();
+        return false;
+    }
 
-        for (auto& section : pt)
+    std::string save;
+    std::string crc;
+    std::string refmd5;
+    std::string cheats;
+
+    for (auto& section : pt)
+    {
+        RomSettings setting;
+        uint32_t numhacks = 0;
+        for (auto& key : section.second)
         {
-            ++entries;
-            RomSettings setting;
-            uint32_t numhacks = 0;
-            for (auto& key : section.second)
+            if (key.first == "GoodName")
             {
-                if (key.first == "GoodName")
+                setting.goodname = key.second.get_value<std::string>();
+            }
+            else if (key.first == "SaveType")
+            {
+                save = key.second.get_value<std::string>();
+                if (save == "Eeprom 4KB")
                 {
-                    setting.goodname = key.second.get_value<std::string>();
+                    setting.savetype = SAVETYPE_EEPROM_4KB;
                 }
-                else if (key.first == "SaveType")
+                else if (save == "Eeprom 16KB")
                 {
-                    save = key.second.get_value<std::string>();
-                    if (save == "Eeprom 4KB")
-                    {
-                        setting.savetype = SAVETYPE_EEPROM_4KB;
-                    }
-                    else if (save == "Eeprom 16KB")
-                    {
-                        setting.savetype = SAVETYPE_EEPROM_16KB;
-                    }
-                    else if (save == "SRAM")
-                    {
-                        setting.savetype = SAVETYPE_SRAM;
-                    }
-                    else if (save == "Flash RAM")
-                    {
-                        setting.savetype = SAVETYPE_FLASH_RAM;
-                    }
-                    else if (save == "Controller Pack")
-                    {
-                        setting.savetype = CONTROLLER_PACK;
-                    }
-                    else if (save == "None")
-                    {
-                        setting.savetype = SAVETYPE_NONE;
-                    }
-                    else
-                    {
-                        LOG_WARNING(RomDB) << "Invalid save type value in entry " << section.first;
-                    }
+                    setting.savetype = SAVETYPE_EEPROM_16KB;
                 }
-                else if (key.first == "Status")
+                else if (save == "SRAM")
                 {
-                    setting.status = key.second.get_value<uint32_t>();
+                    setting.savetype = SAVETYPE_SRAM;
                 }
-                else if (key.first == "CRC")
+                else if (save == "Flash RAM")
                 {
-                    crc = key.second.get_value<std::string>();
-
-                    // Default value for error checking
-                    setting.crc1 = setting.crc2 = 0xDEADBEEF;
-
-                    std::istringstream convert(crc);
-                    convert >> std::hex >> setting.crc1 >> std::hex >> setting.crc2;
-
-                    if (0xDEADBEEF == setting.crc1 || 0xDEADBEEF == setting.crc2)
-                    {
-                        LOG_WARNING(RomDB) << "Invalid crc value in entry ", section.first;
-                    }
+                    setting.savetype = SAVETYPE_FLASH_RAM;
                 }
-                else if (key.first == "RefMD5")
+                else if (save == "Controller Pack")
                 {
-                    refmd5 = key.second.get_value<std::string>();
-                    auto search = _db.find(refmd5);
-                    if (search != _db.end())
-                    {
-                        // copy it
-                        setting = search->second;
-                    }
-                    else
-                    {
-                        LOG_WARNING(RomDB) << "Referenced md5 value not found in entry ", section.first;
-                    }
+                    setting.savetype = CONTROLLER_PACK;
                 }
-                else if (key.first == "CountPerOp")
+                else if (save == "None")
                 {
-                    setting.countperop = key.second.get_value<uint32_t>();
-                    if (setting.countperop < 1 || setting.countperop > 4)
-                    {
-                        setting.countperop = 2;
-                        LOG_WARNING(RomDB) << "Invalid count per op value in entry ", section.first;
-                    }
+                    setting.savetype = SAVETYPE_NONE;
                 }
-                else if (key.first.find("Cheat") != std::string::npos)
+                else
                 {
-                    Cheat newhack;
-                    newhack.name = boost::str(boost::format("Hack%1%") % ++numhacks);
+                    LOG_WARNING(RomDB) << "Invalid save type value in entry " << section.first;
+                }
+            }
+            else if (key.first == "Status")
+            {
+                setting.status = key.second.get_value<uint32_t>();
+            }
+            else if (key.first == "CRC")
+            {
+                crc = key.second.get_value<std::string>();
 
-                    cheats = key.second.get_value<std::string>();
-                    newhack.codes = CheatEngine::toCheatCodeList(cheats);
-                    newhack.enabled = newhack.was_enabled = true;
+                // Default value for error checking
+                setting.crc1 = setting.crc2 = 0xDEADBEEF;
 
-                    setting.romhacks.push_back(newhack);
+                std::istringstream convert(crc);
+                convert >> std::hex >> setting.crc1 >> std::hex >> setting.crc2;
+
+                if (0xDEADBEEF == setting.crc1 || 0xDEADBEEF == setting.crc2)
+                {
+                    LOG_WARNING(RomDB) << "Invalid crc value in entry ", section.first;
+                }
+            }
+            else if (key.first == "RefMD5")
+            {
+                refmd5 = key.second.get_value<std::string>();
+                auto search = db.find(refmd5);
+                if (search != db.end())
+                {
+                    // copy it
+                    setting = search->second;
                 }
                 else
                 {
-                    LOG_WARNING(RomDB) << "Unrecognized key " << key.first << " in entry " << section.first;
+                    LOG_WARNING(RomDB) << "Referenced md5 value not found in entry ", section.first;
+                }
+            }
+            else if (key.first == "CountPerOp")
+            {
+                setting.countperop = key.second.get_value<uint32_t>();
+                if (setting.countperop < 1 || setting.countperop > 4)
+                {
+                    setting.countperop = 2;
+                    LOG_WARNING(RomDB) << "Invalid count per op value in entry ", section.first;
                 }
             }
+            else if (key.first == "IdleSkip")
+            {
+                setting.idleskip = key.second.get_value<uint32_t>() != 0;
+            }
+            else if (key.first.find("Cheat") != std::string::npos)
+            {
+                Cheat newhack;
+                newhack.name = boost::str(boost::format("Hack%1%") % ++numhacks);
+
+                cheats = key.second.get_value<std::string>();
+                newhack.codes = CheatEngine::toCheatCodeList(cheats);
+                newhack.enabled = newhack.was_enabled = true;
 
-            _db[section.first] = setting;
+                setting.romhacks.push_back(newhack);
+            }
+            else
+            {
+                LOG_WARNING(RomDB) << "Unrecognized key " << key.first << " in entry " << section.first;
+            }
         }
 
-        LOG_INFO(RomDB) << entries << " entries loaded";
+        db[section.first] = setting;
     }
-    else
+
+    return true;
+}
+
+bool RomDB::writeIndex(const RomDatabase& db, const char* path)
+{
+    std::vector<IndexEntry> entries;
+    std::vector<IndexHack> hacks;
+    std::vector<IndexCode> codes;
+    std::vector<char> strings;
+
+    entries.reserve(db.size());
+
+    for (auto& rom : db)
     {
-        LOG_WARNING(RomDB) << "ROM database file not found";
+        IndexEntry entry;
+        memset(&entry, 0, sizeof(entry));
+
+        if (!parseMD5(rom.first.c_str(), rom.first.size(), entry.md5))
+        {
+            LOG_WARNING(RomDB) << "Skipping entry " << rom.first << ", it is not an MD5";
+            continue;
+        }
+
+        const RomSettings& setting = rom.second;
+
+        entry.crc1 = setting.crc1;
+        entry.crc2 = setting.crc2;
+        entry.status = setting.status;
+        entry.savetype = (uint8_t)setting.savetype;
+        entry.countperop = setting.countperop;
+        entry.idleskip = setting.idleskip;
+
+        entry.goodname = (uint32_t)strings.size();
+        strings.insert(strings.end(), setting.goodname.begin(), setting.goodname.end());
+        strings.push_back(0);
+
+        entry.first_hack = (uint32_t)hacks.size();
+        entry.hack_count = (uint32_t)setting.romhacks.size();
+
+        for (const Cheat& hack : setting.romhacks)
+        {
+            hacks.push_back({ (uint32_t)strings.size(), (uint32_t)codes.size(), (uint32_t)hack.codes.size() });
+            strings.insert(strings.end(), hack.name.begin(), hack.name.end());
+            strings.push_back(0);
+
+            for (const CheatCode& code : hack.codes)
+            {
+                codes.push_back({ code.address, code.value, code.old_value });
+            }
+        }
+
+        entries.push_back(entry);
     }
+
+    // std::map orders by the hex string, which is not the byte order for lower case keys
+    std::sort(entries.begin(), entries.end(), [](const IndexEntry& a, const IndexEntry& b)
+    {
+        return memcmp(a.md5, b.md5, sizeof(a.md5)) < 0;
+    });
+
+    IndexHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ROMDB_INDEX_MAGIC, sizeof(header.magic));
+    header.version = ROMDB_INDEX_VERSION;
+    header.entry_count = (uint32_t)entries.size();
+    header.hack_count = (uint32_t)hacks.size();
+    header.code_count = (uint32_t)codes.size();
+    header.string_size = (uint32_t)strings.size();
+
+    boost::filesystem::ofstream file(boost::filesystem::path(path), std::ios::out | std::ios::binary | std::ios::trunc);
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)entries.data(), entries.size() * sizeof(IndexEntry));
+    file.write((const char*)hacks.data(), hacks.size() * sizeof(IndexHack));
+    file.write((const char*)codes.data(), codes.size() * sizeof(IndexCode));
+    file.write(strings.data(), strings.size());
+
+    if (!file.good())
+    {
+        LOG_ERROR(RomDB) << "Could not write " << path;
+        return false;
+    }
+
+    return true;
+}
+
+bool RomDB::openIndex(const char* path)
+{
+    using namespace boost::interprocess;
+
+    try
+    {
+        file_mapping file(path, read_only);
+        mapped_region(file, read_only).swap(_index);
+    }
+    catch (const interprocess_exception& e)
+    {
+        LOG_WARNING(RomDB) << "Could not map " << path << ": " << e.what();
+        return false;
+    }
+
+    const uint8_t* data = (const uint8_t*)_index.get_address();
+    size_t size = _index.get_size();
+    const IndexHeader* header = (const IndexHeader*)data;
+
+    if (size < sizeof(IndexHeader) || memcmp(header->magic, ROMDB_INDEX_MAGIC, sizeof(header->magic)) || header->version != ROMDB_INDEX_VERSION)
+    {
+        LOG_WARNING(RomDB) << path << " is not a ROM database index for this build";
+        mapped_region().swap(_index);
+        return false;
+    }
+
+    uint64_t expected = sizeof(IndexHeader) +
+        (uint64_t)header->entry_count * sizeof(IndexEntry) +
+        (uint64_t)header->hack_count * sizeof(IndexHack) +
+        (uint64_t)header->code_count * sizeof(IndexCode) +
+        header->string_size;
+
+    if (expected != size)
+    {
+        LOG_WARNING(RomDB) << path << " is truncated or corrupted";
+        mapped_region().swap(_index);
+        return false;
+    }
+
+    _header = header;
+    _entries = (const IndexEntry*)(data + sizeof(IndexHeader));
+    _hacks = (const IndexHack*)(_entries + header->entry_count);
+    _codes = (const IndexCode*)(_hacks + header->hack_count);
+    _strings = (const char*)(_codes + header->code_count);
+
+    return true;
+}
+
+bool RomDB::validString(uint32_t offset) const
+{
+    return offset < _header->string_size && nullptr != memchr(_strings + offset, 0, _header->string_size - offset);
 }
 
 bool RomDB::get(std::string rom_md5, RomSettings& copy)
 {
+    if (_header != nullptr)
+    {
+        return getIndexed(rom_md5, copy);
+    }
+
     auto search = _db.find(rom_md5);
     if (search != _db.end())
     {
         copy = search->second;
-        return true; 
+        return true;
     }
 
     return false;
 }
+
+bool RomDB::getIndexed(const std::string& rom_md5, RomSettings& copy)
+{
+    uint8_t md5[16];
+
+    if (!parseMD5(rom_md5.c_str(), rom_md5.size(), md5))
+    {
+        return false;
+    }
+
+    const IndexEntry* end = _entries + _header->entry_count;
+    const IndexEntry* entry = std::lower_bound(_entries, end, md5, [](const IndexEntry& e, const uint8_t* key)
+    {
+        return memcmp(e.md5, key, sizeof(e.md5)) < 0;
+    });
+
+    if (entry == end || memcmp(entry->md5, md5, sizeof(md5)))
+    {
+        return false;
+    }
+
+    // the file was only checked as a whole, the entry is checked before use
+    if (!validString(entry->goodname) || (uint64_t)entry->first_hack + entry->hack_count > _header->hack_count)
+    {
+        LOG_ERROR(RomDB) << "Entry " << rom_md5 << " is corrupted";
+        return false;
+    }
+
+    copy.goodname = _strings + entry->goodname;
+    copy.crc1 = entry->crc1;
+    copy.crc2 = entry->crc2;
+    copy.savetype = (SaveType)entry->savetype;
+    copy.status = entry->status;
+    copy.countperop = entry->countperop;
+    copy.idleskip = entry->idleskip != 0;
+    copy.romhacks.clear();
+
+    for (uint32_t i = 0; i < entry->hack_count; i++)
+    {
+        const IndexHack& hack = _hacks[entry->first_hack + i];
+
+        if (!validString(hack.name) || (uint64_t)hack.first_code + hack.code_count > _header->code_count)
+        {
+            LOG_ERROR(RomDB) << "Entry " << rom_md5 << " is corrupted";
+            copy.romhacks.clear();
+            return false;
+        }
+
+        Cheat newhack;
+        newhack.name = _strings + hack.name;
+        newhack.enabled = newhack.was_enabled = true;
+
+        for (uint32_t c = 0; c < hack.code_count; c++)
+        {
+            const IndexCode& code = _codes[hack.first_code + c];
+            newhack.codes.push_back({ code.address, code.value, code.old_value });
+        }
+
+        copy.romhacks.push_back(newhack);
+    }
+
+    return true;
+}
@@ -2,24 +2,31 @@
 
 #include <map>
 
+#include <boost/interprocess/mapped_region.hpp>
+
 #include "rom/rom.h"
 #include "cheat/cheat.h"
 
+// romdb.ini compiled by op64-romdb, used instead when present
+#define ROMDB_INDEX_FILE "romdb.bin"
+
 struct RomSettings
 {
     std::string goodname;
-    uint32_t crc1;
-    uint32_t crc2;
-    SaveType savetype;
-    uint32_t status;
+    uint32_t crc1 = 0;
+    uint32_t crc2 = 0;
+    SaveType savetype = SAVETYPE_AUTO;
+    uint32_t status = 0;
     uint8_t countperop = 2;
+    bool idleskip = true;
     CheatList romhacks;
 };
 
 class RomDB
 {
-    typedef std::map<std::string, RomSettings> RomDatabase;
 public:
+    typedef std::map<std::string, RomSettings> RomDatabase;
+
     static RomDB& getInstance()
     {
         static RomDB instance;
@@ -28,6 +35,10 @@ public:
 
     bool get(std::string rom_md5, RomSettings& copy);
 
+    // used by op64-romdb to build the index
+    static bool parseIni(const char* path, RomDatabase& db);
+    static bool writeIndex(const RomDatabase& db, const char* path);
+
 private:
     RomDB(void);
     ~RomDB(void) = default;
@@ -36,6 +47,23 @@ private:
     RomDB(const RomDB&);
     RomDB& operator=(const RomDB&);
 
+    bool openIndex(const char* path);
+    bool getIndexed(const std::string& rom_md5, RomSettings& copy);
+    bool validString(uint32_t offset) const;
+
 private:
+    struct IndexHeader;
+    struct IndexEntry;
+    struct IndexHack;
+    struct IndexCode;
+
     RomDatabase _db;
+
+    // the mapped index, sorted by MD5
+    boost::interprocess::mapped_region _index;
+    const IndexHeader* _header = nullptr;
+    const IndexEntry* _entries = nullptr;
+    const IndexHack* _hacks = nullptr;
+    const IndexCode* _codes = nullptr;
+    const char* _strings = nullptr;
 };